@@ -0,0 +1,127 @@
+#include "FileIngestor.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Writes roughly targetBytes of CSV ticks over numSymbols symbols, plus a
+// binary file with the first (up to 16M) generated ticks. Past that point the
+// CSV repeats its generated block, so memory stays bounded for 10 GB targets.
+void generateFiles(const std::string& csvPath, const std::string& binPath, uint64_t targetBytes, size_t numSymbols) {
+    std::vector<std::string> symbols;
+    for (size_t i = 0; i < numSymbols; ++i) {
+        symbols.push_back("SYM" + std::to_string(i));
+    }
+
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<size_t> pickSymbol(0, numSymbols - 1);
+    std::uniform_int_distribution<int> move(-5, 5);
+    std::uniform_int_distribution<int> quantity(1, 1000);
+    std::vector<int64_t> prices(numSymbols, 1'000'000);  // 100.0000
+
+    std::ofstream csv(csvPath, std::ios::trunc);
+    if (!csv.is_open()) {
+        throw std::runtime_error("Cannot write " + csvPath);
+    }
+    csv << "symbol,price,quantity,timestamp\n";
+
+    std::vector<MarketData::Tick> ticks;
+    std::string line;
+    uint64_t written = 0;
+    uint64_t timestamp = 1'700'000'000'000'000'000ull;
+    while (written < targetBytes) {
+        size_t s = pickSymbol(rng);
+        prices[s] = std::max<int64_t>(1, prices[s] + move(rng));
+        int qty = quantity(rng);
+        timestamp += 250;
+
+        char buffer[96];
+        int length = std::snprintf(buffer, sizeof(buffer), "%s,%lld.%04lld,%d,%llu\n", symbols[s].c_str(),
+                                   static_cast<long long>(prices[s] / MarketData::kPriceScale),
+                                   static_cast<long long>(prices[s] % MarketData::kPriceScale), qty,
+                                   static_cast<unsigned long long>(timestamp));
+        csv.write(buffer, length);
+        written += static_cast<uint64_t>(length);
+        ticks.push_back(MarketData::Tick{static_cast<MarketData::SymbolId>(s), qty, prices[s], timestamp});
+
+        if (ticks.size() == (1u << 24)) {
+            break;
+        }
+    }
+    if (written < targetBytes) {
+        csv.close();
+        std::ifstream in(csvPath, std::ios::binary);
+        std::string block((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        block.erase(0, block.find('\n') + 1);
+        std::ofstream out(csvPath, std::ios::app | std::ios::binary);
+        while (written < targetBytes) {
+            out.write(block.data(), static_cast<std::streamsize>(block.size()));
+            written += block.size();
+        }
+    }
+
+    MarketData::writeTickFile(binPath, symbols, ticks);
+}
+
+void report(const char* name, const MarketData::IngestResult& result) {
+    std::cout << std::left << std::setw(22) << name << std::right
+              << std::setw(12) << result.ticks
+              << std::setw(10) << std::fixed << std::setprecision(3) << result.seconds
+              << std::setw(10) << std::setprecision(2) << result.gigabytesPerSecond()
+              << std::setw(14) << static_cast<uint64_t>(result.ticks / std::max(result.seconds, 1e-9))
+              << std::setw(11) << result.malformed << "\n";
+}
+
+int main(int argc, char** argv) {
+    uint64_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10240;
+    size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+    std::string dir = argc > 3 ? argv[3] : ".";
+    std::string csvPath = dir + "/ingest_benchmark.csv";
+    std::string binPath = dir + "/ingest_benchmark.bin";
+
+    try {
+        std::cout << "Generating " << megabytes << " MB of CSV in " << dir << "...\n";
+        generateFiles(csvPath, binPath, megabytes << 20, 500);
+
+        MarketData::IngestOptions options;
+        options.threads = threads;
+
+        std::cout << "input                        ticks   seconds      GB/s      ticks/s  malformed\n";
+        {
+            MarketData::FileIngestor parseOnly([](const MarketData::Tick*, size_t) {}, options);
+            report("csv parse only", parseOnly.ingestCsv(csvPath));
+            report("binary parse only", parseOnly.ingestBinary(binPath));
+        }
+        {
+            MarketData::Processor processor(std::max<size_t>(1, std::thread::hardware_concurrency()));
+            processor.start();
+            MarketData::FileIngestor ingestor(processor, options);
+
+            auto start = std::chrono::steady_clock::now();
+            MarketData::IngestResult result = ingestor.ingestCsv(csvPath);
+            processor.waitIdle();
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            report("csv into Processor", result);
+
+            start = std::chrono::steady_clock::now();
+            result = ingestor.ingestBinary(binPath);
+            processor.waitIdle();
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            report("binary into Processor", result);
+            processor.stop();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::remove(csvPath.c_str());
+    std::remove(binPath.c_str());
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "BoundedQueue.h"
+#include "Queue.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Moves itemsPerProducer values from every producer to the consumers and
+// returns transferred items per second
+template<typename QueueType>
+double run(QueueType& queue, size_t producers, size_t consumers, size_t itemsPerProducer) {
+    std::vector<std::thread> threads;
+    std::vector<uint64_t> received(consumers, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t c = 0; c < consumers; ++c) {
+        threads.emplace_back([&queue, &received, c] {
+            uint64_t count = 0;
+            while (queue.pop()) {
+                ++count;
+            }
+            received[c] = count;
+        });
+    }
+
+    std::vector<std::thread> producerThreads;
+    for (size_t p = 0; p < producers; ++p) {
+        producerThreads.emplace_back([&queue, itemsPerProducer, p] {
+            for (uint64_t i = 0; i < itemsPerProducer; ++i) {
+                queue.push(p * itemsPerProducer + i);
+            }
+        });
+    }
+    for (auto& thread : producerThreads) {
+        thread.join();
+    }
+    queue.stop();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t total = 0;
+    for (auto count : received) {
+        total += count;
+    }
+    if (total != producers * itemsPerProducer) {
+        std::cerr << "Lost items: expected " << producers * itemsPerProducer << ", got " << total << "\n";
+    }
+    return total / elapsed;
+}
+
+int main(int argc, char** argv) {
+    size_t totalItems = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4'000'000;
+    const size_t capacity = 1 << 14;
+
+    std::cout << "threads (P=C)   mutex Queue (ops/s)   BoundedQueue (ops/s)   speedup\n";
+    for (size_t threads : {1, 4, 16}) {
+        size_t perProducer = totalItems / threads;
+
+        MarketData::Queue<uint64_t> mutexQueue;
+        double mutexRate = run(mutexQueue, threads, threads, perProducer);
+
+        MarketData::BoundedQueue<uint64_t> boundedQueue(capacity);
+        double boundedRate = run(boundedQueue, threads, threads, perProducer);
+
+        std::cout << std::setw(13) << threads
+                  << std::setw(22) << static_cast<uint64_t>(mutexRate)
+                  << std::setw(23) << static_cast<uint64_t>(boundedRate)
+                  << std::setw(10) << std::fixed << std::setprecision(2) << boundedRate / mutexRate << "x\n";
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void waitFor(const std::atomic<uint64_t>& done, uint64_t expected) {
+    while (done.load(std::memory_order_acquire) < expected) {
+        std::this_thread::yield();
+    }
+}
+
+// Tiny tasks posted from outside the pool
+template<typename Pool>
+double flat(size_t threads, uint64_t numTasks) {
+    Pool pool(threads);
+    std::atomic<uint64_t> done{0};
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < numTasks; ++i) {
+        pool.post([&done] { done.fetch_add(1, std::memory_order_release); });
+    }
+    waitFor(done, numTasks);
+    return numTasks / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Binary fan-out: every task posts two children until the depth runs out,
+// so nearly all submits happen on worker threads
+template<typename Pool>
+void spawn(Pool& pool, std::atomic<uint64_t>& done, int depth) {
+    if (depth > 0) {
+        pool.post([&pool, &done, depth] { spawn(pool, done, depth - 1); });
+        pool.post([&pool, &done, depth] { spawn(pool, done, depth - 1); });
+    }
+    done.fetch_add(1, std::memory_order_release);
+}
+
+template<typename Pool>
+double tree(size_t threads, int depth) {
+    Pool pool(threads);
+    std::atomic<uint64_t> done{0};
+    uint64_t numTasks = (uint64_t{1} << (depth + 1)) - 1;
+    auto start = std::chrono::steady_clock::now();
+    pool.post([&pool, &done, depth] { spawn(pool, done, depth); });
+    waitFor(done, numTasks);
+    return numTasks / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* name, size_t threads, double shared, double stealing) {
+    std::cout << std::left << std::setw(10) << name << std::right
+              << std::setw(8) << threads
+              << std::setw(22) << static_cast<uint64_t>(shared)
+              << std::setw(22) << static_cast<uint64_t>(stealing)
+              << std::setw(10) << std::fixed << std::setprecision(2) << stealing / shared << "x\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t numTasks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    int depth = 1;
+    while ((uint64_t{1} << (depth + 2)) <= numTasks) {
+        ++depth;
+    }
+
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> threadCounts{1, 2, 4, 8, 16};
+    threadCounts.erase(std::remove_if(threadCounts.begin(), threadCounts.end(),
+                                      [hardware](size_t n) { return n > 2 * hardware && n > 1; }),
+                       threadCounts.end());
+
+    std::cout << "workload   threads   shared queue (tasks/s)   work stealing (tasks/s)   speedup\n";
+    for (size_t threads : threadCounts) {
+        report("flat", threads,
+               flat<MarketData::SharedQueueThreadPool>(threads, numTasks),
+               flat<MarketData::ThreadPool>(threads, numTasks));
+    }
+    for (size_t threads : threadCounts) {
+        report("fan-out", threads,
+               tree<MarketData::SharedQueueThreadPool>(threads, depth),
+               tree<MarketData::ThreadPool>(threads, depth));
+    }
+    return 0;
+}
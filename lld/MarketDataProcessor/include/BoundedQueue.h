@@ -0,0 +1,270 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace MarketData {
+
+// What push does when the ring is full
+enum class Backpressure {
+    Block,       // wait for a consumer to free a slot
+    DropNewest,  // reject the value being pushed
+    DropOldest   // evict the oldest queued value to make room
+};
+
+// Bounded lock-free multi-producer / multi-consumer ring (per-slot sequence
+// numbers, Vyukov style) with the same push/pop/try_pop/stop interface as
+// Queue, so either can back a ThreadPool. Waiting threads spin, then yield, then
+// park on a condition variable that is only touched when someone is parked.
+template<typename T>
+class BoundedQueue {
+public:
+    static constexpr size_t kDefaultCapacity = 1 << 16;
+
+    explicit BoundedQueue(size_t capacity = kDefaultCapacity, Backpressure policy = Backpressure::Block)
+        : capacity_(roundUpToPowerOfTwo(capacity))
+        , mask_(capacity_ - 1)
+        , policy_(policy)
+        , slots_(std::make_unique<Slot[]>(capacity_))
+    {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~BoundedQueue() {
+        while (tryDequeue()) {
+        }
+    }
+
+    // Prevent copying
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // Prevent moving
+    BoundedQueue(BoundedQueue&&) = delete;
+    BoundedQueue& operator=(BoundedQueue&&) = delete;
+
+    // Returns false if the value was dropped (DropNewest, or stopped while full)
+    bool push(T value) {
+        unsigned spins = 0;
+        while (!tryEnqueue(value)) {
+            switch (policy_) {
+            case Backpressure::DropNewest:
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            case Backpressure::DropOldest:
+                if (tryDequeue()) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+            case Backpressure::Block:
+                if (stop_.load(std::memory_order_acquire)) {
+                    return false;
+                }
+                if (++spins > kSpinLimit) {
+                    park(waitingProducers_, notFull_, [this] { return !full() || stopped(); });
+                    spins = 0;
+                } else if (spins > kBusySpins) {
+                    std::this_thread::yield();
+                }
+                break;
+            }
+        }
+        wake(waitingConsumers_, notEmpty_);
+        return true;
+    }
+
+    // Pushes count values in order, paying for the consumer wake-up (a full
+    // fence and a read of the waiter count) once per call rather than once per
+    // value. onFull runs before waiting on a full ring, so a caller whose
+    // consumers are not parked on this queue can make sure one is on its way.
+    // Returns how many values were pushed.
+    template<typename OnFull>
+    size_t push(const T* values, size_t count, OnFull onFull) {
+        size_t pushed = 0;
+        for (size_t i = 0; i < count; ++i) {
+            T value = values[i];
+            if (tryEnqueue(value)) {
+                ++pushed;
+                continue;
+            }
+            wake(waitingConsumers_, notEmpty_);
+            onFull();
+            if (push(std::move(value))) {
+                ++pushed;
+            }
+        }
+        if (pushed > 0) {
+            wake(waitingConsumers_, notEmpty_);
+        }
+        return pushed;
+    }
+
+    std::optional<T> pop() {
+        unsigned spins = 0;
+        while (true) {
+            if (auto value = tryDequeue()) {
+                wake(waitingProducers_, notFull_);
+                return value;
+            }
+            if (stopped()) {
+                return std::nullopt;
+            }
+            if (++spins > kSpinLimit) {
+                park(waitingConsumers_, notEmpty_, [this] { return !empty() || stopped(); });
+                spins = 0;
+            } else if (spins > kBusySpins) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    std::optional<T> try_pop() {
+        auto value = tryDequeue();
+        if (value) {
+            wake(waitingProducers_, notFull_);
+        }
+        return value;
+    }
+
+    bool empty() const {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        return slots_[head & mask_].sequence.load(std::memory_order_acquire) != head + 1;
+    }
+
+    size_t size() const {
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        uint64_t head = head_.load(std::memory_order_acquire);
+        return tail > head ? static_cast<size_t>(tail - head) : 0;
+    }
+
+    void stop() {
+        stop_.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(parkMutex_);
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+
+    size_t capacity() const { return capacity_; }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    // Busy-spin first, then yield the core, then park
+    static constexpr unsigned kBusySpins = 16;
+    static constexpr unsigned kSpinLimit = 128;
+    static constexpr size_t kCacheLineSize = 64;
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    static size_t roundUpToPowerOfTwo(size_t n) {
+        if (n < 2) {
+            throw std::invalid_argument("Queue capacity must be at least 2");
+        }
+        size_t result = 1;
+        while (result < n) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    bool tryEnqueue(T& value) {
+        uint64_t pos = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[pos & mask_];
+            uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    new (slot.storage) T(std::move(value));
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // full
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::optional<T> tryDequeue() {
+        uint64_t pos = head_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[pos & mask_];
+            uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    std::optional<T> value(std::move(*slot.value()));
+                    slot.value()->~T();
+                    slot.sequence.store(pos + capacity_, std::memory_order_release);
+                    return value;
+                }
+            } else if (diff < 0) {
+                return std::nullopt;  // empty
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool full() const {
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        return slots_[tail & mask_].sequence.load(std::memory_order_acquire) != tail;
+    }
+
+    bool stopped() const { return stop_.load(std::memory_order_acquire); }
+
+    // The waiter count is raised before re-checking the condition and read by
+    // the other side after publishing, with full fences in between, so either
+    // the waiter sees the change or the notifier sees the waiter.
+    template<typename Ready>
+    void park(std::atomic<int>& waiters, std::condition_variable& cond, Ready ready) {
+        std::unique_lock<std::mutex> lock(parkMutex_);
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cond.wait(lock, ready);
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void wake(std::atomic<int>& waiters, std::condition_variable& cond) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(parkMutex_);
+            cond.notify_one();
+        }
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    const Backpressure policy_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(kCacheLineSize) std::atomic<uint64_t> tail_{0};
+    alignas(kCacheLineSize) std::atomic<uint64_t> head_{0};
+    alignas(kCacheLineSize) std::atomic<int> waitingConsumers_{0};
+    std::atomic<int> waitingProducers_{0};
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::mutex parkMutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+};
+
+} // namespace MarketData
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "MarketData.h"
+#include "Processor.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace MarketData {
+
+// Binary tick file: header, symbol dictionary, then Tick records whose symbol
+// field indexes the dictionary. Little-endian, native Tick layout.
+//
+//   TickFileHeader
+//   symbolCount x { uint16_t length; char name[length]; }
+//   zero padding to a multiple of 8 bytes
+//   tickCount x Tick
+struct TickFileHeader {
+    char magic[4];           // "MDTK"
+    uint32_t version;
+    uint64_t symbolCount;
+    uint64_t tickCount;
+    uint64_t dictionaryBytes; // including padding
+};
+
+static_assert(sizeof(TickFileHeader) == 32, "TickFileHeader is part of the file format");
+
+constexpr uint32_t kTickFileVersion = 1;
+
+void writeTickFile(const std::string& path, const std::vector<std::string>& symbols, const std::vector<Tick>& ticks);
+
+// Read-only memory map of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    // Prevent copying
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Prevent moving
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+struct IngestOptions {
+    size_t threads = 0;                 // parser threads; 0 means hardware concurrency
+    size_t chunkBytes = 8 << 20;        // input handed to one parser at a time
+    size_t batchTicks = 4096;           // ticks per sink call
+    size_t maxBacklog = 1 << 22;        // Processor sink waits while more ticks than this are queued
+};
+
+struct IngestResult {
+    uint64_t bytes = 0;
+    uint64_t ticks = 0;
+    uint64_t malformed = 0;             // records skipped (bad CSV line, unknown symbol index)
+    double seconds = 0.0;
+
+    double gigabytesPerSecond() const { return seconds > 0 ? bytes / seconds / 1e9 : 0.0; }
+};
+
+// Memory-maps tick files, splits them into chunks (on line boundaries for
+// CSV), parses chunks on several threads and passes the ticks to a sink in
+// batches. Chunks are handed to the sink in file order, so per-symbol order
+// is preserved even though parsing runs in parallel.
+class FileIngestor {
+public:
+    using BatchSink = std::function<void(const Tick* ticks, size_t count)>;
+
+    explicit FileIngestor(BatchSink sink, IngestOptions options = IngestOptions{});
+    // Feeds processor.addBatch, pausing while its pending ticks exceed maxBacklog
+    explicit FileIngestor(Processor& processor, IngestOptions options = IngestOptions{});
+
+    // "symbol,price,quantity,timestamp" per line; an optional first line
+    // holding exactly that header is skipped
+    IngestResult ingestCsv(const std::string& path);
+    IngestResult ingestBinary(const std::string& path);
+    // Picks the format from the file's magic
+    IngestResult ingest(const std::string& path);
+
+private:
+    // Parses chunk index into ticks, returning the number of malformed records
+    using ChunkParser = std::function<uint64_t(size_t chunk, std::vector<Tick>& ticks)>;
+
+    IngestResult run(size_t numChunks, const ChunkParser& parse);
+
+    BatchSink sink_;
+    IngestOptions options_;
+};
+
+} // namespace MarketData
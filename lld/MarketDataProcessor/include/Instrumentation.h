@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Set by the MARKETDATA_INSTRUMENTATION CMake option. With 0 every hook below
+// is an empty inline function and no clock is read on the hot path.
+#ifndef MDP_INSTRUMENTATION
+#define MDP_INSTRUMENTATION 0
+#endif
+
+namespace MarketData {
+
+constexpr bool kInstrumentationEnabled = MDP_INSTRUMENTATION != 0;
+
+namespace Instrumentation {
+
+inline uint64_t nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace Instrumentation
+
+// Summary of one histogram
+struct StageStats {
+    uint64_t count = 0;
+    double mean = 0.0;
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    uint64_t max = 0;
+};
+
+// HDR-style log-linear histogram: values below 256 get their own bucket, and
+// above that each power of two is split into 128 buckets, so any recorded
+// value is reported within 1%. Recording is a relaxed load and store, not a
+// read-modify-write, because each histogram has one writer; readers may merge
+// concurrently and see a slightly stale count.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 7;
+    static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+    static constexpr size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    LatencyHistogram() {
+        for (auto& count : counts_) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Prevent copying
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // Single writer
+    void record(uint64_t value) {
+        bump(counts_[bucketFor(value)], 1);
+        bump(total_, 1);
+        bump(sum_, value);
+        if (value > max_.load(std::memory_order_relaxed)) {
+            max_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    static size_t bucketFor(uint64_t value) {
+        if (value < 2 * kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - kSubBucketBits;
+        return static_cast<size_t>(shift + 1) * kSubBuckets + static_cast<size_t>((value >> shift) - kSubBuckets);
+    }
+
+    // Highest value that lands in the bucket
+    static uint64_t bucketUpperBound(size_t bucket) {
+        if (bucket < 2 * kSubBuckets) {
+            return bucket;
+        }
+        int shift = static_cast<int>(bucket / kSubBuckets) - 1;
+        uint64_t sub = bucket % kSubBuckets + kSubBuckets;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    // Accumulates raw counts for merging several histograms
+    void addTo(std::vector<uint64_t>& counts, uint64_t& total, uint64_t& sum, uint64_t& max) const {
+        counts.resize(kBucketCount, 0);
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            counts[i] += counts_[i].load(std::memory_order_relaxed);
+        }
+        total += total_.load(std::memory_order_relaxed);
+        sum += sum_.load(std::memory_order_relaxed);
+        max = std::max(max, max_.load(std::memory_order_relaxed));
+    }
+
+    StageStats summary() const { return summarize({this}); }
+
+    static StageStats summarize(const std::vector<const LatencyHistogram*>& histograms) {
+        std::vector<uint64_t> counts;
+        uint64_t total = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        for (const auto* histogram : histograms) {
+            histogram->addTo(counts, total, sum, max);
+        }
+
+        StageStats stats;
+        uint64_t bucketed = 0;
+        for (uint64_t count : counts) {
+            bucketed += count;
+        }
+        if (bucketed == 0) {
+            return stats;
+        }
+        stats.count = total;
+        stats.mean = static_cast<double>(sum) / std::max<uint64_t>(total, 1);
+        stats.max = max;
+
+        auto percentile = [&counts, bucketed, max](double p) {
+            uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(bucketed - 1)) + 1;
+            uint64_t seen = 0;
+            for (size_t i = 0; i < counts.size(); ++i) {
+                seen += counts[i];
+                if (seen >= rank) {
+                    return std::min(bucketUpperBound(i), max);
+                }
+            }
+            return max;
+        };
+        stats.p50 = percentile(0.50);
+        stats.p90 = percentile(0.90);
+        stats.p99 = percentile(0.99);
+        stats.p999 = percentile(0.999);
+        return stats;
+    }
+
+private:
+    static void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, kBucketCount> counts_;
+    std::atomic<uint64_t> total_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// Everything Processor::instrumentation() reports. Latencies are nanoseconds.
+struct InstrumentationSnapshot {
+    bool enabled = kInstrumentationEnabled;
+    StageStats sliceQueueWait;   // per slice: its oldest tick accepted -> drain task picks it up
+    StageStats taskWait;         // task posted -> a worker starts running it
+    StageStats updatePerTick;    // MarketDataStats::update, averaged over each slice
+    StageStats sliceSize;        // ticks handled per drain task
+    std::vector<size_t> shardDepth;       // pending ticks per shard right now
+    std::vector<size_t> shardMaxDepth;    // largest slice each shard has drained
+    size_t poolDepth = 0;                 // tasks queued in the pool right now
+    std::vector<double> workerUtilization; // busy fraction of each worker since start
+};
+
+inline void writeStage(std::ostream& out, const char* name, const StageStats& stats) {
+    out << "\"" << name << "\":{\"count\":" << stats.count << ",\"mean\":" << stats.mean
+        << ",\"p50\":" << stats.p50 << ",\"p90\":" << stats.p90 << ",\"p99\":" << stats.p99
+        << ",\"p999\":" << stats.p999 << ",\"max\":" << stats.max << "}";
+}
+
+template<typename T>
+void writeArray(std::ostream& out, const char* name, const std::vector<T>& values) {
+    out << "\"" << name << "\":[";
+    for (size_t i = 0; i < values.size(); ++i) {
+        out << (i ? "," : "") << values[i];
+    }
+    out << "]";
+}
+
+// One JSON object per snapshot
+inline std::ostream& operator<<(std::ostream& out, const InstrumentationSnapshot& snapshot) {
+    out << "{\"enabled\":" << (snapshot.enabled ? "true" : "false") << ",";
+    writeStage(out, "sliceQueueWaitNs", snapshot.sliceQueueWait);
+    out << ",";
+    writeStage(out, "taskWaitNs", snapshot.taskWait);
+    out << ",";
+    writeStage(out, "updatePerTickNs", snapshot.updatePerTick);
+    out << ",";
+    writeStage(out, "sliceSize", snapshot.sliceSize);
+    out << ",";
+    writeArray(out, "shardDepth", snapshot.shardDepth);
+    out << ",";
+    writeArray(out, "shardMaxDepth", snapshot.shardMaxDepth);
+    out << ",\"poolDepth\":" << snapshot.poolDepth << ",";
+    writeArray(out, "workerUtilization", snapshot.workerUtilization);
+    return out << "}";
+}
+
+// Appends a line produced by write to a file every interval until destroyed
+class PeriodicDumper {
+public:
+    PeriodicDumper(const std::string& path, std::chrono::milliseconds interval,
+                   std::function<void(std::ostream&)> write)
+        : out_(path, std::ios::app), interval_(interval), write_(std::move(write)) {
+        if (!out_.is_open()) {
+            throw std::runtime_error("Cannot open metrics file: " + path);
+        }
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~PeriodicDumper() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cond_.notify_all();
+        thread_.join();
+    }
+
+    // Prevent copying
+    PeriodicDumper(const PeriodicDumper&) = delete;
+    PeriodicDumper& operator=(const PeriodicDumper&) = delete;
+
+    // Prevent moving
+    PeriodicDumper(PeriodicDumper&&) = delete;
+    PeriodicDumper& operator=(PeriodicDumper&&) = delete;
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!cond_.wait_for(lock, interval_, [this] { return stop_; })) {
+            write_(out_);
+            out_ << "\n";
+            out_.flush();
+        }
+        // Final sample so short runs still leave a record
+        write_(out_);
+        out_ << "\n";
+    }
+
+    std::ofstream out_;
+    const std::chrono::milliseconds interval_;
+    std::function<void(std::ostream&)> write_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+#if MDP_INSTRUMENTATION
+
+// Per-shard hooks, called by the shard's producers (onEnqueue) and by its
+// drain task (onDequeue, onProcessed)
+class ShardMetrics {
+public:
+    // The ring was empty before this push: the slice's oldest tick arrives now
+    void onEnqueue(bool wasEmpty) {
+        if (wasEmpty) {
+            oldestEnqueueNs_.store(Instrumentation::nowNs(), std::memory_order_relaxed);
+        }
+    }
+
+    void onDequeue(size_t sliceSize) {
+        sliceStartNs_ = Instrumentation::nowNs();
+        if (sliceSize > 0) {
+            uint64_t oldest = oldestEnqueueNs_.load(std::memory_order_relaxed);
+            sliceQueueWait_.record(sliceStartNs_ > oldest ? sliceStartNs_ - oldest : 0);
+            sliceSize_.record(sliceSize);
+            if (sliceSize > maxDepth_.load(std::memory_order_relaxed)) {
+                maxDepth_.store(sliceSize, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void onProcessed(size_t sliceSize) {
+        if (sliceSize > 0) {
+            updatePerTick_.record((Instrumentation::nowNs() - sliceStartNs_) / sliceSize);
+        }
+    }
+
+    const LatencyHistogram& sliceQueueWait() const { return sliceQueueWait_; }
+    const LatencyHistogram& updatePerTick() const { return updatePerTick_; }
+    const LatencyHistogram& sliceSize() const { return sliceSize_; }
+    size_t maxDepth() const { return maxDepth_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> oldestEnqueueNs_{0};  // any producer
+    uint64_t sliceStartNs_ = 0;     // drain task only
+    LatencyHistogram sliceQueueWait_;
+    LatencyHistogram updatePerTick_;
+    LatencyHistogram sliceSize_;
+    std::atomic<size_t> maxDepth_{0};
+};
+
+#else
+
+class ShardMetrics {
+public:
+    void onEnqueue(bool) {}
+    void onDequeue(size_t) {}
+    void onProcessed(size_t) {}
+};
+
+#endif
+
+} // namespace MarketData
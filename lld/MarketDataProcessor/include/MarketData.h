@@ -1,11 +1,48 @@
 #pragma once
 
+#include "SeqLock.h"
+#include "SymbolTable.h"
 #include <string>
 #include <chrono>
 #include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
 
 namespace MarketData {
 
+// Prices are fixed-point integers in units of 1/kPriceScale
+constexpr int64_t kPriceScale = 10000;
+
+inline int64_t toFixedPrice(double price) {
+    return std::llround(price * kPriceScale);
+}
+
+inline double toDoublePrice(int64_t price) {
+    return static_cast<double>(price) / kPriceScale;
+}
+
+// Monotonic nanoseconds, for callers without their own clock
+inline uint64_t steadyNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Compact tick handled by every Processor path. The timestamp comes from the
+// caller (steady clock, TSC, exchange time); the processor never reads a clock.
+struct Tick {
+    SymbolId symbol;     // from SymbolTable::global()
+    int32_t quantity;
+    int64_t price;       // fixed point, see kPriceScale
+    uint64_t timestamp;  // caller-defined units, typically nanoseconds
+};
+
+static_assert(sizeof(Tick) == 24, "Tick should stay 24 bytes");
+static_assert(std::is_trivially_copyable<Tick>::value, "Tick must be trivially copyable");
+
+// Convenience form for callers holding a symbol name; converted to a Tick on entry
 struct MarketData {
     std::string symbol;
     double price;
@@ -15,26 +52,238 @@ struct MarketData {
     MarketData(const std::string& sym, double p, int q)
         : symbol(sym), price(p), quantity(q), 
           timestamp(std::chrono::system_clock::now()) {}
+
+    Tick toTick() const {
+        return Tick{SymbolTable::global().intern(symbol), quantity, toFixedPrice(price),
+                    static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        timestamp.time_since_epoch()).count())};
+    }
+};
+
+// Tuning for the per-symbol analytics; timestamps are in the caller's units
+struct AnalyticsConfig {
+    uint64_t timestampsPerSecond = 1'000'000'000;  // nanoseconds by default
+    uint64_t barInterval = 1'000'000'000;          // OHLC bar length, in timestamp units
+    double volatilityLambda = 0.94;                // EWMA decay for squared log returns
+    double tickRateLambda = 0.95;                  // EWMA decay for inter-tick intervals
+    double quantileStep = 0.01;                    // learning rate for the size quantiles
+};
+
+// Trivial (no member initializers) so it can travel through a SeqLock;
+// value-initialize with {}
+struct Bar {
+    uint64_t start;   // timestamp of the bar boundary
+    int64_t open;
+    int64_t high;
+    int64_t low;
+    int64_t close;
+    int64_t volume;
+    double notional;  // sum of price * quantity in price units
+
+    double vwap() const { return volume ? notional / volume : 0.0; }
+};
+
+// Fields written on every tick. Together with the SeqLock's sequence word they
+// fill exactly one cache line, so a tick publishes one line.
+struct HotStats {
+    int64_t lastPrice;     // fixed point
+    int64_t totalVolume;
+    uint64_t tickCount;
+    uint64_t lastUpdate;
+    double notional;       // sum of price * quantity in price units
+    double returnVariance;
+    double meanInterval;   // EWMA of time between ticks, timestamp units
+};
+
+// Bars and size quantiles, published every kColdPublishTicks ticks, when a bar
+// closes, and on flush(). Carries the hot fields as of the same tick, so a
+// snapshot never pairs bars with a later price or volume.
+struct ColdStats {
+    HotStats hot;
+    Bar currentBar;
+    Bar lastBar;           // most recently completed bar
+    uint64_t barsCompleted;
+    double sizeP50;        // streaming estimates of trade size quantiles
+    double sizeP90;
+    double sizeP99;
 };
 
+static_assert(std::is_trivial_v<HotStats> && std::is_trivial_v<ColdStats>, "Published stats must stay trivial for SeqLock");
+static_assert(sizeof(SeqLock<HotStats>) == 64, "Hot stats and their sequence should fill one cache line");
+
+// View of one symbol's analytics as of a single tick: every field, hot or
+// cold, describes the same point in the stream. It may trail the per-tick
+// getters by up to kColdPublishTicks ticks until the writer flushes.
+struct StatsSnapshot {
+    int64_t lastPrice;     // fixed point
+    int64_t totalVolume;
+    uint64_t tickCount;
+    uint64_t lastUpdate;
+    double notional;       // sum of price * quantity in price units
+    double returnVariance;
+    double meanInterval;   // EWMA of time between ticks, timestamp units
+    double tickRate;       // ticks per second derived from meanInterval
+
+    Bar currentBar;
+    Bar lastBar;           // most recently completed bar
+    uint64_t barsCompleted;
+    double sizeP50;        // streaming estimates of trade size quantiles
+    double sizeP90;
+    double sizeP99;
+
+    double vwap() const { return totalVolume ? notional / totalVolume : 0.0; }
+    double volatility() const { return std::sqrt(returnVariance); }  // per-tick, of log returns
+};
+
+// Incremental analytics for one symbol, O(1) per tick. Written by a single
+// thread; readers take consistent copies through two seqlocks, one for the
+// per-tick fields and one for the slower-moving bars and quantiles together
+// with the per-tick fields they were computed from.
 class MarketDataStats {
 public:
-    MarketDataStats() = default;
-    
-    void update(const MarketData& data) {
-        totalVolume_ += data.quantity;
-        lastPrice_ = data.price;
-        lastUpdate_ = data.timestamp;
+    // Ticks between publishes of the cold analytics
+    static constexpr uint64_t kColdPublishTicks = 64;
+
+    explicit MarketDataStats(const AnalyticsConfig& config = AnalyticsConfig{}) : config_(config) {}
+
+    // Prevent copying
+    MarketDataStats(const MarketDataStats&) = delete;
+    MarketDataStats& operator=(const MarketDataStats&) = delete;
+
+    // Writer only
+    void update(const Tick& tick) {
+        HotStats& s = hot_;
+        double price = toDoublePrice(tick.price);
+
+        if (s.tickCount > 0) {
+            if (s.lastPrice > 0 && tick.price > 0) {
+                double logReturn = std::log(price / toDoublePrice(s.lastPrice));
+                s.returnVariance = ewma(s.returnVariance, logReturn * logReturn, config_.volatilityLambda);
+            }
+            if (tick.timestamp > s.lastUpdate) {
+                double interval = static_cast<double>(tick.timestamp - s.lastUpdate);
+                s.meanInterval = s.tickCount == 1 ? interval : ewma(s.meanInterval, interval, config_.tickRateLambda);
+            }
+        }
+
+        s.lastPrice = tick.price;
+        s.totalVolume += tick.quantity;
+        s.notional += price * tick.quantity;
+        s.lastUpdate = std::max(s.lastUpdate, tick.timestamp);
+        ++s.tickCount;
+
+        bool barClosed = updateBar(tick, price);
+        updateQuantiles(tick.quantity);
+
+        hotPublished_.store(s);
+        ++coldPending_;
+        if (barClosed || coldPending_ >= kColdPublishTicks) {
+            flush();
+        }
     }
-    
-    double getLastPrice() const { return lastPrice_; }
-    int getTotalVolume() const { return totalVolume_; }
-    std::chrono::system_clock::time_point getLastUpdate() const { return lastUpdate_; }
-    
+
+    // Writer only: publishes the bars and quantiles now. The Processor calls
+    // this at the end of every drain slice.
+    void flush() {
+        if (coldPending_ > 0) {
+            cold_.hot = hot_;
+            coldPublished_.store(cold_);
+            coldPending_ = 0;
+        }
+    }
+
+    // Writer only: true if flush() would publish something
+    bool hasUnflushed() const { return coldPending_ > 0; }
+
+    // Any thread. Reads the cold copy first, so the hot line can only be
+    // newer; if it is, the hot fields published with the cold ones are used
+    // instead, and every field describes the same tick.
+    StatsSnapshot snapshot() const {
+        ColdStats cold = coldPublished_.load();
+        HotStats hot = hotPublished_.load();
+        if (hot.tickCount != cold.hot.tickCount) {
+            hot = cold.hot;
+        }
+
+        StatsSnapshot view{};
+        view.lastPrice = hot.lastPrice;
+        view.totalVolume = hot.totalVolume;
+        view.tickCount = hot.tickCount;
+        view.lastUpdate = hot.lastUpdate;
+        view.notional = hot.notional;
+        view.returnVariance = hot.returnVariance;
+        view.meanInterval = hot.meanInterval;
+        view.tickRate = hot.meanInterval > 0 ? config_.timestampsPerSecond / hot.meanInterval : 0.0;
+        view.currentBar = cold.currentBar;
+        view.lastBar = cold.lastBar;
+        view.barsCompleted = cold.barsCompleted;
+        view.sizeP50 = cold.sizeP50;
+        view.sizeP90 = cold.sizeP90;
+        view.sizeP99 = cold.sizeP99;
+        return view;
+    }
+
+    // These read only the hot line
+    double getLastPrice() const { return toDoublePrice(hotPublished_.load().lastPrice); }
+    int64_t getLastPriceFixed() const { return hotPublished_.load().lastPrice; }
+    int64_t getTotalVolume() const { return hotPublished_.load().totalVolume; }
+    uint64_t getLastUpdate() const { return hotPublished_.load().lastUpdate; }
+
 private:
-    std::atomic<double> lastPrice_{0.0};
-    std::atomic<int> totalVolume_{0};
-    std::chrono::system_clock::time_point lastUpdate_;
+    static double ewma(double average, double sample, double lambda) {
+        return lambda * average + (1.0 - lambda) * sample;
+    }
+
+    // Returns true if the tick closed the previous bar
+    bool updateBar(const Tick& tick, double price) {
+        Bar& bar = cold_.currentBar;
+        uint64_t interval = std::max<uint64_t>(1, config_.barInterval);
+        uint64_t start = tick.timestamp - tick.timestamp % interval;
+
+        // Late ticks are folded into the open bar rather than reopening a closed one
+        bool first = hot_.tickCount == 1;
+        bool closed = false;
+        if (first || start > bar.start) {
+            if (!first) {
+                cold_.lastBar = bar;
+                ++cold_.barsCompleted;
+                closed = true;
+            }
+            bar = Bar{start, tick.price, tick.price, tick.price, tick.price, 0, 0.0};
+        }
+        bar.high = std::max(bar.high, tick.price);
+        bar.low = std::min(bar.low, tick.price);
+        bar.close = tick.price;
+        bar.volume += tick.quantity;
+        bar.notional += price * tick.quantity;
+        return closed;
+    }
+
+    // Stochastic-approximation quantile tracking: each estimate moves up by
+    // step * p when a sample lands above it and down by step * (1 - p)
+    // otherwise, so it settles where a fraction p of recent samples fall below.
+    // The step scales with the current median so it adapts to the size range.
+    void updateQuantiles(int32_t quantity) {
+        double x = quantity;
+        if (hot_.tickCount == 1) {
+            cold_.sizeP50 = cold_.sizeP90 = cold_.sizeP99 = x;
+            return;
+        }
+        double step = config_.quantileStep * std::max(1.0, cold_.sizeP50);
+        auto track = [x, step](double& estimate, double p) {
+            estimate += x > estimate ? step * p : -step * (1.0 - p);
+        };
+        track(cold_.sizeP50, 0.50);
+        track(cold_.sizeP90, 0.90);
+        track(cold_.sizeP99, 0.99);
+    }
+
+    const AnalyticsConfig config_;
+    HotStats hot_{};    // writer's working copies
+    ColdStats cold_{};
+    uint64_t coldPending_ = 0;  // ticks since cold_ was last published
+    SeqLock<HotStats> hotPublished_;
+    SeqLock<ColdStats> coldPublished_;
 };
 
-} // namespace MarketData 
\ No newline at end of file
+} // namespace MarketData 
@@ -1,16 +1,46 @@
 #pragma once
 
+#include "BoundedQueue.h"
+#include "Instrumentation.h"
 #include "MarketData.h"
+#include "StatsTable.h"
 #include "ThreadPool.h"
-#include <unordered_map>
-#include <mutex>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace MarketData {
 
+// Symbols are hashed onto shards. A shard is drained by at most one pool task
+// at a time, so its stats have a single writer, ticks for a symbol are applied
+// in arrival order, and shards proceed in parallel without a shared lock.
+//
+// Ticks are handed to a shard through a lock-free ring (BoundedQueue), so
+// producers never take a lock; the drain task empties the ring into its own
+// buffer and works through the slice. The ring is preallocated and the buffer
+// keeps its capacity, so steady-state ingestion does not allocate per tick. A
+// full ring makes producers wait for the drain task (backpressure).
 class Processor {
 public:
-    explicit Processor(size_t numThreads) : threadPool_(numThreads) {}
+    // Ticks a shard's ring holds before producers wait
+    static constexpr size_t kShardCapacity = 1 << 16;
+
+    explicit Processor(size_t numThreads, const AnalyticsConfig& config = AnalyticsConfig{})
+        : threadPool_(numThreads) {
+        size_t numShards = std::max<size_t>(1, numThreads);
+        shards_.reserve(numShards);
+        for (size_t i = 0; i < numShards; ++i) {
+            shards_.push_back(std::make_unique<Shard>(config));
+        }
+    }
 
     ~Processor() {
         stop();
@@ -31,35 +61,300 @@ public:
     void stop() {
         running_ = false;
         threadPool_.stop();
+        // Releases producers waiting on a full ring; their ticks are dropped
+        for (auto& shard : shards_) {
+            shard->pending.stop();
+        }
+        stopMetricsDump();
+    }
+
+    void addData(const Tick& tick) {
+        if (!running_) return;
+
+        Shard& shard = *shards_[shardIndex(tick.symbol)];
+        // The argument reads the ring's shared indices, so skip it entirely when compiled out
+        if constexpr (kInstrumentationEnabled) {
+            shard.metrics.onEnqueue(shard.pending.empty());
+        }
+        // Counted before the push so pendingTicks() never sees it consumed first
+        std::atomic<uint64_t>& produced = producedSlot();
+        produced.fetch_add(1, std::memory_order_relaxed);
+        if (!shard.pending.push(tick)) {
+            produced.fetch_sub(1, std::memory_order_relaxed);  // stopped while full
+            return;
+        }
+        scheduleIfIdle(shard);
+    }
+
+    // Groups the batch by shard (stable, so per-symbol order is kept) and
+    // hands each shard its slice, scheduling at most one task per shard
+    void addBatch(const Tick* ticks, size_t count) {
+        if (!running_ || count == 0) return;
+
+        // Counting sort by shard into reusable per-thread scratch space
+        thread_local std::vector<uint32_t> shardOf;
+        thread_local std::vector<Tick> sorted;
+        thread_local std::vector<size_t> offsets;
+        shardOf.resize(count);
+        sorted.resize(count);
+        offsets.assign(shards_.size() + 1, 0);
+
+        for (size_t i = 0; i < count; ++i) {
+            shardOf[i] = static_cast<uint32_t>(shardIndex(ticks[i].symbol));
+            ++offsets[shardOf[i] + 1];
+        }
+        for (size_t s = 0; s < shards_.size(); ++s) {
+            offsets[s + 1] += offsets[s];
+        }
+        for (size_t i = 0; i < count; ++i) {
+            sorted[offsets[shardOf[i]]++] = ticks[i];
+        }
+
+        std::atomic<uint64_t>& produced = producedSlot();
+        produced.fetch_add(count, std::memory_order_relaxed);
+
+        // offsets[s] now marks the end of shard s's run
+        size_t begin = 0;
+        for (size_t s = 0; s < shards_.size(); ++s) {
+            size_t end = offsets[s];
+            if (begin == end) {
+                continue;
+            }
+            Shard& shard = *shards_[s];
+            if constexpr (kInstrumentationEnabled) {
+                shard.metrics.onEnqueue(shard.pending.empty());
+            }
+            // One fence and scheduling check for the whole slice; if the ring
+            // fills up part way, a drain task is scheduled before waiting
+            size_t pushed = shard.pending.push(sorted.data() + begin, end - begin,
+                                               [this, &shard] { scheduleIfIdle(shard); });
+            if (pushed < end - begin) {
+                produced.fetch_sub(end - begin - pushed, std::memory_order_relaxed);  // stopped while full
+            }
+            if (pushed > 0) {
+                scheduleIfIdle(shard);
+            }
+            begin = end;
+        }
+    }
+
+    void addBatch(const std::vector<Tick>& batch) {
+        addBatch(batch.data(), batch.size());
     }
 
+    // Interns the symbol and converts to a Tick; prefer the Tick overload on hot paths
     void addData(const MarketData& data) {
         if (!running_) return;
+        addData(data.toTick());
+    }
+
+    const MarketDataStats* getStats(SymbolId symbol) const {
+        return symbol == kInvalidSymbol ? nullptr : shards_[shardIndex(symbol)]->stats.find(symbol);
+    }
+
+    // Consistent copy of every analytic for the symbol; empty if it has not traded
+    std::optional<StatsSnapshot> getSnapshot(SymbolId symbol) const {
+        const MarketDataStats* stats = getStats(symbol);
+        return stats ? std::optional<StatsSnapshot>(stats->snapshot()) : std::nullopt;
+    }
+
+    std::optional<StatsSnapshot> getSnapshot(const std::string& symbol) const {
+        return getSnapshot(SymbolTable::global().find(symbol));
+    }
 
-        threadPool_.submit([this, data] {
-            std::lock_guard<std::mutex> lock(mutex_);
-            auto& stats = stats_[data.symbol];
-            stats.update(data);
-        });
+    double getLastPrice(SymbolId symbol) const {
+        const MarketDataStats* stats = getStats(symbol);
+        return stats ? stats->getLastPrice() : 0.0;
+    }
+
+    int64_t getTotalVolume(SymbolId symbol) const {
+        const MarketDataStats* stats = getStats(symbol);
+        return stats ? stats->getTotalVolume() : 0;
     }
 
     double getLastPrice(const std::string& symbol) const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = stats_.find(symbol);
-        return it != stats_.end() ? it->second.getLastPrice() : 0.0;
+        return getLastPrice(SymbolTable::global().find(symbol));
+    }
+
+    int64_t getTotalVolume(const std::string& symbol) const {
+        return getTotalVolume(SymbolTable::global().find(symbol));
+    }
+
+    size_t shardCount() const { return shards_.size(); }
+
+    // Ticks accepted but not yet picked up by a drain task
+    size_t backlog() const {
+        size_t total = 0;
+        for (const auto& shard : shards_) {
+            total += shard->pending.size();
+        }
+        return total;
+    }
+
+    // Same as backlog() without touching the shards' rings, so producers can
+    // poll it for backpressure. Producers count into per-thread slots and each
+    // drain task into its shard's slot; this sums the two sides.
+    size_t pendingTicks() const {
+        // Consumed first: every tick counted there was already produced
+        uint64_t consumed = 0;
+        for (const auto& shard : shards_) {
+            consumed += shard->consumed.value.load(std::memory_order_acquire);
+        }
+        uint64_t produced = 0;
+        for (const Counter& slot : produced_) {
+            produced += slot.value.load(std::memory_order_relaxed);
+        }
+        return produced > consumed ? static_cast<size_t>(produced - consumed) : 0;
+    }
+
+    // True once every accepted tick has been applied to the stats
+    bool idle() const {
+        for (const auto& shard : shards_) {
+            if (shard->scheduled.load(std::memory_order_acquire) || !shard->pending.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void waitIdle() const {
+        while (!idle()) {
+            std::this_thread::yield();
+        }
     }
 
-    int getTotalVolume(const std::string& symbol) const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = stats_.find(symbol);
-        return it != stats_.end() ? it->second.getTotalVolume() : 0;
+    // Latency histograms, queue depths and worker utilization. Depths are
+    // always reported; the rest stays empty unless built with instrumentation.
+    InstrumentationSnapshot instrumentation() const {
+        InstrumentationSnapshot snapshot;
+        for (const auto& shard : shards_) {
+            snapshot.shardDepth.push_back(shard->pending.size());
+        }
+        snapshot.poolDepth = threadPool_.queueDepth();
+#if MDP_INSTRUMENTATION
+        std::vector<const LatencyHistogram*> sliceQueueWait, updatePerTick, sliceSize;
+        for (const auto& shard : shards_) {
+            sliceQueueWait.push_back(&shard->metrics.sliceQueueWait());
+            updatePerTick.push_back(&shard->metrics.updatePerTick());
+            sliceSize.push_back(&shard->metrics.sliceSize());
+            snapshot.shardMaxDepth.push_back(shard->metrics.maxDepth());
+        }
+        snapshot.sliceQueueWait = LatencyHistogram::summarize(sliceQueueWait);
+        snapshot.updatePerTick = LatencyHistogram::summarize(updatePerTick);
+        snapshot.sliceSize = LatencyHistogram::summarize(sliceSize);
+        snapshot.taskWait = threadPool_.taskWait();
+        snapshot.workerUtilization = threadPool_.utilization();
+#endif
+        return snapshot;
+    }
+
+    // Appends one JSON snapshot per interval to path until stopped
+    void startMetricsDump(const std::string& path, std::chrono::milliseconds interval) {
+        dumper_.reset();
+        dumper_ = std::make_unique<PeriodicDumper>(path, interval,
+                                                   [this](std::ostream& out) { out << instrumentation(); });
+    }
+
+    void stopMetricsDump() {
+        dumper_.reset();
     }
 
 private:
+    static constexpr size_t kCacheLineSize = 64;
+    // Producer threads hash onto this many counters; a collision only means
+    // two producers share a cache line
+    static constexpr size_t kProducerSlots = 16;
+
+    struct alignas(kCacheLineSize) Counter {
+        std::atomic<uint64_t> value{0};
+    };
+
+    struct Shard {
+        explicit Shard(const AnalyticsConfig& config) : pending(kShardCapacity), stats(config) {}
+
+        BoundedQueue<Tick> pending;        // producers push, the drain task pops
+        std::atomic<bool> scheduled{false}; // a drain task owns the shard
+        std::vector<Tick> draining;        // owned by the drain task
+        std::vector<MarketDataStats*> touched; // owned by the drain task; stats to flush
+        StatsTable stats;                  // written only by the drain task
+        ShardMetrics metrics;              // empty unless built with instrumentation
+        Counter consumed;                  // ticks popped by drain tasks, ever
+    };
+
+    std::atomic<uint64_t>& producedSlot() {
+        thread_local const size_t slot = std::hash<std::thread::id>{}(std::this_thread::get_id()) % kProducerSlots;
+        return produced_[slot].value;
+    }
+
+    // Ids are dense and assigned in arrival order, so modulo spreads them evenly
+    size_t shardIndex(SymbolId symbol) const {
+        return symbol % shards_.size();
+    }
+
+    // Called after every push (per tick from addData, per shard slice from
+    // addBatch) and before a batch push waits on a full ring, so a blocked
+    // producer always has a drain task behind it. The plain load keeps the
+    // common case (task already scheduled) to a shared read. Both push forms
+    // end with a seq_cst fence, which pairs with the one in drain(): either the
+    // drain task sees the new ticks after clearing its flag, or this load sees
+    // it cleared. That fence is paid on every push, not just when the ring goes
+    // from empty to non-empty, which is why addBatch pushes a slice at a time.
+    void scheduleIfIdle(Shard& shard) {
+        if (!shard.scheduled.load(std::memory_order_relaxed) &&
+            !shard.scheduled.exchange(true, std::memory_order_acq_rel)) {
+            schedule(shard);
+        }
+    }
+
+    void schedule(Shard& shard) {
+        threadPool_.post([this, &shard] { drain(shard); });
+    }
+
+    void drain(Shard& shard) {
+        // At most one ring's worth per task, so a busy shard lets others run
+        while (shard.draining.size() < kShardCapacity) {
+            auto tick = shard.pending.try_pop();
+            if (!tick) {
+                break;
+            }
+            shard.draining.push_back(*tick);
+        }
+        shard.metrics.onDequeue(shard.draining.size());
+        // Only this task writes the shard's count, so no read-modify-write
+        uint64_t consumed = shard.consumed.value.load(std::memory_order_relaxed);
+        shard.consumed.value.store(consumed + shard.draining.size(), std::memory_order_release);
+
+        for (const Tick& tick : shard.draining) {
+            MarketDataStats& stats = shard.stats.getOrCreate(tick.symbol);
+            if (!stats.hasUnflushed()) {
+                shard.touched.push_back(&stats);
+            }
+            stats.update(tick);
+        }
+        // Per tick only the hot line is published; bring bars and quantiles
+        // up to date once per slice
+        for (MarketDataStats* stats : shard.touched) {
+            stats->flush();
+        }
+        shard.touched.clear();
+        shard.metrics.onProcessed(shard.draining.size());
+        shard.draining.clear();
+
+        shard.scheduled.store(false, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // More arrived meanwhile: requeue behind other shards' tasks
+        if (!shard.pending.empty()) {
+            scheduleIfIdle(shard);
+        }
+    }
+
+    // Shards are declared first so the pool joins its workers before they go away
+    std::vector<std::unique_ptr<Shard>> shards_;
     ThreadPool threadPool_;
-    std::unordered_map<std::string, MarketDataStats> stats_;
-    mutable std::mutex mutex_;
     std::atomic<bool> running_{false};
+    std::array<Counter, kProducerSlots> produced_;  // ticks pushed, ever, by producer slot
+    // Last, so it stops sampling before the pool and shards go away
+    std::unique_ptr<PeriodicDumper> dumper_;
 };
 
-} // namespace MarketData 
\ No newline at end of file
+} // namespace MarketData
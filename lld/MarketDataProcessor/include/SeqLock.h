@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace MarketData {
+
+// Single-writer sequence lock for a trivially copyable value.
+// The writer never blocks; readers copy the value and retry if a write
+// overlapped (odd or changed sequence). The payload is stored as relaxed
+// atomic words so concurrent reads are well-defined.
+template<typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock requires a trivially copyable type");
+
+public:
+    SeqLock() { store(T{}); }
+
+    // Prevent copying
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    // Writer only
+    void store(const T& value) {
+        std::array<uint64_t, kWords> buffer{};
+        std::memcpy(buffer.data(), &value, sizeof(T));
+
+        uint64_t seq = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; ++i) {
+            words_[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence_.store(seq + 2, std::memory_order_release);
+    }
+
+    // Single attempt; false if a write was in progress or overlapped the copy
+    bool tryLoad(T& out) const {
+        uint64_t before = sequence_.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+
+        std::array<uint64_t, kWords> buffer;
+        for (size_t i = 0; i < kWords; ++i) {
+            buffer[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+
+        std::memcpy(&out, buffer.data(), sizeof(T));
+        return true;
+    }
+
+    // Retries until a consistent copy is obtained
+    T load() const {
+        T value;
+        unsigned attempts = 0;
+        while (!tryLoad(value)) {
+            if (++attempts > 64) {
+                std::this_thread::yield();
+            }
+        }
+        return value;
+    }
+
+    // Number of completed stores
+    uint64_t version() const { return sequence_.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    alignas(kCacheLineSize) std::atomic<uint64_t> sequence_{0};
+    std::array<std::atomic<uint64_t>, kWords> words_{};
+};
+
+} // namespace MarketData
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "MarketData.h"
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace MarketData {
+
+// Stats indexed directly by symbol id, with a single writer and lock-free
+// readers. Ids are dense, so a two-level directory of fixed-size chunks
+// replaces hashing: the writer allocates a chunk the first time one of its ids
+// shows up and publishes stats objects that never move afterwards.
+class StatsTable {
+public:
+    explicit StatsTable(const AnalyticsConfig& config = AnalyticsConfig{},
+                        size_t maxSymbols = SymbolTable::global().capacity())
+        : config_(config)
+        , numChunks_((maxSymbols + kChunkSize - 1) / kChunkSize)
+        , chunks_(std::make_unique<std::atomic<Chunk*>[]>(numChunks_))
+    {
+    }
+
+    // Prevent copying
+    StatsTable(const StatsTable&) = delete;
+    StatsTable& operator=(const StatsTable&) = delete;
+
+    // Prevent moving
+    StatsTable(StatsTable&&) = delete;
+    StatsTable& operator=(StatsTable&&) = delete;
+
+    // Writer only
+    MarketDataStats& getOrCreate(SymbolId symbol) {
+        size_t chunkIndex = symbol / kChunkSize;
+        if (chunkIndex >= numChunks_) {
+            throw std::out_of_range("Symbol id beyond stats table capacity");
+        }
+        Chunk* chunk = chunks_[chunkIndex].load(std::memory_order_relaxed);
+        if (!chunk) {
+            owned_.push_back(std::make_unique<Chunk>());
+            chunk = owned_.back().get();
+            chunks_[chunkIndex].store(chunk, std::memory_order_release);
+        }
+
+        auto& slot = chunk->slots[symbol % kChunkSize];
+        if (MarketDataStats* stats = slot.get()) {
+            return *stats;
+        }
+        auto stats = std::make_unique<MarketDataStats>(config_);
+        MarketDataStats* raw = stats.get();
+        slot.publish(std::move(stats));
+        return *raw;
+    }
+
+    // Any thread
+    const MarketDataStats* find(SymbolId symbol) const {
+        size_t chunkIndex = symbol / kChunkSize;
+        if (chunkIndex >= numChunks_) {
+            return nullptr;
+        }
+        const Chunk* chunk = chunks_[chunkIndex].load(std::memory_order_acquire);
+        return chunk ? chunk->slots[symbol % kChunkSize].get() : nullptr;
+    }
+
+private:
+    static constexpr size_t kChunkSize = 1024;
+
+    struct Slot {
+        ~Slot() { delete stats.load(std::memory_order_relaxed); }
+
+        MarketDataStats* get() const { return stats.load(std::memory_order_acquire); }
+        void publish(std::unique_ptr<MarketDataStats> value) {
+            stats.store(value.release(), std::memory_order_release);
+        }
+
+        std::atomic<MarketDataStats*> stats{nullptr};
+    };
+
+    struct Chunk {
+        Slot slots[kChunkSize];
+    };
+
+    const AnalyticsConfig config_;
+    const size_t numChunks_;
+    std::unique_ptr<std::atomic<Chunk*>[]> chunks_;
+    std::vector<std::unique_ptr<Chunk>> owned_;  // writer only
+};
+
+} // namespace MarketData
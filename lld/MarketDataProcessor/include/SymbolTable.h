@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace MarketData {
+
+using SymbolId = uint32_t;
+constexpr SymbolId kInvalidSymbol = std::numeric_limits<SymbolId>::max();
+
+// Interns symbol names to dense 32-bit ids without locks: the name index is a
+// fixed-size open-addressing table of entry pointers claimed with a CAS, so
+// the capacity is set up front. Ids are handed out in insertion order starting
+// at 0 and are never reused. The only wait is a reader seeing an entry in the
+// instant between its insert winning the slot and storing its id.
+class SymbolTable {
+public:
+    static constexpr size_t kDefaultCapacity = 1 << 18;
+
+    explicit SymbolTable(size_t maxSymbols = kDefaultCapacity)
+        : capacity_(maxSymbols)
+        , mask_(indexSizeFor(maxSymbols) - 1)
+        , index_(std::make_unique<std::atomic<Entry*>[]>(mask_ + 1))
+        , byId_(std::make_unique<std::atomic<Entry*>[]>(maxSymbols))
+    {
+    }
+
+    ~SymbolTable() {
+        for (size_t i = 0; i <= mask_; ++i) {
+            delete index_[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    // Prevent copying
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // Prevent moving
+    SymbolTable(SymbolTable&&) = delete;
+    SymbolTable& operator=(SymbolTable&&) = delete;
+
+    // Process-wide table shared by every Processor
+    static SymbolTable& global() {
+        static SymbolTable table;
+        return table;
+    }
+
+    // Returns the id for name, assigning the next one on first sight
+    SymbolId intern(std::string_view name) {
+        size_t hash = std::hash<std::string_view>{}(name);
+        std::unique_ptr<Entry> candidate;
+
+        for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+            Entry* entry = index_[i].load(std::memory_order_acquire);
+            if (!entry) {
+                if (nextId_.load(std::memory_order_relaxed) >= capacity_) {
+                    throw std::runtime_error("Symbol table full");
+                }
+                if (!candidate) {
+                    candidate = std::make_unique<Entry>(name, hash);
+                }
+                if (!index_[i].compare_exchange_strong(entry, candidate.get(), std::memory_order_acq_rel,
+                                                       std::memory_order_acquire)) {
+                    // Lost the slot; entry now holds the winner, check it below
+                } else {
+                    return publish(candidate.release());
+                }
+            }
+            if (entry->hash == hash && entry->name == name) {
+                SymbolId id = waitForId(*entry);
+                if (id == kRejected) {
+                    throw std::runtime_error("Symbol table full");
+                }
+                return id;
+            }
+        }
+    }
+
+    // Returns kInvalidSymbol if the name was never interned
+    SymbolId find(std::string_view name) const {
+        size_t hash = std::hash<std::string_view>{}(name);
+        for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+            Entry* entry = index_[i].load(std::memory_order_acquire);
+            if (!entry) {
+                return kInvalidSymbol;
+            }
+            if (entry->hash == hash && entry->name == name) {
+                SymbolId id = waitForId(*entry);
+                return id == kRejected ? kInvalidSymbol : id;
+            }
+        }
+    }
+
+    // Name for an id returned by intern
+    const std::string& name(SymbolId id) const {
+        Entry* entry = id < capacity_ ? byId_[id].load(std::memory_order_acquire) : nullptr;
+        if (!entry) {
+            throw std::out_of_range("Unknown symbol id");
+        }
+        return entry->name;
+    }
+
+    size_t size() const { return std::min<size_t>(nextId_.load(std::memory_order_acquire), capacity_); }
+    size_t capacity() const { return capacity_; }
+
+private:
+    // Marks an entry that was indexed after the table filled up
+    static constexpr SymbolId kRejected = kInvalidSymbol - 1;
+
+    struct Entry {
+        Entry(std::string_view n, size_t h) : name(n), hash(h) {}
+
+        const std::string name;
+        const size_t hash;
+        std::atomic<SymbolId> id{kInvalidSymbol};  // set right after the entry wins its slot
+    };
+
+    // Index kept at most half full
+    static size_t indexSizeFor(size_t maxSymbols) {
+        if (maxSymbols == 0 || maxSymbols >= kInvalidSymbol - 1) {
+            throw std::invalid_argument("Symbol table capacity out of range");
+        }
+        size_t size = 2;
+        while (size < maxSymbols * 2) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    SymbolId publish(Entry* entry) {
+        uint32_t id = nextId_.fetch_add(1, std::memory_order_acq_rel);
+        if (id >= capacity_) {
+            // Lost a race for the last id; the name stays in the index, unusable
+            entry->id.store(kRejected, std::memory_order_release);
+            throw std::runtime_error("Symbol table full");
+        }
+        byId_[id].store(entry, std::memory_order_release);
+        entry->id.store(id, std::memory_order_release);
+        return id;
+    }
+
+    // A racing interner may have claimed the slot but not stored the id yet
+    static SymbolId waitForId(const Entry& entry) {
+        SymbolId id;
+        while ((id = entry.id.load(std::memory_order_acquire)) == kInvalidSymbol) {
+            std::this_thread::yield();
+        }
+        return id;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<std::atomic<Entry*>[]> index_;
+    std::unique_ptr<std::atomic<Entry*>[]> byId_;
+    std::atomic<uint32_t> nextId_{0};
+};
+
+} // namespace MarketData
@@ -1,18 +1,23 @@
 #pragma once
 
+#include "BoundedQueue.h"
 #include "Queue.h"
+#include "WorkStealingThreadPool.h"
 #include <vector>
 #include <thread>
 #include <functional>
 #include <future>
+#include <stdexcept>
 #include <type_traits>
 #include <atomic>
 
 namespace MarketData {
 
-class ThreadPool {
+// TaskQueue is any queue with Queue's push/pop/stop interface
+template<template<typename> class TaskQueue>
+class BasicThreadPool {
 public:
-    explicit ThreadPool(size_t numThreads) : stop_(false) {
+    explicit BasicThreadPool(size_t numThreads) : stop_(false) {
         for (size_t i = 0; i < numThreads; ++i) {
             workers_.emplace_back([this] {
                 while (true) {
@@ -26,7 +31,7 @@ public:
         }
     }
 
-    ~ThreadPool() {
+    ~BasicThreadPool() {
         stop();
         for (auto& worker : workers_) {
             if (worker.joinable()) {
@@ -36,13 +41,15 @@ public:
     }
 
     // Prevent copying
-    ThreadPool(const ThreadPool&) = delete;
-    ThreadPool& operator=(const ThreadPool&) = delete;
+    BasicThreadPool(const BasicThreadPool&) = delete;
+    BasicThreadPool& operator=(const BasicThreadPool&) = delete;
 
     // Prevent moving
-    ThreadPool(ThreadPool&&) = delete;
-    ThreadPool& operator=(ThreadPool&&) = delete;
+    BasicThreadPool(BasicThreadPool&&) = delete;
+    BasicThreadPool& operator=(BasicThreadPool&&) = delete;
 
+    // Throws std::runtime_error once the pool is stopped, rather than
+    // returning a future that would only ever report broken_promise
     template<class F, class... Args>
     auto submit(F&& f, Args&&... args)
         -> std::future<typename std::invoke_result<F, Args...>::type> {
@@ -53,19 +60,52 @@ public:
         );
 
         std::future<return_type> res = task->get_future();
-        tasks_.push([task]() { (*task)(); });
+        if (!accept([task]() { (*task)(); })) {
+            throw std::runtime_error("submit on a stopped thread pool");
+        }
         return res;
     }
 
+    // Fire-and-forget: no packaged_task, shared state or future. Small
+    // callables (a couple of pointers) fit std::function's inline buffer, so
+    // posting does not allocate beyond the queue's own storage.
+    template<class F>
+    void post(F&& f) {
+        tasks_.push(std::function<void()>(std::forward<F>(f)));
+    }
+
     void stop() {
         stop_ = true;
         tasks_.stop();
     }
 
 private:
+    using Task = std::function<void()>;
+
+    // False if the pool is stopped. Queue::push always takes the task;
+    // BoundedQueue::push refuses it when stopped while full.
+    bool accept(Task task) {
+        if (stop_) {
+            return false;
+        }
+        if constexpr (std::is_same_v<decltype(tasks_.push(std::move(task))), bool>) {
+            return tasks_.push(std::move(task));
+        } else {
+            tasks_.push(std::move(task));
+            return true;
+        }
+    }
+
     std::vector<std::thread> workers_;
-    Queue<std::function<void()>> tasks_;
+    TaskQueue<Task> tasks_;
     std::atomic<bool> stop_;
 };
 
+// Per-worker deques with stealing; the default pool
+using ThreadPool = WorkStealingThreadPool;
+// All workers share one unbounded mutex/condition-variable queue
+using SharedQueueThreadPool = BasicThreadPool<Queue>;
+// Bounded lock-free queue; submit blocks while the queue is full
+using BoundedThreadPool = BasicThreadPool<BoundedQueue>;
+
 } // namespace MarketData 
\ No newline at end of file
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "MarketData.h"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+namespace MarketData {
+
+// Number parsing for CSV ingestion. Digit runs are consumed eight at a time
+// with SWAR arithmetic on a 64-bit word (no per-digit branches), falling back
+// to a scalar loop for the tail and on big-endian targets.
+namespace TickParser {
+
+// Digits in the fractional part of a fixed-point price (kPriceScale == 10^4)
+constexpr int kPriceDecimals = 4;
+
+inline bool isEightDigits(uint64_t word) {
+    return ((word & 0xF0F0F0F0F0F0F0F0ull)
+            | (((word + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull;
+}
+
+// Word holds eight ASCII digits, most significant first in memory
+inline uint32_t parseEightDigits(uint64_t word) {
+    const uint64_t mask = 0x000000FF000000FFull;
+    const uint64_t mul1 = 100 + (1000000ull << 32);
+    const uint64_t mul2 = 1 + (10000ull << 32);
+    word -= 0x3030303030303030ull;
+    word = (word * 10) + (word >> 8);
+    word = (((word & mask) * mul1) + (((word >> 16) & mask) * mul2)) >> 32;
+    return static_cast<uint32_t>(word);
+}
+
+// Appends the digit run at p to value; returns the number of digits read, or
+// -1 if more than maxDigits were present
+inline int parseDigits(const char*& p, const char* end, uint64_t& value, int maxDigits = 19) {
+    const char* start = p;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (end - p >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        if (!isEightDigits(word) || (p - start) + 8 > maxDigits) {
+            break;
+        }
+        value = value * 100000000ull + parseEightDigits(word);
+        p += 8;
+    }
+#endif
+    while (p < end && static_cast<unsigned char>(*p - '0') <= 9) {
+        if (p - start >= maxDigits) {
+            return -1;
+        }
+        value = value * 10 + static_cast<unsigned>(*p - '0');
+        ++p;
+    }
+    return static_cast<int>(p - start);
+}
+
+inline bool parseUnsigned(const char*& p, const char* end, uint64_t& value) {
+    value = 0;
+    return parseDigits(p, end, value) > 0;
+}
+
+// Decimal price such as "123.45" or "-0.5" into fixed point. Digits beyond
+// kPriceDecimals are truncated.
+inline bool parsePrice(const char*& p, const char* end, int64_t& price) {
+    bool negative = p < end && *p == '-';
+    if (negative) {
+        ++p;
+    }
+
+    uint64_t whole = 0;
+    int wholeDigits = parseDigits(p, end, whole, 14);
+    if (wholeDigits < 0) {
+        return false;
+    }
+
+    uint64_t fraction = 0;
+    int fractionDigits = 0;
+    if (p < end && *p == '.') {
+        ++p;
+        // At most kPriceDecimals digits, so a scalar loop is enough
+        while (p < end && static_cast<unsigned char>(*p - '0') <= 9) {
+            if (fractionDigits < kPriceDecimals) {
+                fraction = fraction * 10 + static_cast<unsigned>(*p - '0');
+                ++fractionDigits;
+            }
+            ++p;
+        }
+    }
+    if (wholeDigits == 0 && fractionDigits == 0) {
+        return false;
+    }
+
+    static constexpr int64_t kPow10[] = {1, 10, 100, 1000, 10000};
+    int64_t value = static_cast<int64_t>(whole) * kPriceScale
+                  + static_cast<int64_t>(fraction) * kPow10[kPriceDecimals - fractionDigits];
+    price = negative ? -value : value;
+    return true;
+}
+
+// One "symbol,price,quantity,timestamp" record ending at end (no newline).
+// A trailing '\r' is tolerated.
+inline bool parseCsvRecord(const char* p, const char* end, std::string_view& symbol,
+                           int64_t& price, int32_t& quantity, uint64_t& timestamp) {
+    if (end > p && end[-1] == '\r') {
+        --end;
+    }
+    if (end <= p) {
+        return false;
+    }
+
+    const char* comma = static_cast<const char*>(std::memchr(p, ',', static_cast<size_t>(end - p)));
+    if (!comma || comma == p) {
+        return false;
+    }
+    symbol = std::string_view(p, static_cast<size_t>(comma - p));
+    p = comma + 1;
+
+    if (!parsePrice(p, end, price) || p == end || *p++ != ',') {
+        return false;
+    }
+
+    uint64_t qty;
+    if (!parseUnsigned(p, end, qty) || qty > static_cast<uint64_t>(std::numeric_limits<int32_t>::max())
+        || p == end || *p++ != ',') {
+        return false;
+    }
+    quantity = static_cast<int32_t>(qty);
+
+    return parseUnsigned(p, end, timestamp) && p == end;
+}
+
+} // namespace TickParser
+
+} // namespace MarketData
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace MarketData {
+
+// Chase-Lev work-stealing deque. The owning thread pushes and pops at the
+// bottom (LIFO, cache-warm); any other thread steals from the top (FIFO).
+// T must be trivially copyable, in practice a pointer to the task. The ring
+// grows when full; retired rings are kept until destruction because a thief
+// may still be reading from one.
+template<typename T>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque holds trivially copyable values");
+
+public:
+    explicit WorkStealingDeque(size_t capacity = 1024) {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("Deque capacity must be a power of two >= 2");
+        }
+        retired_.push_back(std::make_unique<Ring>(capacity));
+        ring_.store(retired_.back().get(), std::memory_order_relaxed);
+    }
+
+    // Prevent copying
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Prevent moving
+    WorkStealingDeque(WorkStealingDeque&&) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+
+    // Owner only
+    void push(T value) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_acquire);
+        Ring* ring = ring_.load(std::memory_order_relaxed);
+        if (bottom - top >= static_cast<int64_t>(ring->capacity)) {
+            ring = grow(ring, top, bottom);
+        }
+        ring->put(bottom, value);
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    // Owner only
+    std::optional<T> pop() {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        Ring* ring = ring_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        T value = ring->get(bottom);
+        if (top == bottom) {
+            // Last element: race any thief for it
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            if (!won) {
+                return std::nullopt;
+            }
+        }
+        return value;
+    }
+
+    // Any thread. Returns nullopt when empty or when another thread won the race.
+    std::optional<T> steal() {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return std::nullopt;
+        }
+
+        T value = ring_.load(std::memory_order_acquire)->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t size() const {
+        int64_t bottom = bottom_.load(std::memory_order_acquire);
+        int64_t top = top_.load(std::memory_order_acquire);
+        return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+    }
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+
+    struct Ring {
+        explicit Ring(size_t cap)
+            : capacity(cap), mask(cap - 1), slots(std::make_unique<std::atomic<T>[]>(cap)) {}
+
+        T get(int64_t index) const {
+            return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t index, T value) {
+            slots[static_cast<size_t>(index) & mask].store(value, std::memory_order_relaxed);
+        }
+
+        const size_t capacity;
+        const size_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+    Ring* grow(Ring* old, int64_t top, int64_t bottom) {
+        auto next = std::make_unique<Ring>(old->capacity * 2);
+        for (int64_t i = top; i < bottom; ++i) {
+            next->put(i, old->get(i));
+        }
+        Ring* ring = next.get();
+        retired_.push_back(std::move(next));
+        ring_.store(ring, std::memory_order_release);
+        return ring;
+    }
+
+    alignas(kCacheLineSize) std::atomic<int64_t> top_{0};
+    alignas(kCacheLineSize) std::atomic<int64_t> bottom_{0};
+    std::atomic<Ring*> ring_{nullptr};
+    std::vector<std::unique_ptr<Ring>> retired_;  // every ring ever used, current one last; owner only
+};
+
+} // namespace MarketData
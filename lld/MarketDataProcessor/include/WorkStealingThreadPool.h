@@ -0,0 +1,337 @@
+#pragma once
+
+#include "BoundedQueue.h"
+#include "Instrumentation.h"
+#include "WorkStealingDeque.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace MarketData {
+
+// Thread pool with one Chase-Lev deque per worker. Tasks submitted from a
+// worker go onto that worker's deque and are popped LIFO by the same thread;
+// tasks from outside the pool go through a shared lock-free injection ring
+// that stores them by value. A worker with nothing local checks the injection
+// ring and then steals from the top of other workers' deques, starting at a
+// random victim. Idle workers park on a condition variable that submitters
+// only touch when someone is parked.
+class WorkStealingThreadPool {
+public:
+    // Tasks the injection ring holds before outside submitters wait
+    static constexpr size_t kInjectionCapacity = 1 << 16;
+
+    explicit WorkStealingThreadPool(size_t numThreads)
+        : injected_(kInjectionCapacity), stop_(false), startNs_(Instrumentation::nowNs()) {
+        size_t count = std::max<size_t>(1, numThreads);
+        workers_.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < count; ++i) {
+            workers_[i]->thread = std::thread([this, i] { run(i); });
+        }
+    }
+
+    ~WorkStealingThreadPool() {
+        stop();
+        for (auto& worker : workers_) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+        // Anything submitted after the workers left is dropped unrun; the
+        // injection ring destroys its own tasks
+        for (auto& worker : workers_) {
+            while (auto task = worker->deque.pop()) {
+                delete *task;
+            }
+        }
+    }
+
+    // Prevent copying
+    WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+    WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+    // Prevent moving
+    WorkStealingThreadPool(WorkStealingThreadPool&&) = delete;
+    WorkStealingThreadPool& operator=(WorkStealingThreadPool&&) = delete;
+
+    template<class F, class... Args>
+    auto submit(F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type> {
+        using return_type = typename std::invoke_result<F, Args...>::type;
+
+        auto task = std::make_shared<std::packaged_task<return_type()>>(
+            std::bind(std::forward<F>(f), std::forward<Args>(args)...)
+        );
+
+        std::future<return_type> res = task->get_future();
+        if (stop_ || !enqueue([task]() { (*task)(); })) {
+            throw std::runtime_error("submit on a stopped thread pool");
+        }
+        return res;
+    }
+
+    // Fire-and-forget; no packaged_task or future, and no allocation for small
+    // callables: outside submitters write the task into the injection ring and
+    // workers reuse task nodes from a per-thread cache
+    template<class F>
+    void post(F&& f) {
+        enqueue(std::forward<F>(f));
+    }
+
+    void stop() {
+        stop_ = true;
+        // Releases outside submitters waiting on a full injection ring
+        injected_.stop();
+        std::lock_guard<std::mutex> lock(parkMutex_);
+        parked_.notify_all();
+    }
+
+    size_t size() const { return workers_.size(); }
+
+    // Tasks waiting in the injection queue and all worker deques
+    size_t queueDepth() const {
+        size_t depth = injectedCount_.load(std::memory_order_relaxed);
+        for (const auto& worker : workers_) {
+            depth += worker->deque.size();
+        }
+        return depth;
+    }
+
+    // Busy fraction of each worker since the pool started; empty when
+    // instrumentation is compiled out
+    std::vector<double> utilization() const {
+        std::vector<double> result;
+#if MDP_INSTRUMENTATION
+        double elapsed = static_cast<double>(std::max<uint64_t>(1, Instrumentation::nowNs() - startNs_));
+        for (const auto& worker : workers_) {
+            result.push_back(worker->busyNs.load(std::memory_order_relaxed) / elapsed);
+        }
+#endif
+        return result;
+    }
+
+    // Time from submit/post until a worker starts the task
+    StageStats taskWait() const {
+#if MDP_INSTRUMENTATION
+        std::vector<const LatencyHistogram*> histograms;
+        for (const auto& worker : workers_) {
+            histograms.push_back(&worker->taskWait);
+        }
+        return LatencyHistogram::summarize(histograms);
+#else
+        return StageStats{};
+#endif
+    }
+
+private:
+    struct Task {
+        Task() = default;
+
+        template<class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+        explicit Task(F&& f) : run(std::forward<F>(f)) {}
+
+        void operator()() { run(); }
+
+        std::function<void()> run;
+#if MDP_INSTRUMENTATION
+        uint64_t enqueuedNs = Instrumentation::nowNs();
+#endif
+    };
+
+    // Idle rounds of stealing before a worker parks
+    static constexpr unsigned kStealRounds = 64;
+    // Spare task nodes each thread keeps for the worker-local path
+    static constexpr size_t kTaskCacheSize = 256;
+    static constexpr size_t kCacheLineSize = 64;
+
+    struct alignas(kCacheLineSize) Worker {
+        WorkStealingDeque<Task*> deque;
+        std::thread thread;
+#if MDP_INSTRUMENTATION
+        LatencyHistogram taskWait;           // written by this worker only
+        std::atomic<uint64_t> busyNs{0};
+#endif
+    };
+
+    // Deques hold pointers, so local tasks live in nodes. A node is returned
+    // to the cache of whichever thread took the task off a deque, which is
+    // always a worker, so in steady state workers stop allocating.
+    struct TaskCache {
+        std::vector<Task*> nodes;
+
+        ~TaskCache() {
+            for (Task* node : nodes) {
+                delete node;
+            }
+        }
+    };
+
+    // The pool and index of the worker running on this thread, if any
+    static inline thread_local WorkStealingThreadPool* currentPool_ = nullptr;
+    static inline thread_local size_t currentIndex_ = 0;
+    static inline thread_local TaskCache taskCache_;
+
+    template<class F>
+    static Task* makeNode(F&& f) {
+        auto& nodes = taskCache_.nodes;
+        if (nodes.empty()) {
+            return new Task(std::forward<F>(f));
+        }
+        Task* node = nodes.back();
+        nodes.pop_back();
+        *node = Task(std::forward<F>(f));
+        return node;
+    }
+
+    // Moves the task out and recycles its node
+    static Task takeNode(Task* node) {
+        Task task(std::move(*node));
+        node->run = nullptr;
+        auto& nodes = taskCache_.nodes;
+        if (nodes.size() < kTaskCacheSize) {
+            nodes.push_back(node);
+        } else {
+            delete node;
+        }
+        return task;
+    }
+
+    // False if the task was dropped because the pool stopped while the
+    // injection ring was full
+    template<class F>
+    bool enqueue(F&& f) {
+        if (currentPool_ == this) {
+            workers_[currentIndex_]->deque.push(makeNode(std::forward<F>(f)));
+        } else {
+            // Counted before the push so the count never dips below the queue size
+            injectedCount_.fetch_add(1, std::memory_order_relaxed);
+            if (!injected_.push(Task(std::forward<F>(f)))) {
+                // Stopped while full: dropped like any task left after stop
+                injectedCount_.fetch_sub(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        // Pairs with the fence in park(): either the parking worker sees the
+        // task in its final scan or we see it parked and wake it
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parkedCount_.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(parkMutex_);
+            ++wakeups_;
+            parked_.notify_one();
+        }
+        return true;
+    }
+
+    void run(size_t index) {
+        currentPool_ = this;
+        currentIndex_ = index;
+        std::minstd_rand rng(static_cast<unsigned>(index) * 7919u + 1);
+
+        unsigned idleRounds = 0;
+        while (true) {
+            if (auto task = findTask(index, rng)) {
+                execute(*workers_[index], *task);
+                idleRounds = 0;
+                continue;
+            }
+            if (stop_ && !hasWork()) {
+                break;
+            }
+            if (++idleRounds < kStealRounds) {
+                std::this_thread::yield();
+                continue;
+            }
+            park();
+            idleRounds = 0;
+        }
+    }
+
+    void execute(Worker& worker, Task& task) {
+#if MDP_INSTRUMENTATION
+        uint64_t start = Instrumentation::nowNs();
+        worker.taskWait.record(start - task.enqueuedNs);
+#else
+        (void)worker;
+#endif
+        task();
+#if MDP_INSTRUMENTATION
+        uint64_t busy = worker.busyNs.load(std::memory_order_relaxed) + (Instrumentation::nowNs() - start);
+        worker.busyNs.store(busy, std::memory_order_relaxed);
+#endif
+    }
+
+    std::optional<Task> findTask(size_t index, std::minstd_rand& rng) {
+        if (auto node = workers_[index]->deque.pop()) {
+            return takeNode(*node);
+        }
+        if (injectedCount_.load(std::memory_order_relaxed) > 0) {
+            if (auto task = injected_.try_pop()) {
+                injectedCount_.fetch_sub(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+        size_t count = workers_.size();
+        size_t start = rng() % count;
+        for (size_t i = 0; i < count; ++i) {
+            size_t victim = (start + i) % count;
+            if (victim == index) {
+                continue;
+            }
+            if (auto node = workers_[victim]->deque.steal()) {
+                return takeNode(*node);
+            }
+        }
+        return std::nullopt;
+    }
+
+    bool hasWork() const {
+        if (injectedCount_.load(std::memory_order_seq_cst) > 0) {
+            return true;
+        }
+        for (const auto& worker : workers_) {
+            if (!worker->deque.empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void park() {
+        std::unique_lock<std::mutex> lock(parkMutex_);
+        parkedCount_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t seen = wakeups_;
+        if (!hasWork() && !stop_) {
+            parked_.wait(lock, [this, seen] { return wakeups_ != seen || stop_; });
+        }
+        parkedCount_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    BoundedQueue<Task> injected_;
+    std::atomic<size_t> injectedCount_{0};
+    std::atomic<bool> stop_;
+
+    std::mutex parkMutex_;
+    std::condition_variable parked_;
+    std::atomic<int> parkedCount_{0};
+    uint64_t wakeups_ = 0;  // guarded by parkMutex_
+    const uint64_t startNs_;
+};
+
+} // namespace MarketData
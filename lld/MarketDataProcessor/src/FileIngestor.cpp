@@ -0,0 +1,333 @@
+#include "FileIngestor.h"
+#include "TickParser.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace MarketData {
+
+namespace {
+
+// Offset of the first line starting at or after pos
+size_t alignToLine(const char* data, size_t size, size_t pos) {
+    if (pos == 0 || pos >= size) {
+        return std::min(pos, size);
+    }
+    const void* newline = std::memchr(data + pos - 1, '\n', size - pos + 1);
+    return newline ? static_cast<size_t>(static_cast<const char*>(newline) - data) + 1 : size;
+}
+
+constexpr std::string_view kCsvHeader = "symbol,price,quantity,timestamp";
+
+// True if the first line is exactly the column header (optionally CRLF), so a
+// record for a symbol that merely starts with "symbol" is still parsed
+bool startsWithHeader(const char* data, size_t size) {
+    std::string_view firstLine(data, alignToLine(data, size, 1));
+    while (!firstLine.empty() && (firstLine.back() == '\n' || firstLine.back() == '\r')) {
+        firstLine.remove_suffix(1);
+    }
+    return firstLine == kCsvHeader;
+}
+
+} // namespace
+
+void writeTickFile(const std::string& path, const std::vector<std::string>& symbols, const std::vector<Tick>& ticks) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open tick file for writing: " + path);
+    }
+
+    std::string dictionary;
+    for (const auto& symbol : symbols) {
+        if (symbol.size() > UINT16_MAX) {
+            throw std::invalid_argument("Symbol name too long: " + symbol.substr(0, 32));
+        }
+        uint16_t length = static_cast<uint16_t>(symbol.size());
+        dictionary.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        dictionary.append(symbol);
+    }
+    dictionary.resize((dictionary.size() + 7) / 8 * 8, '\0');
+
+    TickFileHeader header{};
+    std::memcpy(header.magic, "MDTK", 4);
+    header.version = kTickFileVersion;
+    header.symbolCount = symbols.size();
+    header.tickCount = ticks.size();
+    header.dictionaryBytes = dictionary.size();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(dictionary.data(), static_cast<std::streamsize>(dictionary.size()));
+    file.write(reinterpret_cast<const char*>(ticks.data()), static_cast<std::streamsize>(ticks.size() * sizeof(Tick)));
+    if (!file) {
+        throw std::runtime_error("Failed to write tick file: " + path);
+    }
+}
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+
+    struct stat info{};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat file: " + path);
+    }
+
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ == 0) {
+        ::close(fd);
+        return;
+    }
+
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+    // Each parser walks its chunk front to back
+    ::madvise(mapping, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(mapping);
+}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+FileIngestor::FileIngestor(BatchSink sink, IngestOptions options)
+    : sink_(std::move(sink)), options_(options) {
+    if (options_.threads == 0) {
+        options_.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    options_.chunkBytes = std::max<size_t>(options_.chunkBytes, 4096);
+    options_.batchTicks = std::max<size_t>(options_.batchTicks, 1);
+}
+
+FileIngestor::FileIngestor(Processor& processor, IngestOptions options)
+    : FileIngestor([&processor, maxBacklog = options.maxBacklog](const Tick* ticks, size_t count) {
+          while (processor.pendingTicks() > maxBacklog) {
+              std::this_thread::yield();
+          }
+          processor.addBatch(ticks, count);
+      }, options) {
+}
+
+IngestResult FileIngestor::ingest(const std::string& path) {
+    {
+        MappedFile file(path);
+        if (file.size() >= sizeof(TickFileHeader) && std::memcmp(file.data(), "MDTK", 4) == 0) {
+            return ingestBinary(path);
+        }
+    }
+    return ingestCsv(path);
+}
+
+IngestResult FileIngestor::ingestCsv(const std::string& path) {
+    MappedFile file(path);
+    const char* data = file.data();
+    const size_t size = file.size();
+
+    size_t firstRecord = 0;
+    if (startsWithHeader(data, size)) {
+        firstRecord = alignToLine(data, size, 1);
+    }
+
+    size_t chunkBytes = options_.chunkBytes;
+    size_t numChunks = (size - firstRecord + chunkBytes - 1) / chunkBytes;
+
+    // Names are cached per parser thread as views into this mapping, so the
+    // global table is only consulted once per symbol per thread. The cache is
+    // reset for each file, since a later mapping may reuse the same addresses.
+    static std::atomic<uint64_t> fileGeneration{0};
+    const uint64_t generation = fileGeneration.fetch_add(1) + 1;
+
+    auto parse = [&](size_t chunk, std::vector<Tick>& ticks) -> uint64_t {
+        thread_local std::unordered_map<std::string_view, SymbolId> symbols;
+        thread_local uint64_t cachedGeneration = 0;
+        if (cachedGeneration != generation) {
+            symbols.clear();
+            cachedGeneration = generation;
+        }
+
+        const char* p = data + alignToLine(data, size, firstRecord + chunk * chunkBytes);
+        const char* end = data + alignToLine(data, size, std::min(size, firstRecord + (chunk + 1) * chunkBytes));
+        uint64_t malformed = 0;
+
+        while (p < end) {
+            const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+            const char* lineEnd = newline ? newline : end;
+
+            std::string_view name;
+            Tick tick{};
+            if (TickParser::parseCsvRecord(p, lineEnd, name, tick.price, tick.quantity, tick.timestamp)) {
+                auto it = symbols.find(name);
+                if (it == symbols.end()) {
+                    it = symbols.emplace(name, SymbolTable::global().intern(name)).first;
+                }
+                tick.symbol = it->second;
+                ticks.push_back(tick);
+            } else if (lineEnd != p && !(lineEnd - p == 1 && *p == '\r')) {
+                ++malformed;
+            }
+            p = lineEnd + 1;
+        }
+        return malformed;
+    };
+
+    IngestResult result = run(numChunks, parse);
+    result.bytes = size;
+    return result;
+}
+
+IngestResult FileIngestor::ingestBinary(const std::string& path) {
+    MappedFile file(path);
+    if (file.size() < sizeof(TickFileHeader)) {
+        throw std::runtime_error("Tick file is too small: " + path);
+    }
+
+    TickFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    size_t payload = file.size() - sizeof(TickFileHeader);
+    if (std::memcmp(header.magic, "MDTK", 4) != 0 || header.version != kTickFileVersion
+        || header.dictionaryBytes > payload || header.dictionaryBytes % 8 != 0
+        || header.tickCount > (payload - header.dictionaryBytes) / sizeof(Tick)) {
+        throw std::runtime_error("Invalid tick file: " + path);
+    }
+
+    // File-local symbol index -> global id
+    std::vector<SymbolId> ids;
+    ids.reserve(static_cast<size_t>(header.symbolCount));
+    const char* p = file.data() + sizeof(TickFileHeader);
+    const char* dictionaryEnd = p + header.dictionaryBytes;
+    for (uint64_t i = 0; i < header.symbolCount; ++i) {
+        uint16_t length;
+        if (dictionaryEnd - p < static_cast<ptrdiff_t>(sizeof(length))) {
+            throw std::runtime_error("Truncated symbol dictionary: " + path);
+        }
+        std::memcpy(&length, p, sizeof(length));
+        p += sizeof(length);
+        if (dictionaryEnd - p < length) {
+            throw std::runtime_error("Truncated symbol dictionary: " + path);
+        }
+        ids.push_back(SymbolTable::global().intern(std::string_view(p, length)));
+        p += length;
+    }
+
+    const char* records = dictionaryEnd;
+    const size_t tickCount = static_cast<size_t>(header.tickCount);
+    const size_t ticksPerChunk = std::max<size_t>(1, options_.chunkBytes / sizeof(Tick));
+    size_t numChunks = (tickCount + ticksPerChunk - 1) / ticksPerChunk;
+
+    auto parse = [&](size_t chunk, std::vector<Tick>& ticks) -> uint64_t {
+        size_t begin = chunk * ticksPerChunk;
+        size_t end = std::min(tickCount, begin + ticksPerChunk);
+        uint64_t malformed = 0;
+        for (size_t i = begin; i < end; ++i) {
+            Tick tick;
+            std::memcpy(&tick, records + i * sizeof(Tick), sizeof(Tick));
+            if (tick.symbol >= ids.size()) {
+                ++malformed;
+                continue;
+            }
+            tick.symbol = ids[tick.symbol];
+            ticks.push_back(tick);
+        }
+        return malformed;
+    };
+
+    IngestResult result = run(numChunks, parse);
+    result.bytes = file.size();
+    return result;
+}
+
+IngestResult FileIngestor::run(size_t numChunks, const ChunkParser& parse) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::atomic<size_t> nextChunk{0};
+    std::atomic<uint64_t> ticks{0};
+    std::atomic<uint64_t> malformed{0};
+
+    // Chunks reach the sink strictly in file order
+    std::mutex turnMutex;
+    std::condition_variable turnChanged;
+    size_t turn = 0;
+    std::exception_ptr failure;
+
+    auto worker = [&] {
+        std::vector<Tick> parsed;
+        while (true) {
+            size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= numChunks) {
+                return;
+            }
+
+            parsed.clear();
+            std::exception_ptr error;
+            try {
+                malformed.fetch_add(parse(chunk, parsed), std::memory_order_relaxed);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            std::unique_lock<std::mutex> lock(turnMutex);
+            turnChanged.wait(lock, [&] { return turn == chunk; });
+            if (error && !failure) {
+                failure = error;
+            }
+            if (!failure) {
+                lock.unlock();
+                try {
+                    for (size_t i = 0; i < parsed.size(); i += options_.batchTicks) {
+                        sink_(parsed.data() + i, std::min(options_.batchTicks, parsed.size() - i));
+                    }
+                    ticks.fetch_add(parsed.size(), std::memory_order_relaxed);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                lock.lock();
+                if (error && !failure) {
+                    failure = error;
+                }
+            }
+            ++turn;
+            turnChanged.notify_all();
+        }
+    };
+
+    size_t numThreads = std::min(options_.threads, std::max<size_t>(1, numChunks));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < numThreads; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+    IngestResult result;
+    result.ticks = ticks.load();
+    result.malformed = malformed.load();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace MarketData
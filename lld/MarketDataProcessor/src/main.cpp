@@ -1,15 +1,43 @@
+#include "FileIngestor.h"
 #include "Processor.h"
 #include <iostream>
 #include <thread>
 #include <chrono>
 
-int main() {
+int main(int argc, char** argv) {
     // Create a processor with 4 worker threads
     MarketData::Processor processor(4);
     
     // Start processing
     processor.start();
     
+    if (argc > 1) {
+        // Backfill from CSV or binary tick files
+        MarketData::FileIngestor ingestor(processor);
+        for (int i = 1; i < argc; ++i) {
+            try {
+                MarketData::IngestResult result = ingestor.ingest(argv[i]);
+                std::cout << argv[i] << ": " << result.ticks << " ticks, " << result.malformed
+                          << " malformed, " << result.gigabytesPerSecond() << " GB/s" << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << argv[i] << ": " << e.what() << std::endl;
+                return 1;
+            }
+        }
+        processor.waitIdle();
+
+        auto& symbols = MarketData::SymbolTable::global();
+        for (MarketData::SymbolId id = 0; id < symbols.size(); ++id) {
+            auto snapshot = processor.getSnapshot(id);
+            if (snapshot) {
+                std::cout << symbols.name(id) << " last " << MarketData::toDoublePrice(snapshot->lastPrice)
+                          << " volume " << snapshot->totalVolume << " vwap " << snapshot->vwap() << std::endl;
+            }
+        }
+        processor.stop();
+        return 0;
+    }
+
     // Add some test data
     processor.addData(MarketData::MarketData("AAPL", 150.0, 100));
     processor.addData(MarketData::MarketData("GOOGL", 2800.0, 50));
@@ -28,4 +56,4 @@ int main() {
     processor.stop();
     
     return 0;
-} 
\ No newline at end of file
+} 
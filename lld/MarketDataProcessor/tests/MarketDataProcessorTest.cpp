@@ -1,9 +1,18 @@
 #include <gtest/gtest.h>
 #include "Processor.h"
+#include "BoundedQueue.h"
+#include "FileIngestor.h"
+#include "TickParser.h"
 #include <thread>
 #include <chrono>
 #include <vector>
 #include <future>
+#include <atomic>
+#include <string>
+#include <random>
+#include <cstdio>
+#include <fstream>
+#include <limits>
 
 class MarketDataProcessorTest : public ::testing::Test {
 protected:
@@ -22,7 +31,7 @@ protected:
 // Test basic data addition and retrieval
 TEST_F(MarketDataProcessorTest, BasicDataAddition) {
     processor->addData(MarketData::MarketData("AAPL", 150.0, 100));
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    processor->waitIdle();
     
     EXPECT_DOUBLE_EQ(processor->getLastPrice("AAPL"), 150.0);
     EXPECT_EQ(processor->getTotalVolume("AAPL"), 100);
@@ -32,7 +41,7 @@ TEST_F(MarketDataProcessorTest, BasicDataAddition) {
 TEST_F(MarketDataProcessorTest, MultipleUpdates) {
     processor->addData(MarketData::MarketData("AAPL", 150.0, 100));
     processor->addData(MarketData::MarketData("AAPL", 151.0, 200));
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    processor->waitIdle();
     
     EXPECT_DOUBLE_EQ(processor->getLastPrice("AAPL"), 151.0);
     EXPECT_EQ(processor->getTotalVolume("AAPL"), 300);
@@ -50,8 +59,8 @@ TEST_F(MarketDataProcessorTest, MultipleSymbols) {
     processor->addData(MarketData::MarketData("GOOGL", 2800.0, 50));
     processor->addData(MarketData::MarketData("MSFT", 300.0, 75));
     
-    // Give some time for processing
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // Wait until every tick has been applied
+    processor->waitIdle();
     
     // Verify results
     EXPECT_DOUBLE_EQ(processor->getLastPrice("AAPL"), 150.0);
@@ -82,8 +91,8 @@ TEST_F(MarketDataProcessorTest, ConcurrentProcessing) {
         future.wait();
     }
     
-    // Give some time for final processing
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // Wait for the shards to apply everything
+    processor->waitIdle();
     
     // Verify total volume
     EXPECT_EQ(processor->getTotalVolume("AAPL"), numThreads * updatesPerThread * 100);
@@ -92,7 +101,7 @@ TEST_F(MarketDataProcessorTest, ConcurrentProcessing) {
 TEST_F(MarketDataProcessorTest, StopAndStart) {
     // Add initial data
     processor->addData(MarketData::MarketData("AAPL", 150.0, 100));
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    processor->waitIdle();
     EXPECT_DOUBLE_EQ(processor->getLastPrice("AAPL"), 150.0);
     EXPECT_EQ(processor->getTotalVolume("AAPL"), 100);
     
@@ -104,13 +113,726 @@ TEST_F(MarketDataProcessorTest, StopAndStart) {
     
     // Start processing again
     processor->start();
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    processor->waitIdle();
     
     // Verify state is unchanged
     EXPECT_DOUBLE_EQ(processor->getLastPrice("AAPL"), 150.0);
     EXPECT_EQ(processor->getTotalVolume("AAPL"), 100);
 }
 
+TEST_F(MarketDataProcessorTest, PerSymbolOrderingAcrossShards) {
+    // Prices increase monotonically per symbol; the last applied tick must be
+    // the last one sent even though symbols are spread over several shards
+    auto wide = std::make_unique<MarketData::Processor>(4);
+    wide->start();
+    const int ticksPerSymbol = 2000;
+    const std::vector<std::string> symbols{"AAPL", "GOOGL", "MSFT", "AMZN", "TSLA", "META"};
+
+    for (int i = 1; i <= ticksPerSymbol; ++i) {
+        for (const auto& symbol : symbols) {
+            wide->addData(MarketData::MarketData(symbol, static_cast<double>(i), 1));
+        }
+    }
+    wide->waitIdle();
+
+    for (const auto& symbol : symbols) {
+        EXPECT_DOUBLE_EQ(wide->getLastPrice(symbol), static_cast<double>(ticksPerSymbol));
+        EXPECT_EQ(wide->getTotalVolume(symbol), ticksPerSymbol);
+    }
+    wide->stop();
+}
+
+TEST_F(MarketDataProcessorTest, ReadersDuringUpdates) {
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        int i = 0;
+        while (!done) {
+            // Lookups race with inserts of new symbols and must stay safe
+            processor->getTotalVolume("SYM" + std::to_string(i++ % 500));
+        }
+    });
+
+    for (int i = 0; i < 500; ++i) {
+        processor->addData(MarketData::MarketData("SYM" + std::to_string(i), 1.0, 1));
+    }
+    processor->waitIdle();
+    done = true;
+    reader.join();
+
+    for (int i = 0; i < 500; ++i) {
+        EXPECT_EQ(processor->getTotalVolume("SYM" + std::to_string(i)), 1);
+    }
+}
+
+// Test that a batch spread over many shards keeps per-symbol order
+TEST_F(MarketDataProcessorTest, AddBatchAcrossShards) {
+    auto wide = std::make_unique<MarketData::Processor>(4);
+    wide->start();
+
+    auto& symbols = MarketData::SymbolTable::global();
+    std::vector<MarketData::Tick> batch;
+    for (int i = 1; i <= 500; ++i) {
+        for (int s = 0; s < 8; ++s) {
+            batch.push_back({symbols.intern("SYM" + std::to_string(s)), 2, MarketData::toFixedPrice(i),
+                             static_cast<uint64_t>(i)});
+        }
+    }
+    wide->addBatch(batch.data(), batch.size() / 2);
+    wide->addBatch(batch.data() + batch.size() / 2, batch.size() - batch.size() / 2);
+    wide->waitIdle();
+
+    for (int s = 0; s < 8; ++s) {
+        std::string symbol = "SYM" + std::to_string(s);
+        EXPECT_DOUBLE_EQ(wide->getLastPrice(symbol), 500.0);
+        EXPECT_EQ(wide->getTotalVolume(symbol), 1000);
+    }
+    wide->stop();
+}
+
+// Test that producers outrunning a shard's ring wait for it to drain
+// instead of losing ticks or reordering a symbol
+TEST_F(MarketDataProcessorTest, BatchesLargerThanShardRing) {
+    auto& symbols = MarketData::SymbolTable::global();
+    const int producers = 3;
+    const int ticksPerProducer = static_cast<int>(MarketData::Processor::kShardCapacity) * 2 + 7;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([this, &symbols, p, ticksPerProducer] {
+            MarketData::SymbolId id = symbols.intern("RING" + std::to_string(p));
+            std::vector<MarketData::Tick> batch;
+            for (int i = 1; i <= ticksPerProducer; ++i) {
+                batch.push_back({id, 1, MarketData::toFixedPrice(i), static_cast<uint64_t>(i)});
+            }
+            processor->addBatch(batch);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    processor->waitIdle();
+
+    for (int p = 0; p < producers; ++p) {
+        std::string symbol = "RING" + std::to_string(p);
+        EXPECT_DOUBLE_EQ(processor->getLastPrice(symbol), static_cast<double>(ticksPerProducer));
+        EXPECT_EQ(processor->getTotalVolume(symbol), ticksPerProducer);
+    }
+    EXPECT_EQ(processor->backlog(), 0u);
+    EXPECT_EQ(processor->pendingTicks(), 0u);
+}
+
+// Test that batches are ignored while stopped, like single ticks
+TEST_F(MarketDataProcessorTest, AddBatchWhileStopped) {
+    processor->stop();
+    auto& symbols = MarketData::SymbolTable::global();
+    std::vector<MarketData::Tick> batch{{symbols.intern("AAPL"), 100, MarketData::toFixedPrice(150.0), 1},
+                                        {symbols.intern("MSFT"), 50, MarketData::toFixedPrice(300.0), 2}};
+    processor->addBatch(batch);
+    processor->waitIdle();
+    EXPECT_EQ(processor->pendingTicks(), 0u);
+
+    EXPECT_EQ(processor->getTotalVolume("AAPL"), 0);
+    EXPECT_EQ(processor->getTotalVolume("MSFT"), 0);
+}
+
+// Test that ticks carry the caller's timestamp and fixed-point price through to the stats
+TEST_F(MarketDataProcessorTest, TickFieldsReachStats) {
+    MarketData::SymbolId ibm = MarketData::SymbolTable::global().intern("IBM");
+    processor->addData(MarketData::Tick{ibm, 25, MarketData::toFixedPrice(123.4567), 987654321});
+    processor->waitIdle();
+
+    const MarketData::MarketDataStats* stats = processor->getStats(ibm);
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->getLastPriceFixed(), 1234567);
+    EXPECT_DOUBLE_EQ(processor->getLastPrice(ibm), 123.4567);
+    EXPECT_EQ(stats->getTotalVolume(), 25);
+    EXPECT_EQ(stats->getLastUpdate(), 987654321u);
+}
+
+TEST(MarketDataStatsTest, BarsAndVwap) {
+    MarketData::AnalyticsConfig config;
+    config.barInterval = 1000;
+    MarketData::MarketDataStats stats(config);
+    auto tick = [](double price, int quantity, uint64_t timestamp) {
+        return MarketData::Tick{0, quantity, MarketData::toFixedPrice(price), timestamp};
+    };
+
+    stats.update(tick(10.0, 100, 100));
+    stats.update(tick(12.0, 100, 400));
+    stats.update(tick(9.0, 200, 900));
+    stats.update(tick(11.0, 100, 1500));  // opens the second bar
+
+    MarketData::StatsSnapshot snap = stats.snapshot();
+    EXPECT_EQ(snap.tickCount, 4u);
+    EXPECT_EQ(snap.totalVolume, 500);
+    EXPECT_DOUBLE_EQ(snap.vwap(), (1000.0 + 1200.0 + 1800.0 + 1100.0) / 500);
+
+    EXPECT_EQ(snap.barsCompleted, 1u);
+    EXPECT_EQ(snap.lastBar.start, 0u);
+    EXPECT_EQ(snap.lastBar.open, MarketData::toFixedPrice(10.0));
+    EXPECT_EQ(snap.lastBar.high, MarketData::toFixedPrice(12.0));
+    EXPECT_EQ(snap.lastBar.low, MarketData::toFixedPrice(9.0));
+    EXPECT_EQ(snap.lastBar.close, MarketData::toFixedPrice(9.0));
+    EXPECT_EQ(snap.lastBar.volume, 400);
+    EXPECT_DOUBLE_EQ(snap.lastBar.vwap(), 4000.0 / 400);
+
+    EXPECT_EQ(snap.currentBar.start, 1000u);
+    EXPECT_EQ(snap.currentBar.open, MarketData::toFixedPrice(11.0));
+    EXPECT_EQ(snap.currentBar.volume, 100);
+}
+
+TEST(MarketDataStatsTest, VolatilityTickRateAndQuantiles) {
+    MarketData::MarketDataStats stats;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> size(1, 100);
+    for (int i = 0; i < 2000; ++i) {
+        // Constant price, one tick per millisecond, uniform sizes 1..100
+        stats.update(MarketData::Tick{0, size(rng), MarketData::toFixedPrice(50.0),
+                                      static_cast<uint64_t>(i) * 1'000'000});
+    }
+    MarketData::StatsSnapshot snap = stats.snapshot();
+    EXPECT_DOUBLE_EQ(snap.volatility(), 0.0);
+    EXPECT_NEAR(snap.tickRate, 1000.0, 1e-6);
+    EXPECT_NEAR(snap.sizeP50, 50.0, 10.0);
+    EXPECT_NEAR(snap.sizeP90, 90.0, 10.0);
+    EXPECT_GT(snap.sizeP99, snap.sizeP90);
+
+    stats.update(MarketData::Tick{0, 10, MarketData::toFixedPrice(55.0), 2000 * 1'000'000ull});
+    stats.flush();
+    EXPECT_GT(stats.snapshot().volatility(), 0.0);
+}
+
+// Test that the hot line is published per tick and the cold analytics catch
+// up on their own schedule or on flush; a snapshot waits for the cold side
+TEST(MarketDataStatsTest, ColdFieldsPublishedOnFlush) {
+    MarketData::MarketDataStats stats;
+    stats.update(MarketData::Tick{0, 5, MarketData::toFixedPrice(10.0), 1});
+    stats.update(MarketData::Tick{0, 7, MarketData::toFixedPrice(11.0), 2});
+
+    EXPECT_EQ(stats.getLastPriceFixed(), MarketData::toFixedPrice(11.0));
+    EXPECT_EQ(stats.getTotalVolume(), 12);
+    MarketData::StatsSnapshot snap = stats.snapshot();
+    EXPECT_EQ(snap.tickCount, 0u);
+    EXPECT_EQ(snap.currentBar.volume, 0);
+    EXPECT_TRUE(stats.hasUnflushed());
+
+    stats.flush();
+    snap = stats.snapshot();
+    EXPECT_FALSE(stats.hasUnflushed());
+    EXPECT_EQ(snap.tickCount, 2u);
+    EXPECT_EQ(snap.lastPrice, MarketData::toFixedPrice(11.0));
+    EXPECT_EQ(snap.currentBar.volume, 12);
+    EXPECT_EQ(snap.currentBar.high, MarketData::toFixedPrice(11.0));
+
+    for (uint64_t i = 0; i < MarketData::MarketDataStats::kColdPublishTicks; ++i) {
+        stats.update(MarketData::Tick{0, 1, MarketData::toFixedPrice(11.0), 3 + i});
+    }
+    EXPECT_FALSE(stats.hasUnflushed());
+    EXPECT_EQ(stats.snapshot().currentBar.volume, 12 + static_cast<int64_t>(MarketData::MarketDataStats::kColdPublishTicks));
+}
+
+TEST(MarketDataStatsTest, SnapshotIsConsistentUnderWrites) {
+    MarketData::MarketDataStats stats;
+    std::atomic<bool> done{false};
+    std::thread writer([&stats, &done] {
+        for (uint64_t i = 1; i <= 200000; ++i) {
+            stats.update(MarketData::Tick{0, 3, static_cast<int64_t>(i), i});
+        }
+        done = true;
+    });
+
+    bool consistent = true;
+    while (!done) {
+        MarketData::StatsSnapshot snap = stats.snapshot();
+        consistent &= snap.totalVolume == static_cast<int64_t>(snap.tickCount) * 3;
+        consistent &= snap.lastPrice == static_cast<int64_t>(snap.tickCount);
+        consistent &= snap.lastUpdate == snap.tickCount;
+    }
+    writer.join();
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(stats.getTotalVolume(), 600000);
+}
+
+// Test that hot and cold fields in one snapshot describe the same tick while
+// the writer keeps going. With one long bar, the bar must account for every
+// tick the hot fields have seen.
+TEST(MarketDataStatsTest, SnapshotFieldsAgreeUnderWrites) {
+    MarketData::AnalyticsConfig config;
+    config.barInterval = std::numeric_limits<uint64_t>::max();
+    MarketData::MarketDataStats stats(config);
+    std::atomic<bool> done{false};
+    std::thread writer([&stats, &done] {
+        std::mt19937 rng(11);
+        std::uniform_int_distribution<int64_t> price(90, 110);
+        std::uniform_int_distribution<int32_t> size(1, 50);
+        for (uint64_t i = 1; i <= 200000; ++i) {
+            stats.update(MarketData::Tick{0, size(rng), MarketData::toFixedPrice(static_cast<double>(price(rng))), i});
+            if (i % 100 == 0) {
+                stats.flush();
+            }
+        }
+        done = true;
+    });
+
+    uint64_t reads = 0;
+    bool consistent = true;
+    while (!done) {
+        MarketData::StatsSnapshot snap = stats.snapshot();
+        ++reads;
+        if (snap.tickCount == 0) {
+            continue;
+        }
+        double low = MarketData::toDoublePrice(snap.currentBar.low);
+        double high = MarketData::toDoublePrice(snap.currentBar.high);
+        consistent &= snap.currentBar.volume == snap.totalVolume;
+        consistent &= snap.currentBar.close == snap.lastPrice;
+        consistent &= snap.lastPrice >= snap.currentBar.low && snap.lastPrice <= snap.currentBar.high;
+        consistent &= snap.vwap() >= low - 1e-9 && snap.vwap() <= high + 1e-9;
+    }
+    writer.join();
+    EXPECT_GT(reads, 0u);
+    EXPECT_TRUE(consistent);
+}
+
+TEST(TickParserTest, ParsesNumbers) {
+    auto price = [](const std::string& text) {
+        const char* p = text.data();
+        int64_t value = 0;
+        EXPECT_TRUE(MarketData::TickParser::parsePrice(p, text.data() + text.size(), value)) << text;
+        return value;
+    };
+    EXPECT_EQ(price("150"), 1500000);
+    EXPECT_EQ(price("123.45"), 1234500);
+    EXPECT_EQ(price("0.00015"), 1);
+    EXPECT_EQ(price("-2.5"), -25000);
+    EXPECT_EQ(price("12345678901.0001"), 123456789010001);
+
+    std::string digits = "12345678901234567890";
+    const char* p = digits.data();
+    uint64_t value = 0;
+    EXPECT_TRUE(MarketData::TickParser::parseUnsigned(p, p + 19, value));
+    EXPECT_EQ(value, 1234567890123456789ull);
+    p = digits.data();
+    EXPECT_FALSE(MarketData::TickParser::parseUnsigned(p, p + digits.size(), value));
+}
+
+TEST(TickParserTest, ParsesCsvRecords) {
+    std::string_view symbol;
+    int64_t price;
+    int32_t quantity;
+    uint64_t timestamp;
+    auto parse = [&](std::string_view line) {
+        return MarketData::TickParser::parseCsvRecord(line.data(), line.data() + line.size(), symbol, price,
+                                                      quantity, timestamp);
+    };
+
+    ASSERT_TRUE(parse("AAPL,150.25,300,1700000000123456789\r"));
+    EXPECT_EQ(symbol, "AAPL");
+    EXPECT_EQ(price, 1502500);
+    EXPECT_EQ(quantity, 300);
+    EXPECT_EQ(timestamp, 1700000000123456789ull);
+
+    EXPECT_FALSE(parse(",1,1,1"));
+    EXPECT_FALSE(parse("AAPL,abc,1,1"));
+    EXPECT_FALSE(parse("AAPL,1,1"));
+    EXPECT_FALSE(parse("AAPL,1,1,1,extra"));
+    EXPECT_FALSE(parse("AAPL,1,99999999999,1"));
+}
+
+TEST(FileIngestorTest, CsvChunksKeepFileOrder) {
+    std::string path = "ingest_test.csv";
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << "symbol,price,quantity,timestamp\n";
+        for (int i = 1; i <= 20000; ++i) {
+            out << "ING" << i % 7 << "," << i << ".5," << 1 << "," << i << "\n";
+        }
+        out << "garbage line\n\n";
+    }
+
+    MarketData::Processor processor(3);
+    processor.start();
+    MarketData::IngestOptions options;
+    options.threads = 4;
+    options.chunkBytes = 4096;  // many chunks, most boundaries mid-line
+    options.batchTicks = 100;
+    MarketData::IngestResult result = MarketData::FileIngestor(processor, options).ingest(path);
+    processor.waitIdle();
+    std::remove(path.c_str());
+
+    EXPECT_EQ(result.ticks, 20000u);
+    EXPECT_EQ(result.malformed, 1u);
+    for (int s = 0; s < 7; ++s) {
+        auto snapshot = processor.getSnapshot("ING" + std::to_string(s));
+        ASSERT_TRUE(snapshot.has_value());
+        int last = 20000 - (20000 - s) % 7;
+        EXPECT_EQ(snapshot->lastPrice, MarketData::toFixedPrice(last + 0.5)) << s;
+        EXPECT_EQ(snapshot->lastUpdate, static_cast<uint64_t>(last));
+    }
+}
+
+TEST(FileIngestorTest, BinaryRoundTrip) {
+    std::string path = "ingest_test.bin";
+    std::vector<std::string> names{"BINA", "BINB"};
+    std::vector<MarketData::Tick> ticks;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        ticks.push_back(MarketData::Tick{i % 2, 2, static_cast<int64_t>(i + 1), i});
+    }
+    ticks.push_back(MarketData::Tick{9, 1, 1, 1});  // unknown symbol index
+    MarketData::writeTickFile(path, names, ticks);
+
+    std::vector<MarketData::Tick> received;
+    MarketData::IngestOptions options;
+    options.threads = 3;
+    options.chunkBytes = 4096;
+    MarketData::FileIngestor ingestor(
+        [&received](const MarketData::Tick* batch, size_t count) { received.insert(received.end(), batch, batch + count); },
+        options);
+    MarketData::IngestResult result = ingestor.ingest(path);
+    std::remove(path.c_str());
+
+    EXPECT_EQ(result.ticks, 10000u);
+    EXPECT_EQ(result.malformed, 1u);
+    ASSERT_EQ(received.size(), 10000u);
+    auto& symbols = MarketData::SymbolTable::global();
+    for (uint32_t i = 0; i < 10000; ++i) {
+        EXPECT_EQ(symbols.name(received[i].symbol), names[i % 2]);
+        EXPECT_EQ(received[i].price, static_cast<int64_t>(i + 1));
+    }
+}
+
+// Test that only the exact header line is skipped, so a first record for a
+// ticker beginning with "symbol" is kept
+TEST(FileIngestorTest, CsvHeaderMatchesWholeLine) {
+    auto ingestFile = [](const std::string& contents) {
+        std::string path = "ingest_header_test.csv";
+        {
+            std::ofstream out(path, std::ios::trunc | std::ios::binary);
+            out << contents;
+        }
+        std::vector<MarketData::Tick> received;
+        MarketData::FileIngestor ingestor(
+            [&received](const MarketData::Tick* batch, size_t count) { received.insert(received.end(), batch, batch + count); });
+        MarketData::IngestResult result = ingestor.ingest(path);
+        std::remove(path.c_str());
+        EXPECT_EQ(result.ticks, received.size());
+        return received;
+    };
+
+    auto& symbols = MarketData::SymbolTable::global();
+    auto records = ingestFile("SYMBOLIC,1.5,10,1\nsymbolics,2.5,20,2\n");
+    EXPECT_EQ(records.size(), 2u);
+    records = ingestFile("symbolics,2.5,20,2\nSYMBOLIC,1.5,10,1\n");
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(symbols.name(records[0].symbol), "symbolics");
+
+    records = ingestFile("symbol,price,quantity,timestamp\r\nSYMBOLIC,1.5,10,1\r\n");
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(symbols.name(records[0].symbol), "SYMBOLIC");
+}
+
+TEST(FileIngestorTest, MissingFileThrows) {
+    MarketData::FileIngestor ingestor([](const MarketData::Tick*, size_t) {});
+    EXPECT_THROW(ingestor.ingest("does_not_exist.csv"), std::runtime_error);
+}
+
+TEST(SymbolTableTest, InternAssignsDenseStableIds) {
+    MarketData::SymbolTable table(16);
+    EXPECT_EQ(table.intern("AAPL"), 0u);
+    EXPECT_EQ(table.intern("MSFT"), 1u);
+    EXPECT_EQ(table.intern("AAPL"), 0u);
+    EXPECT_EQ(table.find("MSFT"), 1u);
+    EXPECT_EQ(table.find("GOOG"), MarketData::kInvalidSymbol);
+    EXPECT_EQ(table.name(1), "MSFT");
+    EXPECT_EQ(table.size(), 2u);
+    EXPECT_THROW(table.name(7), std::out_of_range);
+}
+
+TEST(SymbolTableTest, RejectsSymbolsBeyondCapacity) {
+    MarketData::SymbolTable table(2);
+    table.intern("A");
+    table.intern("B");
+    EXPECT_THROW(table.intern("C"), std::runtime_error);
+    EXPECT_EQ(table.intern("A"), 0u);
+}
+
+TEST(SymbolTableTest, ConcurrentInternAgrees) {
+    MarketData::SymbolTable table(4096);
+    const int numThreads = 4;
+    const int numSymbols = 1000;
+    std::vector<std::vector<MarketData::SymbolId>> seen(numThreads);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&table, &seen, t, numSymbols] {
+            for (int i = 0; i < numSymbols; ++i) {
+                seen[t].push_back(table.intern("S" + std::to_string(i)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(table.size(), static_cast<size_t>(numSymbols));
+    for (int t = 1; t < numThreads; ++t) {
+        EXPECT_EQ(seen[t], seen[0]);
+    }
+    for (int i = 0; i < numSymbols; ++i) {
+        EXPECT_EQ(table.name(seen[0][i]), "S" + std::to_string(i));
+    }
+}
+
+TEST(InstrumentationTest, HistogramPercentilesWithinOnePercent) {
+    MarketData::LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 100000; ++value) {
+        histogram.record(value);
+    }
+    MarketData::StageStats stats = histogram.summary();
+    EXPECT_EQ(stats.count, 100000u);
+    EXPECT_EQ(stats.max, 100000u);
+    EXPECT_NEAR(stats.mean, 50000.5, 1e-6);
+    EXPECT_NEAR(static_cast<double>(stats.p50), 50000.0, 500.0);
+    EXPECT_NEAR(static_cast<double>(stats.p99), 99000.0, 990.0);
+
+    for (uint64_t value : {0ull, 255ull, 256ull, 1000ull, 123456789ull, ~0ull}) {
+        size_t bucket = MarketData::LatencyHistogram::bucketFor(value);
+        EXPECT_LT(bucket, MarketData::LatencyHistogram::kBucketCount);
+        EXPECT_GE(MarketData::LatencyHistogram::bucketUpperBound(bucket), value);
+    }
+}
+
+TEST_F(MarketDataProcessorTest, InstrumentationSnapshot) {
+    auto id = MarketData::SymbolTable::global().intern("INSTR");
+    std::vector<MarketData::Tick> batch(5000, MarketData::Tick{id, 1, 10000, 1});
+    processor->addBatch(batch);
+    processor->waitIdle();
+
+    MarketData::InstrumentationSnapshot snapshot = processor->instrumentation();
+    EXPECT_EQ(snapshot.enabled, MarketData::kInstrumentationEnabled);
+    EXPECT_EQ(snapshot.shardDepth.size(), processor->shardCount());
+    if (MarketData::kInstrumentationEnabled) {
+        EXPECT_GE(snapshot.sliceSize.count, 1u);
+        EXPECT_GE(snapshot.sliceQueueWait.count, 1u);
+        EXPECT_GE(snapshot.taskWait.count, 1u);
+        EXPECT_EQ(snapshot.workerUtilization.size(), 2u);
+        EXPECT_GE(snapshot.sliceSize.max, 1u);
+    } else {
+        EXPECT_EQ(snapshot.sliceQueueWait.count, 0u);
+        EXPECT_TRUE(snapshot.workerUtilization.empty());
+    }
+}
+
+TEST_F(MarketDataProcessorTest, PeriodicMetricsDump) {
+    std::string path = "metrics_test.jsonl";
+    std::remove(path.c_str());
+    processor->startMetricsDump(path, std::chrono::milliseconds(10));
+    processor->addData(MarketData::MarketData("DUMP", 1.0, 1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    processor->stopMetricsDump();
+
+    std::ifstream in(path);
+    std::string line;
+    int lines = 0;
+    while (std::getline(in, line)) {
+        EXPECT_EQ(line.front(), '{');
+        EXPECT_NE(line.find("\"sliceQueueWaitNs\""), std::string::npos);
+        ++lines;
+    }
+    EXPECT_GE(lines, 2);
+    std::remove(path.c_str());
+}
+
+TEST(ThreadPoolTest, PostRunsFireAndForgetTasks) {
+    std::atomic<int> executed{0};
+    {
+        MarketData::ThreadPool pool(2);
+        for (int i = 0; i < 1000; ++i) {
+            pool.post([&executed] { ++executed; });
+        }
+    }
+    EXPECT_EQ(executed.load(), 1000);
+}
+
+TEST(ThreadPoolTest, NestedSubmitFromWorker) {
+    std::atomic<int> leaves{0};
+    std::promise<void> allLeaves;
+    std::function<void(int)> fanOut;
+    // Declared after fanOut so workers are joined before it is destroyed
+    MarketData::ThreadPool pool(4);
+    fanOut = [&](int depth) {
+        if (depth == 0) {
+            if (++leaves == 1024) {
+                allLeaves.set_value();
+            }
+            return;
+        }
+        pool.post([&fanOut, depth] { fanOut(depth - 1); });
+        pool.post([&fanOut, depth] { fanOut(depth - 1); });
+    };
+    auto root = pool.submit([&fanOut] { fanOut(10); return 42; });
+    EXPECT_EQ(root.get(), 42);
+
+    EXPECT_EQ(allLeaves.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(leaves.load(), 1024);
+}
+
+TEST(ThreadPoolTest, StopRunsQueuedTasks) {
+    std::atomic<int> executed{0};
+    std::vector<std::future<int>> results;
+    {
+        MarketData::ThreadPool pool(3);
+        for (int i = 0; i < 200; ++i) {
+            results.push_back(pool.submit([&executed, i] { ++executed; return i; }));
+        }
+        pool.stop();
+    }
+    EXPECT_EQ(executed.load(), 200);
+    for (int i = 0; i < 200; ++i) {
+        EXPECT_EQ(results[i].get(), i);
+    }
+}
+
+// Test that submitting to a stopped pool fails up front instead of leaving a
+// future that never becomes ready
+TEST(ThreadPoolTest, SubmitAfterStopThrows) {
+    MarketData::SharedQueueThreadPool shared(2);
+    shared.stop();
+    EXPECT_THROW(shared.submit([] { return 1; }), std::runtime_error);
+
+    MarketData::BoundedThreadPool bounded(2);
+    bounded.stop();
+    EXPECT_THROW(bounded.submit([] { return 1; }), std::runtime_error);
+
+    MarketData::WorkStealingThreadPool stealing(2);
+    stealing.stop();
+    EXPECT_THROW(stealing.submit([] { return 1; }), std::runtime_error);
+}
+
+TEST(BoundedQueueTest, FifoWithinCapacity) {
+    MarketData::BoundedQueue<int> queue(4);
+    EXPECT_EQ(queue.capacity(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.push(i));
+    }
+    EXPECT_EQ(queue.size(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(queue.try_pop(), i);
+    }
+    EXPECT_FALSE(queue.try_pop().has_value());
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(BoundedQueueTest, DropNewestRejectsWhenFull) {
+    MarketData::BoundedQueue<int> queue(2, MarketData::Backpressure::DropNewest);
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    EXPECT_FALSE(queue.push(3));
+    EXPECT_EQ(queue.dropped(), 1u);
+    EXPECT_EQ(queue.try_pop(), 1);
+    EXPECT_EQ(queue.try_pop(), 2);
+}
+
+TEST(BoundedQueueTest, DropOldestEvictsWhenFull) {
+    MarketData::BoundedQueue<int> queue(2, MarketData::Backpressure::DropOldest);
+    for (int i = 1; i <= 5; ++i) {
+        EXPECT_TRUE(queue.push(i));
+    }
+    EXPECT_EQ(queue.dropped(), 3u);
+    EXPECT_EQ(queue.try_pop(), 4);
+    EXPECT_EQ(queue.try_pop(), 5);
+}
+
+TEST(BoundedQueueTest, BlockingMultiProducerMultiConsumer) {
+    MarketData::BoundedQueue<uint64_t> queue(16);
+    const int numProducers = 4;
+    const uint64_t perProducer = 20000;
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> count{0};
+
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 4; ++c) {
+        consumers.emplace_back([&] {
+            while (auto value = queue.pop()) {
+                sum += *value;
+                ++count;
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int p = 0; p < numProducers; ++p) {
+        producers.emplace_back([&queue, perProducer] {
+            for (uint64_t i = 1; i <= perProducer; ++i) {
+                queue.push(i);
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    queue.stop();
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+
+    EXPECT_EQ(count.load(), numProducers * perProducer);
+    EXPECT_EQ(sum.load(), numProducers * perProducer * (perProducer + 1) / 2);
+}
+
+TEST(BoundedQueueTest, BatchPushCallsOnFullBeforeWaiting) {
+    MarketData::BoundedQueue<int> queue(4);
+    std::vector<int> values(10);
+    for (int i = 0; i < 10; ++i) {
+        values[i] = i;
+    }
+
+    // The consumer only starts once the producer reports a full ring
+    std::promise<void> full;
+    std::atomic<int> fullCalls{0};
+    auto consumer = std::async(std::launch::async, [&queue, future = full.get_future()]() mutable {
+        future.wait();
+        std::vector<int> seen;
+        while (auto value = queue.pop()) {
+            seen.push_back(*value);
+        }
+        return seen;
+    });
+
+    size_t pushed = queue.push(values.data(), values.size(), [&] {
+        if (fullCalls++ == 0) {
+            full.set_value();
+        }
+    });
+    queue.stop();
+
+    EXPECT_EQ(pushed, values.size());
+    EXPECT_GE(fullCalls.load(), 1);
+    EXPECT_EQ(consumer.get(), values);
+}
+
+TEST(BoundedQueueTest, StopWakesParkedConsumer) {
+    MarketData::BoundedQueue<int> queue(8);
+    auto waiter = std::async(std::launch::async, [&queue] { return queue.pop(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    queue.stop();
+    EXPECT_FALSE(waiter.get().has_value());
+}
+
+TEST(BoundedQueueTest, BacksThreadPool) {
+    std::atomic<int> executed{0};
+    {
+        MarketData::BoundedThreadPool pool(2);
+        std::vector<std::future<int>> results;
+        for (int i = 0; i < 100; ++i) {
+            results.push_back(pool.submit([&executed, i] { ++executed; return i * 2; }));
+        }
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_EQ(results[i].get(), i * 2);
+        }
+    }
+    EXPECT_EQ(executed.load(), 100);
+}
+
 int main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
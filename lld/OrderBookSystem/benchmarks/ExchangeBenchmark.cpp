@@ -0,0 +1,99 @@
+#include "Exchange.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Draws symbol ranks following a Zipf distribution: rank k has weight 1 / k^s.
+// A handful of names carry most of the flow while the long tail stays active.
+class ZipfDistribution {
+public:
+    ZipfDistribution(size_t n, double s) : cdf_(n) {
+        double sum = 0.0;
+        for (size_t k = 0; k < n; ++k) {
+            sum += 1.0 / std::pow(static_cast<double>(k + 1), s);
+            cdf_[k] = sum;
+        }
+        for (auto& value : cdf_) {
+            value /= sum;
+        }
+    }
+
+    template<typename Rng>
+    size_t operator()(Rng& rng) {
+        double u = uniform_(rng);
+        return std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin();
+    }
+
+private:
+    std::vector<double> cdf_;
+    std::uniform_real_distribution<double> uniform_{0.0, 1.0};
+};
+
+std::vector<OrderBook::OrderRequest> generateOrders(size_t numOrders, size_t numSymbols, double skew) {
+    std::mt19937_64 rng(42);
+    ZipfDistribution zipf(numSymbols, skew);
+    std::uniform_int_distribution<int> ticks(-20, 20);
+    std::uniform_int_distribution<int> quantity(1, 100);
+    std::bernoulli_distribution isBuy(0.5);
+
+    // Ranks are scattered over ids so hot symbols do not line up with shards
+    std::vector<OrderBook::SymbolId> rankToId(numSymbols);
+    for (size_t i = 0; i < numSymbols; ++i) {
+        rankToId[i] = static_cast<OrderBook::SymbolId>(i);
+    }
+    std::shuffle(rankToId.begin(), rankToId.end(), rng);
+
+    std::vector<OrderBook::OrderRequest> orders;
+    orders.reserve(numOrders);
+    for (size_t i = 0; i < numOrders; ++i) {
+        orders.push_back({
+            rankToId[zipf(rng)],
+            100.0 + ticks(rng) * 0.01,
+            quantity(rng),
+            isBuy(rng) ? OrderBook::OrderType::BUY : OrderBook::OrderType::SELL
+        });
+    }
+    return orders;
+}
+
+double run(size_t numShards, size_t numSymbols, const std::vector<OrderBook::OrderRequest>& orders,
+           size_t batchSize) {
+    OrderBook::Exchange exchange(numShards);
+    for (size_t i = 0; i < numSymbols; ++i) {
+        exchange.addSymbol("SYM" + std::to_string(i));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t offset = 0; offset < orders.size(); offset += batchSize) {
+        size_t count = std::min(batchSize, orders.size() - offset);
+        exchange.submitBatch(orders.data() + offset, count);
+    }
+    exchange.flush();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return orders.size() / elapsed;
+}
+
+int main(int argc, char** argv) {
+    size_t numOrders = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+    size_t numSymbols = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000;
+    double skew = argc > 3 ? std::strtod(argv[3], nullptr) : 1.1;
+    const size_t batchSize = 512;
+
+    std::cout << "Generating " << numOrders << " orders over " << numSymbols
+              << " symbols (zipf s=" << skew << ")\n";
+    auto orders = generateOrders(numOrders, numSymbols, skew);
+
+    size_t maxShards = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t shards = 1; shards <= maxShards; shards *= 2) {
+        double rate = run(shards, numSymbols, orders, batchSize);
+        std::cout << "shards=" << shards << "  orders/sec=" << static_cast<uint64_t>(rate) << "\n";
+    }
+    return 0;
+}
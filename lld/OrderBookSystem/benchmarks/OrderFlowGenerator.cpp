@@ -0,0 +1,176 @@
+#include "EventFile.h"
+#include "OrderBook.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Synthesizes order flow with the shape of a real single-name feed:
+// - passive adds cluster within a few ticks of a drifting mid price
+// - cancels and amendments dominate, mostly hitting recently placed orders
+// - occasional bursts: aggressive sweeps through the touch and cancel storms
+// The flow is run through an OrderBook as it is generated, so cancels and
+// amendments only target orders that are still resting when replayed.
+class OrderFlowGenerator {
+public:
+    OrderFlowGenerator(uint64_t seed, double tickSize) : rng_(seed), tickSize_(tickSize) {}
+
+    std::vector<OrderBook::OrderEvent> generate(size_t numEvents) {
+        std::vector<OrderBook::OrderEvent> events;
+        events.reserve(numEvents);
+
+        while (events.size() < numEvents) {
+            if (events.size() % 200 == 0) {
+                midTicks_ += drift_(rng_);
+            }
+
+            if (burstRemaining_ > 0) {
+                --burstRemaining_;
+                events.push_back(burstIsSweep_ ? aggressiveAdd() : cancelOrAdd());
+                continue;
+            }
+            if (startBurst_(rng_)) {
+                burstRemaining_ = burstLength_(rng_);
+                burstIsSweep_ = coin_(rng_);
+                continue;
+            }
+
+            double action = unit_(rng_);
+            if (action < 0.45 || live_.empty()) {
+                events.push_back(passiveAdd());
+            } else if (action < 0.90) {
+                events.push_back(cancel());
+            } else {
+                events.push_back(modify());
+            }
+        }
+        return events;
+    }
+
+private:
+    OrderBook::OrderEvent add(int64_t priceTicks, OrderBook::OrderType side) {
+        OrderBook::OrderEvent event{};
+        event.orderId = nextOrderId_++;
+        event.priceTicks = priceTicks;
+        event.quantity = quantity_(rng_) * 10;
+        event.type = OrderBook::EventType::ADD;
+        event.side = static_cast<uint8_t>(side);
+        live_.push_back(event.orderId);
+
+        // Same price arithmetic as the replay, so both books agree
+        OrderBook::Order order(event.priceTicks * tickSize_, event.quantity, side);
+        bookIds_.push_back(order.getOrderId());
+        book_.addOrder(std::move(order));
+        book_.matchOrders();
+        return event;
+    }
+
+    OrderBook::OrderEvent passiveAdd() {
+        bool buy = coin_(rng_);
+        int64_t distance = depth_(rng_);
+        return buy ? add(midTicks_ - 1 - distance, OrderBook::OrderType::BUY)
+                   : add(midTicks_ + 1 + distance, OrderBook::OrderType::SELL);
+    }
+
+    OrderBook::OrderEvent aggressiveAdd() {
+        bool buy = coin_(rng_);
+        int64_t through = sweepDepth_(rng_);
+        return buy ? add(midTicks_ + through, OrderBook::OrderType::BUY)
+                   : add(midTicks_ - through, OrderBook::OrderType::SELL);
+    }
+
+    OrderBook::OrderEvent cancelOrAdd() {
+        return live_.empty() ? passiveAdd() : cancel();
+    }
+
+    // Picks one of the most recently added orders that still rests in the
+    // book (most orders are pulled shortly after being placed) and forgets
+    // it. Orders filled since they were added are dropped on the way; false
+    // if none is left.
+    bool takeLiveOrder(uint64_t& orderId) {
+        while (!live_.empty()) {
+            size_t window = std::min<size_t>(live_.size(), 256);
+            std::uniform_int_distribution<size_t> pick(live_.size() - window, live_.size() - 1);
+            size_t index = pick(rng_);
+            orderId = live_[index];
+            live_[index] = live_.back();
+            live_.pop_back();
+            if (book_.hasOrder(bookIds_[orderId])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    OrderBook::OrderEvent cancel() {
+        OrderBook::OrderEvent event{};
+        if (!takeLiveOrder(event.orderId)) {
+            return passiveAdd();
+        }
+        event.type = OrderBook::EventType::CANCEL;
+        book_.cancelOrder(bookIds_[event.orderId]);
+        return event;
+    }
+
+    OrderBook::OrderEvent modify() {
+        OrderBook::OrderEvent event{};
+        if (!takeLiveOrder(event.orderId)) {
+            return passiveAdd();
+        }
+        event.quantity = quantity_(rng_) * 10;
+        event.type = OrderBook::EventType::MODIFY;
+        live_.push_back(event.orderId);
+        book_.modifyOrder(bookIds_[event.orderId], event.quantity);
+        book_.matchOrders();
+        return event;
+    }
+
+    std::mt19937_64 rng_;
+    std::uniform_real_distribution<double> unit_{0.0, 1.0};
+    std::bernoulli_distribution coin_{0.5};
+    std::bernoulli_distribution startBurst_{0.002};
+    std::uniform_int_distribution<int> burstLength_{50, 500};
+    std::uniform_int_distribution<int> drift_{-1, 1};
+    std::geometric_distribution<int> depth_{0.35};
+    std::uniform_int_distribution<int> sweepDepth_{0, 3};
+    std::uniform_int_distribution<int> quantity_{1, 20};
+
+    double tickSize_;
+    OrderBook::OrderBook book_;
+    std::vector<std::string> bookIds_;  // book id per generated order id
+
+    int64_t midTicks_ = 10000;
+    uint64_t nextOrderId_ = 0;
+    std::vector<uint64_t> live_;
+    int burstRemaining_ = 0;
+    bool burstIsSweep_ = false;
+};
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <output-file> [events] [seed]\n";
+        return 1;
+    }
+
+    size_t numEvents = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5'000'000;
+    uint64_t seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 42;
+
+    try {
+        const double tickSize = 0.01;
+        OrderFlowGenerator generator(seed, tickSize);
+        auto events = generator.generate(numEvents);
+        OrderBook::writeEventFile(argv[1], tickSize, events);
+
+        size_t counts[3] = {0, 0, 0};
+        for (const auto& event : events) {
+            ++counts[static_cast<size_t>(event.type)];
+        }
+        std::cout << "Wrote " << events.size() << " events to " << argv[1]
+                  << " (add " << counts[0] << ", cancel " << counts[1] << ", modify " << counts[2] << ")\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "EventFile.h"
+#include "OrderBook.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+// Global allocation counter so the report shows heap traffic per operation
+namespace {
+std::atomic<uint64_t> allocationCount{0};
+}
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+struct OperationStats {
+    const char* name;
+    std::vector<uint32_t> latenciesNs;
+    uint64_t allocations = 0;
+    uint64_t rejected = 0;   // cancels/modifies for orders already filled or gone
+};
+
+void printStats(OperationStats& stats) {
+    auto& samples = stats.latenciesNs;
+    if (samples.empty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+    };
+
+    std::cout << std::left << std::setw(8) << stats.name
+              << std::right << std::setw(10) << samples.size()
+              << std::setw(9) << percentile(0.50)
+              << std::setw(9) << percentile(0.90)
+              << std::setw(9) << percentile(0.99)
+              << std::setw(9) << percentile(0.999)
+              << std::setw(10) << samples.back()
+              << std::setw(11) << std::fixed << std::setprecision(2)
+              << static_cast<double>(stats.allocations) / samples.size()
+              << std::setw(10) << stats.rejected << "\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <event-file>\n";
+        return 1;
+    }
+
+    try {
+        OrderBook::EventFile file(argv[1]);
+        std::cout << "Replaying " << file.size() << " events from " << argv[1] << "\n";
+
+        OperationStats stats[3] = {{"add", {}}, {"cancel", {}}, {"modify", {}}};
+        for (auto& op : stats) {
+            op.latenciesNs.reserve(file.size());
+        }
+
+        OrderBook::OrderBook book;
+        const double tickSize = file.tickSize();
+
+        // Orders are built before the clock starts, so the timed adds cover
+        // only the book: no id generation or harness bookkeeping. File order
+        // ids are dense; map them to the ids the book assigned.
+        std::vector<OrderBook::Order> orders;
+        std::vector<std::string> bookIds;
+        for (const auto& event : file) {
+            if (event.type != OrderBook::EventType::ADD) {
+                continue;
+            }
+            orders.emplace_back(event.priceTicks * tickSize, event.quantity,
+                                static_cast<OrderBook::OrderType>(event.side));
+            if (event.orderId >= bookIds.size()) {
+                bookIds.resize(event.orderId + 1);
+            }
+            bookIds[event.orderId] = orders.back().getOrderId();
+        }
+        const std::string missing;
+        auto bookId = [&](uint64_t orderId) -> const std::string& {
+            return orderId < bookIds.size() ? bookIds[orderId] : missing;
+        };
+        size_t nextOrder = 0;
+
+        uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+        auto replayStart = std::chrono::steady_clock::now();
+
+        for (const auto& event : file) {
+            auto& op = stats[static_cast<size_t>(event.type)];
+            uint64_t allocs = allocationCount.load(std::memory_order_relaxed);
+            auto start = std::chrono::steady_clock::now();
+
+            switch (event.type) {
+            case OrderBook::EventType::ADD:
+                book.addOrder(std::move(orders[nextOrder++]));
+                book.matchOrders();
+                break;
+            case OrderBook::EventType::CANCEL:
+                if (!book.cancelOrder(bookId(event.orderId))) {
+                    ++op.rejected;
+                }
+                break;
+            case OrderBook::EventType::MODIFY:
+                if (!book.modifyOrder(bookId(event.orderId), event.quantity)) {
+                    ++op.rejected;
+                }
+                book.matchOrders();
+                break;
+            }
+
+            auto end = std::chrono::steady_clock::now();
+            op.latenciesNs.push_back(static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+            op.allocations += allocationCount.load(std::memory_order_relaxed) - allocs;
+        }
+
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - replayStart).count();
+        uint64_t totalAllocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+
+        std::cout << "Throughput: " << static_cast<uint64_t>(file.size() / elapsed) << " events/sec ("
+                  << std::fixed << std::setprecision(3) << elapsed << " s)\n";
+        std::cout << "Allocations: " << totalAllocations << " total\n\n";
+        std::cout << "latency (ns)   count      p50      p90      p99    p99.9       max  allocs/op  rejected\n";
+        for (auto& op : stats) {
+            printStats(op);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+
+namespace OrderBook {
+
+// Separates data written by different threads to avoid false sharing
+constexpr size_t kCacheLineSize = 64;
+
+} // namespace OrderBook
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Order.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace OrderBook {
+
+enum class EventType : uint8_t {
+    ADD = 0,
+    CANCEL = 1,
+    MODIFY = 2
+};
+
+// One order-flow event as stored on disk (24 bytes, little-endian host layout).
+// orderId is a dense id assigned by the producer of the file, not the book's id.
+struct OrderEvent {
+    uint64_t orderId;
+    int64_t priceTicks;  // ADD only
+    int32_t quantity;    // ADD and MODIFY
+    EventType type;
+    uint8_t side;        // ADD only, OrderType value
+    uint16_t reserved;
+};
+static_assert(sizeof(OrderEvent) == 24, "OrderEvent must stay 24 bytes on disk");
+
+struct EventFileHeader {
+    char magic[4];       // "OBEV"
+    uint32_t version;
+    uint64_t eventCount;
+    double tickSize;     // price = priceTicks * tickSize
+};
+static_assert(sizeof(EventFileHeader) == 24, "EventFileHeader must stay 24 bytes on disk");
+
+constexpr uint32_t kEventFileVersion = 1;
+
+void writeEventFile(const std::string& path, double tickSize, const std::vector<OrderEvent>& events);
+
+// Read-only memory mapping of an event file; events are used in place
+class EventFile {
+public:
+    explicit EventFile(const std::string& path);
+    ~EventFile();
+
+    // Prevent copying
+    EventFile(const EventFile&) = delete;
+    EventFile& operator=(const EventFile&) = delete;
+
+    // Prevent moving
+    EventFile(EventFile&&) = delete;
+    EventFile& operator=(EventFile&&) = delete;
+
+    const OrderEvent* begin() const { return events_; }
+    const OrderEvent* end() const { return events_ + count_; }
+    size_t size() const { return count_; }
+    double tickSize() const { return tickSize_; }
+
+private:
+    void* mapping_ = nullptr;
+    size_t mappedBytes_ = 0;
+    const OrderEvent* events_ = nullptr;
+    size_t count_ = 0;
+    double tickSize_ = 0.0;
+};
+
+} // namespace OrderBook
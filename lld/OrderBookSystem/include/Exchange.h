@@ -0,0 +1,79 @@
+#pragma once
+
+#include "MpscQueue.h"
+#include "Order.h"
+#include "OrderBook.h"
+#include "SymbolTable.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace OrderBook {
+
+// Inbound order addressed to one instrument
+struct OrderRequest {
+    SymbolId symbol;
+    double price;
+    int quantity;
+    OrderType type;
+};
+
+// Multi-symbol matching engine.
+// Books are partitioned across shards by symbol id; each shard is a single
+// thread that owns its books outright, so matching never takes a lock.
+// Producers hand orders to a shard through its lock-free inbound ring.
+class Exchange {
+public:
+    // numShards == 0 uses one shard per hardware thread
+    explicit Exchange(size_t numShards = 0, size_t queueCapacity = 1 << 16);
+    ~Exchange();
+
+    // Prevent copying
+    Exchange(const Exchange&) = delete;
+    Exchange& operator=(const Exchange&) = delete;
+
+    // Prevent moving
+    Exchange(Exchange&&) = delete;
+    Exchange& operator=(Exchange&&) = delete;
+
+    // Symbol management
+    SymbolId addSymbol(const std::string& symbol);
+    const SymbolTable& symbols() const { return symbols_; }
+
+    // Order entry
+    void submit(const OrderRequest& request);
+    void submitBatch(const OrderRequest* requests, size_t count);
+    void submitBatch(const std::vector<OrderRequest>& requests);
+
+    // Blocks until every order submitted before the call has been matched
+    void flush();
+
+    // Book access is only safe after flush() while no orders are in flight
+    const OrderBook* findBook(SymbolId symbol) const;
+
+    size_t shardCount() const { return shards_.size(); }
+    size_t shardFor(SymbolId symbol) const { return symbol % shards_.size(); }
+    uint64_t processedCount() const;
+
+private:
+    struct Shard {
+        explicit Shard(size_t queueCapacity) : inbound(queueCapacity) {}
+
+        MpscQueue<OrderRequest> inbound;
+        std::vector<std::unique_ptr<OrderBook>> books;  // indexed by symbol / shardCount
+        alignas(kCacheLineSize) std::atomic<uint64_t> processed{0};
+        std::thread worker;
+    };
+
+    void run(Shard& shard);
+    void apply(Shard& shard, const OrderRequest& request);
+    void validate(const OrderRequest& request) const;
+
+    SymbolTable symbols_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<bool> running_{true};
+};
+
+} // namespace OrderBook
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace OrderBook {
+
+// Top-N price levels per side in structure-of-arrays layout.
+// Sized at compile time so callers can keep one per book and refill it in
+// place; bids are best (highest) first, asks best (lowest) first.
+// A trivial type, so it can be published through SeqLock; value-initialize
+// it (L2Snapshot<N> snapshot{}) to start from zeros.
+template<size_t MaxLevels>
+struct L2Snapshot {
+    static constexpr size_t kMaxLevels = MaxLevels;
+
+    uint64_t sequence;  // book change sequence at fill time
+    size_t bidLevels;
+    size_t askLevels;
+
+    std::array<double, MaxLevels> bidPrices;
+    std::array<int, MaxLevels> bidVolumes;
+    std::array<double, MaxLevels> askPrices;
+    std::array<int, MaxLevels> askVolumes;
+};
+
+static_assert(std::is_trivial_v<L2Snapshot<1>>, "L2Snapshot must stay trivial for SeqLock");
+
+} // namespace OrderBook
@@ -4,6 +4,7 @@
 #include <vector>
 #include <memory>
 #include <chrono>
+#include <cstdint>
 
 namespace OrderBook {
 
@@ -15,9 +16,25 @@ struct Trade {
     std::chrono::system_clock::time_point timestamp;
 };
 
+// Rolling trade statistics over a fixed-size ring of recent trades.
+// Aggregates are maintained incrementally on recordTrade, so every query is
+// O(1) and memory stays flat no matter how long the session runs.
+// The time window is measured back from the newest trade's timestamp (or the
+// latest advanceTime call), so queries never read the clock.
+//
+// The window can never hold more than capacity() trades: when more trades than
+// that arrive within one window, the oldest are overwritten and drop out of the
+// window aggregates before they age out. isWindowTruncated() reports when that
+// is the case, and capacityFor() sizes the ring for a peak trade rate.
 class MarketData {
 public:
-    MarketData() = default;
+    static constexpr size_t kDefaultCapacity = 4096;
+
+    // Ring size that keeps a full window at up to maxTradesPerSecond
+    static size_t capacityFor(std::chrono::system_clock::duration window, double maxTradesPerSecond);
+
+    explicit MarketData(size_t capacity = kDefaultCapacity,
+                        std::chrono::system_clock::duration window = std::chrono::minutes(1));
     ~MarketData() = default;
 
     // Prevent copying
@@ -30,16 +47,86 @@ public:
 
     // Trade recording
     void recordTrade(const Trade& trade);
-    
+    // Expires trades older than now - window when no new trades arrive
+    void advanceTime(std::chrono::system_clock::time_point now);
+
     // Market data queries
     std::vector<Trade> getRecentTrades(size_t count) const;
     double getLastTradePrice() const;
-    int getVolumeInLastMinute() const;
-    double getVWAP(size_t count) const;  // Volume Weighted Average Price
+    int getVolumeInLastMinute() const;   // volume over the rolling window (one minute by default)
+    double getVWAP(size_t count) const;  // Volume Weighted Average Price over the last count trades
+
+    // Rolling window queries
+    int64_t getWindowVolume() const;
+    double getWindowVWAP() const;
+    double getWindowHigh() const;
+    double getWindowLow() const;
+    size_t getWindowTradeCount() const { return static_cast<size_t>(recorded_ - windowBegin_); }
+
+    // Whether the window aggregates are missing trades the ring had to overwrite
+    bool isWindowTruncated() const;
+    // Trades overwritten while still inside the time window, ever
+    uint64_t getWindowOverflowCount() const { return windowOverflows_; }
+
+    size_t size() const { return static_cast<size_t>(recorded_ - oldestRetained()); }
+    size_t capacity() const { return trades_.size(); }
 
 private:
+    // Fixed-capacity deque of trade sequence numbers whose prices are monotonic,
+    // giving the window extreme at the front in O(1)
+    class MonotonicWindow {
+    public:
+        explicit MonotonicWindow(size_t capacity) : seqs_(capacity) {}
+
+        template<typename Dominates>
+        void push(uint64_t seq, Dominates dominates) {
+            while (count_ > 0 && dominates(seqs_[index(count_ - 1)])) {
+                --count_;
+            }
+            seqs_[index(count_)] = seq;
+            ++count_;
+        }
+        void expireBefore(uint64_t seq) {
+            while (count_ > 0 && seqs_[index(0)] < seq) {
+                front_ = (front_ + 1) % seqs_.size();
+                --count_;
+            }
+        }
+        bool empty() const { return count_ == 0; }
+        uint64_t front() const { return seqs_[index(0)]; }
+
+    private:
+        size_t index(size_t offset) const { return (front_ + offset) % seqs_.size(); }
+
+        std::vector<uint64_t> seqs_;
+        size_t front_ = 0;
+        size_t count_ = 0;
+    };
+
+    const Trade& tradeAt(uint64_t seq) const { return trades_[seq % trades_.size()]; }
+    uint64_t oldestRetained() const;
+    void expireWindowBefore(uint64_t seq);
+    void expireWindowOlderThan(std::chrono::system_clock::time_point now);
+
+    // Sums over [from, recorded_) via the exclusive prefix stored per slot
+    double valueSince(uint64_t from) const;
+    int64_t volumeSince(uint64_t from) const;
+
     std::vector<Trade> trades_;
+    std::vector<double> valueBefore_;    // running sum of price * quantity before each trade
+    std::vector<int64_t> volumeBefore_;  // running sum of quantity before each trade
+    std::chrono::system_clock::duration window_;
+
+    uint64_t recorded_ = 0;     // total trades ever recorded
+    uint64_t windowBegin_ = 0;  // first sequence number inside the time window
+    double totalValue_ = 0.0;
+    int64_t totalVolume_ = 0;
+    uint64_t windowOverflows_ = 0;
+    std::chrono::system_clock::time_point lastOverflow_;  // timestamp of the newest overwritten in-window trade
+
+    MonotonicWindow highs_;
+    MonotonicWindow lows_;
     std::chrono::system_clock::time_point lastUpdate_;
 };
 
-} // namespace OrderBook 
\ No newline at end of file
+} // namespace OrderBook
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "CacheLine.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace OrderBook {
+
+// Bounded multi-producer / single-consumer ring buffer.
+// Producers reserve slots with one fetch_add (a batch of n costs a single RMW)
+// and publish each slot through its sequence number. The consumer never locks;
+// a full ring makes producers wait for their slot, which is the backpressure.
+template<typename T>
+class MpscQueue {
+public:
+    explicit MpscQueue(size_t capacity)
+        : capacity_(roundUpToPowerOfTwo(capacity))
+        , mask_(capacity_ - 1)
+        , slots_(std::make_unique<Slot[]>(capacity_))
+    {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Prevent copying
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Prevent moving
+    MpscQueue(MpscQueue&&) = delete;
+    MpscQueue& operator=(MpscQueue&&) = delete;
+
+    void push(const T& value) {
+        pushBulk(&value, 1);
+    }
+
+    void pushBulk(const T* values, size_t count) {
+        if (count == 0) {
+            return;
+        }
+        uint64_t pos = tail_.fetch_add(count, std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i, ++pos) {
+            Slot& slot = slots_[pos & mask_];
+            waitFor(slot, pos);
+            slot.value = values[i];
+            slot.sequence.store(pos + 1, std::memory_order_release);
+        }
+    }
+
+    // Consumer only: hands up to maxItems published values to fn, in order
+    template<typename F>
+    size_t consume(F&& fn, size_t maxItems) {
+        size_t consumed = 0;
+        while (consumed < maxItems) {
+            Slot& slot = slots_[head_ & mask_];
+            if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) {
+                break;
+            }
+            fn(slot.value);
+            slot.sequence.store(head_ + capacity_, std::memory_order_release);
+            ++head_;
+            ++consumed;
+        }
+        return consumed;
+    }
+
+    // Consumer only: true when nothing has been reserved beyond what was consumed
+    bool empty() const {
+        return tail_.load(std::memory_order_acquire) == head_;
+    }
+
+    // Total number of slots ever reserved by producers
+    uint64_t reserved() const {
+        return tail_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        T value{};
+    };
+
+    static size_t roundUpToPowerOfTwo(size_t n) {
+        if (n < 2) {
+            throw std::invalid_argument("Queue capacity must be at least 2");
+        }
+        size_t result = 1;
+        while (result < n) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    static void waitFor(const Slot& slot, uint64_t pos) {
+        unsigned spins = 0;
+        while (slot.sequence.load(std::memory_order_acquire) != pos) {
+            if (++spins > 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    // Producer and consumer cursors live on separate cache lines
+    alignas(kCacheLineSize) std::atomic<uint64_t> tail_{0};
+    alignas(kCacheLineSize) uint64_t head_{0};
+};
+
+} // namespace OrderBook
@@ -1,13 +1,23 @@
 #pragma once
 
+#include "L2Snapshot.h"
 #include "Order.h"
+#include "SeqLock.h"
+#include <algorithm>
 #include <map>
 #include <queue>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace OrderBook {
 
+// Depth made visible to lock-free readers on other threads
+constexpr size_t kPublishedDepth = 10;
+using PublishedSnapshot = L2Snapshot<kPublishedDepth>;
+using BookPublisher = SeqLock<PublishedSnapshot>;
+
 class OrderBook {
 public:
     OrderBook() = default;
@@ -24,6 +34,15 @@ public:
     // Core functionality
     void addOrder(Order order);
     void matchOrders();
+
+    // Order amendment by id; both return false for unknown or already filled orders.
+    // Reducing quantity keeps time priority, increasing it requeues the order
+    // at the back of its price level.
+    bool cancelOrder(const std::string& orderId);
+    bool modifyOrder(const std::string& orderId, int newQuantity);
+
+    // True while the order rests in the book (not filled or cancelled)
+    bool hasOrder(const std::string& orderId) const { return liveOrders_.count(orderId) != 0; }
     
     // Market data
     double getBestBid() const;
@@ -31,6 +50,28 @@ public:
     int getVolumeAtPrice(double price) const;
     std::vector<std::pair<double, int>> getOrderBookSnapshot() const;
 
+    // Incremented on every change to the book; compare against
+    // L2Snapshot::sequence to skip books that have not moved
+    uint64_t getSequence() const { return sequence_; }
+
+    // Starts publishing top-of-book and depth after every matchOrders,
+    // cancelOrder and modifyOrder call that changed the book.
+    // Readers on any thread call load() on the returned view without locking
+    // or blocking the matching thread. Must be called from the writer thread.
+    std::shared_ptr<const BookPublisher> enablePublishing();
+
+    // Fills the best depth levels per side into a caller-owned buffer
+    // without allocating or walking past the requested depth
+    template<size_t MaxLevels>
+    void fillSnapshot(L2Snapshot<MaxLevels>& out, size_t depth = MaxLevels) const {
+        depth = std::min(depth, MaxLevels);
+        out.bidLevels = fillLevels(buyVolumes_.rbegin(), buyVolumes_.rend(),
+                                   out.bidPrices.data(), out.bidVolumes.data(), depth);
+        out.askLevels = fillLevels(sellVolumes_.begin(), sellVolumes_.end(),
+                                   out.askPrices.data(), out.askVolumes.data(), depth);
+        out.sequence = sequence_;
+    }
+
 private:
     // Price levels for buy and sell orders
     std::map<double, std::queue<std::unique_ptr<Order>>, std::greater<double>> buyOrders_;
@@ -39,12 +80,48 @@ private:
     // Volume tracking
     std::map<double, int> buyVolumes_;
     std::map<double, int> sellVolumes_;
+    uint64_t sequence_ = 0;
+
+    // Resting orders by id. Cancelled orders are zeroed and left in their
+    // queue until they reach the front or their whole level empties.
+    std::unordered_map<std::string, Order*> liveOrders_;
+
+    // Lock-free reader view, created on demand
+    std::shared_ptr<BookPublisher> publisher_;
+    uint64_t publishedSequence_ = 0;
 
     // Helper functions
     bool canMatch(const Order& buy, const Order& sell) const;
     void executeTrade(Order& buy, Order& sell);
-    void removeEmptyPriceLevels();
     void updateVolume(double price, int quantity, OrderType type);
+    void removeLevelIfEmpty(double price, OrderType type);
+    void publishIfChanged();
+    void publish();
+
+    // Drops cancelled orders and exhausted levels from the top of one side
+    template<typename Levels>
+    static void pruneBestLevel(Levels& levels) {
+        while (!levels.empty()) {
+            auto& queue = levels.begin()->second;
+            while (!queue.empty() && queue.front()->getQuantity() == 0) {
+                queue.pop();
+            }
+            if (!queue.empty()) {
+                return;
+            }
+            levels.erase(levels.begin());
+        }
+    }
+
+    template<typename It>
+    static size_t fillLevels(It it, It end, double* prices, int* volumes, size_t depth) {
+        size_t levels = 0;
+        for (; it != end && levels < depth; ++it, ++levels) {
+            prices[levels] = it->first;
+            volumes[levels] = it->second;
+        }
+        return levels;
+    }
 };
 
 } // namespace OrderBook 
\ No newline at end of file
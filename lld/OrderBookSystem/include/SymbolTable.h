@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace OrderBook {
+
+using SymbolId = uint32_t;
+
+// Maps instrument names to dense ids so the hot path can route and index
+// books by integer instead of hashing strings per order.
+class SymbolTable {
+public:
+    SymbolTable() = default;
+    ~SymbolTable() = default;
+
+    // Prevent copying
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // Returns the existing id for symbol, or assigns the next free one
+    SymbolId intern(const std::string& symbol);
+    std::optional<SymbolId> find(const std::string& symbol) const;
+    const std::string& name(SymbolId id) const;
+
+    size_t size() const { return count_.load(std::memory_order_acquire); }
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, SymbolId> ids_;
+    std::deque<std::string> names_;  // deque keeps returned references stable
+    std::atomic<size_t> count_{0};
+};
+
+} // namespace OrderBook
@@ -0,0 +1,75 @@
+#include "EventFile.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace OrderBook {
+
+void writeEventFile(const std::string& path, double tickSize, const std::vector<OrderEvent>& events) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open event file for writing: " + path);
+    }
+
+    EventFileHeader header{};
+    std::memcpy(header.magic, "OBEV", 4);
+    header.version = kEventFileVersion;
+    header.eventCount = events.size();
+    header.tickSize = tickSize;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(events.data()),
+               static_cast<std::streamsize>(events.size() * sizeof(OrderEvent)));
+    if (!file) {
+        throw std::runtime_error("Failed to write event file: " + path);
+    }
+}
+
+EventFile::EventFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open event file: " + path);
+    }
+
+    struct stat info{};
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(EventFileHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Event file is too small: " + path);
+    }
+
+    mappedBytes_ = static_cast<size_t>(info.st_size);
+    mapping_ = ::mmap(nullptr, mappedBytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        throw std::runtime_error("Cannot map event file: " + path);
+    }
+    // Replay reads front to back
+    ::madvise(mapping_, mappedBytes_, MADV_SEQUENTIAL);
+
+    const auto* header = static_cast<const EventFileHeader*>(mapping_);
+    size_t available = (mappedBytes_ - sizeof(EventFileHeader)) / sizeof(OrderEvent);
+    if (std::memcmp(header->magic, "OBEV", 4) != 0 || header->version != kEventFileVersion
+        || header->eventCount > available) {
+        ::munmap(mapping_, mappedBytes_);
+        mapping_ = nullptr;
+        throw std::runtime_error("Invalid event file: " + path);
+    }
+
+    events_ = reinterpret_cast<const OrderEvent*>(static_cast<const char*>(mapping_) + sizeof(EventFileHeader));
+    count_ = static_cast<size_t>(header->eventCount);
+    tickSize_ = header->tickSize;
+}
+
+EventFile::~EventFile() {
+    if (mapping_) {
+        ::munmap(mapping_, mappedBytes_);
+    }
+}
+
+} // namespace OrderBook
@@ -0,0 +1,200 @@
+#include "Exchange.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace OrderBook {
+
+namespace {
+
+// Orders drained from the ring before publishing progress
+constexpr size_t kDrainBatch = 256;
+
+// CPUs this process may run on, in order; a taskset/cgroup mask is honored
+std::vector<int> allowedCores() {
+    std::vector<int> cores;
+#ifdef __linux__
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &cpuset)) {
+                cores.push_back(cpu);
+            }
+        }
+    }
+#endif
+    return cores;
+}
+
+// Restricts the thread to exactly the given core id
+void pinToCore(std::thread& thread, int core) {
+#ifdef __linux__
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(core, &cpuset);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuset);
+#else
+    (void)thread;
+    (void)core;
+#endif
+}
+
+void backoff(unsigned& idleRounds) {
+    if (idleRounds < 64) {
+        ++idleRounds;
+    } else if (idleRounds < 1024) {
+        ++idleRounds;
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+} // namespace
+
+Exchange::Exchange(size_t numShards, size_t queueCapacity) {
+    size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (numShards == 0) {
+        numShards = hardwareThreads;
+    }
+
+    shards_.reserve(numShards);
+    for (size_t i = 0; i < numShards; ++i) {
+        shards_.push_back(std::make_unique<Shard>(queueCapacity));
+    }
+
+    // Shard i gets the i-th allowed core, not core i, which may be outside
+    // the process mask; with fewer allowed cores than shards nothing is pinned
+    std::vector<int> cores = allowedCores();
+    for (size_t i = 0; i < numShards; ++i) {
+        Shard& shard = *shards_[i];
+        shard.worker = std::thread([this, &shard] { run(shard); });
+        if (numShards <= cores.size()) {
+            pinToCore(shard.worker, cores[i]);
+        }
+    }
+}
+
+Exchange::~Exchange() {
+    running_.store(false, std::memory_order_release);
+    for (auto& shard : shards_) {
+        if (shard->worker.joinable()) {
+            shard->worker.join();
+        }
+    }
+}
+
+SymbolId Exchange::addSymbol(const std::string& symbol) {
+    return symbols_.intern(symbol);
+}
+
+void Exchange::submit(const OrderRequest& request) {
+    validate(request);
+    shards_[shardFor(request.symbol)]->inbound.push(request);
+}
+
+void Exchange::submitBatch(const OrderRequest* requests, size_t count) {
+    // Per-thread scratch buckets so steady-state batching does not allocate
+    thread_local std::vector<std::vector<OrderRequest>> buckets;
+    if (buckets.size() < shards_.size()) {
+        buckets.resize(shards_.size());
+    }
+
+    // Reject the whole batch before anything is queued
+    for (size_t i = 0; i < count; ++i) {
+        validate(requests[i]);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        buckets[shardFor(requests[i].symbol)].push_back(requests[i]);
+    }
+
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        auto& bucket = buckets[i];
+        shards_[i]->inbound.pushBulk(bucket.data(), bucket.size());
+        bucket.clear();
+    }
+}
+
+void Exchange::submitBatch(const std::vector<OrderRequest>& requests) {
+    submitBatch(requests.data(), requests.size());
+}
+
+void Exchange::flush() {
+    for (auto& shard : shards_) {
+        uint64_t target = shard->inbound.reserved();
+        unsigned idleRounds = 0;
+        while (shard->processed.load(std::memory_order_acquire) < target) {
+            backoff(idleRounds);
+        }
+    }
+}
+
+const OrderBook* Exchange::findBook(SymbolId symbol) const {
+    const Shard& shard = *shards_[shardFor(symbol)];
+    size_t local = symbol / shards_.size();
+    if (local >= shard.books.size()) {
+        return nullptr;
+    }
+    return shard.books[local].get();
+}
+
+uint64_t Exchange::processedCount() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->processed.load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+void Exchange::run(Shard& shard) {
+    unsigned idleRounds = 0;
+    while (true) {
+        size_t drained = shard.inbound.consume(
+            [this, &shard](const OrderRequest& request) { apply(shard, request); },
+            kDrainBatch);
+
+        if (drained > 0) {
+            shard.processed.fetch_add(drained, std::memory_order_release);
+            idleRounds = 0;
+            continue;
+        }
+
+        if (!running_.load(std::memory_order_acquire) && shard.inbound.empty()) {
+            break;
+        }
+        backoff(idleRounds);
+    }
+}
+
+void Exchange::apply(Shard& shard, const OrderRequest& request) {
+    size_t local = request.symbol / shards_.size();
+    if (local >= shard.books.size()) {
+        shard.books.resize(local + 1);
+    }
+    auto& book = shard.books[local];
+    if (!book) {
+        book = std::make_unique<OrderBook>();
+    }
+
+    book->addOrder(Order(request.price, request.quantity, request.type));
+    book->matchOrders();
+}
+
+void Exchange::validate(const OrderRequest& request) const {
+    if (request.symbol >= symbols_.size()) {
+        throw std::invalid_argument("Unknown symbol id: " + std::to_string(request.symbol));
+    }
+    if (request.quantity <= 0) {
+        throw std::invalid_argument("Order quantity must be positive");
+    }
+}
+
+} // namespace OrderBook
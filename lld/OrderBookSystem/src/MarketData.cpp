@@ -1,69 +1,163 @@
 #include "MarketData.h"
 #include <algorithm>
-#include <numeric>
+#include <cmath>
 #include <stdexcept>
 
 namespace OrderBook {
 
+MarketData::MarketData(size_t capacity, std::chrono::system_clock::duration window)
+    : trades_(capacity)
+    , valueBefore_(capacity)
+    , volumeBefore_(capacity)
+    , window_(window)
+    , highs_(capacity)
+    , lows_(capacity)
+{
+    if (capacity == 0) {
+        throw std::invalid_argument("Trade history capacity must be positive");
+    }
+    if (window <= std::chrono::system_clock::duration::zero()) {
+        throw std::invalid_argument("Rolling window must be positive");
+    }
+}
+
+size_t MarketData::capacityFor(std::chrono::system_clock::duration window, double maxTradesPerSecond) {
+    if (window <= std::chrono::system_clock::duration::zero() || !(maxTradesPerSecond > 0.0)) {
+        throw std::invalid_argument("Window and trade rate must be positive");
+    }
+    double trades = std::chrono::duration<double>(window).count() * maxTradesPerSecond;
+    return static_cast<size_t>(std::ceil(trades)) + 1;
+}
+
 void MarketData::recordTrade(const Trade& trade) {
-    trades_.push_back(trade);
-    lastUpdate_ = std::chrono::system_clock::now();
+    const uint64_t seq = recorded_;
+    const size_t slot = seq % trades_.size();
+
+    // The slot being overwritten drops out of every aggregate first
+    if (seq >= trades_.size()) {
+        const uint64_t evicted = seq - trades_.size();
+        if (evicted >= windowBegin_) {
+            ++windowOverflows_;
+            lastOverflow_ = std::max(lastOverflow_, tradeAt(evicted).timestamp);
+        }
+        expireWindowBefore(evicted + 1);
+    }
+
+    trades_[slot] = trade;
+    valueBefore_[slot] = totalValue_;
+    volumeBefore_[slot] = totalVolume_;
+    totalValue_ += trade.price * trade.quantity;
+    totalVolume_ += trade.quantity;
+    ++recorded_;
+
+    highs_.push(seq, [this, &trade](uint64_t other) { return tradeAt(other).price <= trade.price; });
+    lows_.push(seq, [this, &trade](uint64_t other) { return tradeAt(other).price >= trade.price; });
+
+    lastUpdate_ = std::max(lastUpdate_, trade.timestamp);
+    expireWindowOlderThan(lastUpdate_);
+}
+
+void MarketData::advanceTime(std::chrono::system_clock::time_point now) {
+    lastUpdate_ = std::max(lastUpdate_, now);
+    expireWindowOlderThan(lastUpdate_);
 }
 
 std::vector<Trade> MarketData::getRecentTrades(size_t count) const {
-    if (trades_.empty()) {
-        return {};
+    uint64_t from = recorded_ - std::min<uint64_t>(count, size());
+
+    std::vector<Trade> recent;
+    recent.reserve(static_cast<size_t>(recorded_ - from));
+    for (uint64_t seq = from; seq < recorded_; ++seq) {
+        recent.push_back(tradeAt(seq));
     }
-    
-    size_t startIdx = (trades_.size() > count) ? trades_.size() - count : 0;
-    return std::vector<Trade>(trades_.begin() + startIdx, trades_.end());
+    return recent;
 }
 
 double MarketData::getLastTradePrice() const {
-    if (trades_.empty()) {
+    if (recorded_ == 0) {
         throw std::runtime_error("No trades recorded");
     }
-    return trades_.back().price;
+    return tradeAt(recorded_ - 1).price;
 }
 
 int MarketData::getVolumeInLastMinute() const {
-    if (trades_.empty()) {
-        return 0;
-    }
-    
-    auto oneMinuteAgo = std::chrono::system_clock::now() - std::chrono::minutes(1);
-    
-    return std::accumulate(trades_.rbegin(), trades_.rend(), 0,
-        [oneMinuteAgo](int sum, const Trade& trade) {
-            if (trade.timestamp >= oneMinuteAgo) {
-                return sum + trade.quantity;
-            }
-            return sum;
-        });
+    return static_cast<int>(getWindowVolume());
 }
 
 double MarketData::getVWAP(size_t count) const {
-    if (trades_.empty()) {
+    if (recorded_ == 0) {
         throw std::runtime_error("No trades recorded");
     }
-    
-    size_t startIdx = (trades_.size() > count) ? trades_.size() - count : 0;
-    auto begin = trades_.begin() + startIdx;
-    auto end = trades_.end();
-    
-    double totalValue = 0.0;
-    int totalVolume = 0;
-    
-    for (auto it = begin; it != end; ++it) {
-        totalValue += it->price * it->quantity;
-        totalVolume += it->quantity;
+
+    uint64_t from = recorded_ - std::min<uint64_t>(count, size());
+    int64_t volume = volumeSince(from);
+    if (volume == 0) {
+        throw std::runtime_error("No volume in the specified period");
     }
-    
-    if (totalVolume == 0) {
+    return valueSince(from) / volume;
+}
+
+int64_t MarketData::getWindowVolume() const {
+    return volumeSince(windowBegin_);
+}
+
+double MarketData::getWindowVWAP() const {
+    int64_t volume = volumeSince(windowBegin_);
+    if (volume == 0) {
         throw std::runtime_error("No volume in the specified period");
     }
-    
-    return totalValue / totalVolume;
+    return valueSince(windowBegin_) / volume;
+}
+
+double MarketData::getWindowHigh() const {
+    if (highs_.empty()) {
+        throw std::runtime_error("No trades in the rolling window");
+    }
+    return tradeAt(highs_.front()).price;
+}
+
+double MarketData::getWindowLow() const {
+    if (lows_.empty()) {
+        throw std::runtime_error("No trades in the rolling window");
+    }
+    return tradeAt(lows_.front()).price;
+}
+
+bool MarketData::isWindowTruncated() const {
+    return windowOverflows_ > 0 && lastOverflow_ >= lastUpdate_ - window_;
+}
+
+uint64_t MarketData::oldestRetained() const {
+    return recorded_ > trades_.size() ? recorded_ - trades_.size() : 0;
+}
+
+void MarketData::expireWindowBefore(uint64_t seq) {
+    windowBegin_ = std::max(windowBegin_, seq);
+    highs_.expireBefore(windowBegin_);
+    lows_.expireBefore(windowBegin_);
+}
+
+void MarketData::expireWindowOlderThan(std::chrono::system_clock::time_point now) {
+    const auto cutoff = now - window_;
+    uint64_t begin = windowBegin_;
+    while (begin < recorded_ && tradeAt(begin).timestamp < cutoff) {
+        ++begin;
+    }
+    expireWindowBefore(begin);
+}
+
+double MarketData::valueSince(uint64_t from) const {
+    if (from >= recorded_) {
+        return 0.0;
+    }
+    return totalValue_ - valueBefore_[from % trades_.size()];
+}
+
+int64_t MarketData::volumeSince(uint64_t from) const {
+    if (from >= recorded_) {
+        return 0;
+    }
+    return totalVolume_ - volumeBefore_[from % trades_.size()];
 }
 
-} // namespace OrderBook 
\ No newline at end of file
+} // namespace OrderBook
@@ -15,9 +15,9 @@ Order::Order(double price, int quantity, OrderType type)
 }
 
 std::string Order::generateOrderId() {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(0, 15);
+    // Per-thread generator: orders are created concurrently on exchange shards
+    thread_local std::mt19937 gen(std::random_device{}());
+    thread_local std::uniform_int_distribution<> dis(0, 15);
     static const char* hex = "0123456789abcdef";
     
     std::string uuid;
@@ -9,6 +9,7 @@ void OrderBook::addOrder(Order order) {
     double price = orderPtr->getPrice();
     int quantity = orderPtr->getQuantity();
     OrderType type = orderPtr->getType();
+    liveOrders_.emplace(orderPtr->getOrderId(), orderPtr.get());
     
     if (type == OrderType::BUY) {
         buyOrders_[price].push(std::move(orderPtr));
@@ -17,10 +18,17 @@ void OrderBook::addOrder(Order order) {
         sellOrders_[price].push(std::move(orderPtr));
         sellVolumes_[price] += quantity;
     }
+    ++sequence_;
 }
 
 void OrderBook::matchOrders() {
-    while (!buyOrders_.empty() && !sellOrders_.empty()) {
+    while (true) {
+        pruneBestLevel(buyOrders_);
+        pruneBestLevel(sellOrders_);
+        if (buyOrders_.empty() || sellOrders_.empty()) {
+            break;
+        }
+
         auto& bestBid = buyOrders_.begin()->second.front();
         auto& bestAsk = sellOrders_.begin()->second.front();
         
@@ -29,10 +37,86 @@ void OrderBook::matchOrders() {
         }
         
         executeTrade(*bestBid, *bestAsk);
-        removeEmptyPriceLevels();
+    }
+    publishIfChanged();
+}
+
+bool OrderBook::cancelOrder(const std::string& orderId) {
+    auto it = liveOrders_.find(orderId);
+    if (it == liveOrders_.end()) {
+        return false;
+    }
+
+    Order* order = it->second;
+    double price = order->getPrice();
+    OrderType type = order->getType();
+    int remaining = order->getQuantity();
+    liveOrders_.erase(it);
+
+    order->setQuantity(0);
+    updateVolume(price, -remaining, type);
+    removeLevelIfEmpty(price, type);
+    ++sequence_;
+    publishIfChanged();
+    return true;
+}
+
+bool OrderBook::modifyOrder(const std::string& orderId, int newQuantity) {
+    if (newQuantity <= 0) {
+        return cancelOrder(orderId);
+    }
+
+    auto it = liveOrders_.find(orderId);
+    if (it == liveOrders_.end()) {
+        return false;
+    }
+
+    Order* order = it->second;
+    int delta = newQuantity - order->getQuantity();
+    if (delta == 0) {
+        return true;
+    }
+    updateVolume(order->getPrice(), delta, order->getType());
+
+    if (delta < 0) {
+        order->setQuantity(newQuantity);
+    } else {
+        auto requeued = std::make_unique<Order>(*order);
+        requeued->setQuantity(newQuantity);
+        order->setQuantity(0);
+        it->second = requeued.get();
+        if (requeued->getType() == OrderType::BUY) {
+            buyOrders_[requeued->getPrice()].push(std::move(requeued));
+        } else {
+            sellOrders_[requeued->getPrice()].push(std::move(requeued));
+        }
+    }
+    ++sequence_;
+    publishIfChanged();
+    return true;
+}
+
+std::shared_ptr<const BookPublisher> OrderBook::enablePublishing() {
+    if (!publisher_) {
+        publisher_ = std::make_shared<BookPublisher>();
+        publish();
+    }
+    return publisher_;
+}
+
+void OrderBook::publishIfChanged() {
+    if (publisher_ && publishedSequence_ != sequence_) {
+        publish();
     }
 }
 
+void OrderBook::publish() {
+    PublishedSnapshot snapshot{};
+    fillSnapshot(snapshot);
+    publisher_->store(snapshot);
+    publishedSequence_ = sequence_;
+}
+
 bool OrderBook::canMatch(const Order& buy, const Order& sell) const {
     return buy.getPrice() >= sell.getPrice();
 }
@@ -47,12 +131,14 @@ void OrderBook::executeTrade(Order& buy, Order& sell) {
     
     updateVolume(buyPrice, -tradeQuantity, OrderType::BUY);
     updateVolume(sellPrice, -tradeQuantity, OrderType::SELL);
+    ++sequence_;
     
+    // Filled orders are popped by pruneBestLevel on the next pass
     if (buy.getQuantity() == 0) {
-        buyOrders_.begin()->second.pop();
+        liveOrders_.erase(buy.getOrderId());
     }
     if (sell.getQuantity() == 0) {
-        sellOrders_.begin()->second.pop();
+        liveOrders_.erase(sell.getOrderId());
     }
 }
 
@@ -70,20 +156,14 @@ void OrderBook::updateVolume(double price, int quantity, OrderType type) {
     }
 }
 
-void OrderBook::removeEmptyPriceLevels() {
-    for (auto it = buyOrders_.begin(); it != buyOrders_.end();) {
-        if (it->second.empty()) {
-            it = buyOrders_.erase(it);
-        } else {
-            ++it;
+void OrderBook::removeLevelIfEmpty(double price, OrderType type) {
+    if (type == OrderType::BUY) {
+        if (buyVolumes_.find(price) == buyVolumes_.end()) {
+            buyOrders_.erase(price);
         }
-    }
-    
-    for (auto it = sellOrders_.begin(); it != sellOrders_.end();) {
-        if (it->second.empty()) {
-            it = sellOrders_.erase(it);
-        } else {
-            ++it;
+    } else {
+        if (sellVolumes_.find(price) == sellVolumes_.end()) {
+            sellOrders_.erase(price);
         }
     }
 }
@@ -0,0 +1,38 @@
+#include "SymbolTable.h"
+#include <mutex>
+#include <stdexcept>
+
+namespace OrderBook {
+
+SymbolId SymbolTable::intern(const std::string& symbol) {
+    if (auto existing = find(symbol)) {
+        return *existing;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto [it, inserted] = ids_.try_emplace(symbol, static_cast<SymbolId>(names_.size()));
+    if (inserted) {
+        names_.push_back(symbol);
+        count_.store(names_.size(), std::memory_order_release);
+    }
+    return it->second;
+}
+
+std::optional<SymbolId> SymbolTable::find(const std::string& symbol) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(symbol);
+    if (it == ids_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+const std::string& SymbolTable::name(SymbolId id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (id >= names_.size()) {
+        throw std::out_of_range("Unknown symbol id: " + std::to_string(id));
+    }
+    return names_[id];
+}
+
+} // namespace OrderBook
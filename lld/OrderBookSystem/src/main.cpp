@@ -1,3 +1,4 @@
+#include "Exchange.h"
 #include "OrderBook.h"
 #include <iostream>
 
@@ -17,6 +18,27 @@ int main() {
     for (const auto& [price, volume] : snapshot) {
         std::cout << "Price: " << price << ", Volume: " << volume << "\n";
     }
+
+    // Multi-symbol routing through the exchange
+    OrderBook::Exchange exchange(2);
+    auto aapl = exchange.addSymbol("AAPL");
+    auto msft = exchange.addSymbol("MSFT");
+
+    exchange.submitBatch({
+        {aapl, 150.0, 10, OrderBook::OrderType::BUY},
+        {aapl, 149.5, 4, OrderBook::OrderType::SELL},
+        {msft, 300.0, 7, OrderBook::OrderType::SELL}
+    });
+    exchange.flush();
+
+    std::cout << "\nExchange:\n";
+    for (auto symbol : {aapl, msft}) {
+        auto levels = exchange.findBook(symbol)->getOrderBookSnapshot();
+        std::cout << exchange.symbols().name(symbol) << ":\n";
+        for (const auto& [price, volume] : levels) {
+            std::cout << "  Price: " << price << ", Volume: " << volume << "\n";
+        }
+    }
     
     return 0;
 } 
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "Exchange.h"
+#include <thread>
+#include <vector>
+
+class ExchangeTest : public ::testing::Test {
+protected:
+    OrderBook::Exchange exchange{4, 1024};
+};
+
+TEST_F(ExchangeTest, SymbolInterning) {
+    auto aapl = exchange.addSymbol("AAPL");
+    auto msft = exchange.addSymbol("MSFT");
+
+    EXPECT_NE(aapl, msft);
+    EXPECT_EQ(exchange.addSymbol("AAPL"), aapl);
+    EXPECT_EQ(exchange.symbols().name(msft), "MSFT");
+    EXPECT_FALSE(exchange.symbols().find("GOOGL").has_value());
+}
+
+TEST_F(ExchangeTest, OrdersRouteToTheirOwnBook) {
+    auto aapl = exchange.addSymbol("AAPL");
+    auto msft = exchange.addSymbol("MSFT");
+
+    exchange.submit({aapl, 100.0, 10, OrderBook::OrderType::BUY});
+    exchange.submit({msft, 99.0, 5, OrderBook::OrderType::SELL});
+    exchange.flush();
+
+    // Crossing prices on different symbols must not match each other
+    ASSERT_NE(exchange.findBook(aapl), nullptr);
+    ASSERT_NE(exchange.findBook(msft), nullptr);
+    EXPECT_EQ(exchange.findBook(aapl)->getVolumeAtPrice(100.0), 10);
+    EXPECT_EQ(exchange.findBook(msft)->getVolumeAtPrice(99.0), 5);
+}
+
+TEST_F(ExchangeTest, BatchSubmissionMatchesPerSymbol) {
+    std::vector<OrderBook::SymbolId> ids;
+    for (int i = 0; i < 16; ++i) {
+        ids.push_back(exchange.addSymbol("SYM" + std::to_string(i)));
+    }
+
+    std::vector<OrderBook::OrderRequest> batch;
+    for (auto id : ids) {
+        batch.push_back({id, 100.0, 10, OrderBook::OrderType::BUY});
+        batch.push_back({id, 99.0, 4, OrderBook::OrderType::SELL});
+    }
+    exchange.submitBatch(batch);
+    exchange.flush();
+
+    EXPECT_EQ(exchange.processedCount(), batch.size());
+    for (auto id : ids) {
+        EXPECT_EQ(exchange.findBook(id)->getVolumeAtPrice(100.0), 6);
+        EXPECT_EQ(exchange.findBook(id)->getVolumeAtPrice(99.0), 0);
+    }
+}
+
+TEST_F(ExchangeTest, ConcurrentProducersKeepTotals) {
+    auto symbol = exchange.addSymbol("AAPL");
+    const int numProducers = 4;
+    const int ordersPerProducer = 5000;  // more than the ring holds, exercises backpressure
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < numProducers; ++p) {
+        producers.emplace_back([&] {
+            for (int i = 0; i < ordersPerProducer; ++i) {
+                exchange.submit({symbol, 100.0, 1, OrderBook::OrderType::BUY});
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    exchange.flush();
+
+    EXPECT_EQ(exchange.findBook(symbol)->getVolumeAtPrice(100.0), numProducers * ordersPerProducer);
+}
+
+TEST_F(ExchangeTest, RejectsInvalidOrders) {
+    auto symbol = exchange.addSymbol("AAPL");
+
+    EXPECT_THROW(exchange.submit({symbol + 1, 100.0, 10, OrderBook::OrderType::BUY}), std::invalid_argument);
+    EXPECT_THROW(exchange.submit({symbol, 100.0, 0, OrderBook::OrderType::BUY}), std::invalid_argument);
+
+    // A bad entry rejects the whole batch
+    std::vector<OrderBook::OrderRequest> batch{
+        {symbol, 100.0, 10, OrderBook::OrderType::BUY},
+        {symbol, 100.0, -1, OrderBook::OrderType::BUY}
+    };
+    EXPECT_THROW(exchange.submitBatch(batch), std::invalid_argument);
+    exchange.flush();
+    EXPECT_EQ(exchange.findBook(symbol), nullptr);
+}
@@ -1,7 +1,12 @@
 #include <gtest/gtest.h>
 #include "OrderBook.h"
 #include "MarketData.h"
+#include "EventFile.h"
+#include <cstdio>
+#include <atomic>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 class OrderBookTest : public ::testing::Test {
 protected:
@@ -97,6 +102,301 @@ TEST_F(OrderBookTest, OrderBookSnapshot) {
     EXPECT_TRUE(foundAsk);
 }
 
+TEST_F(OrderBookTest, CancelRemovesRestingOrder) {
+    OrderBook::Order first(100.0, 5, OrderBook::OrderType::BUY);
+    OrderBook::Order second(100.0, 3, OrderBook::OrderType::BUY);
+    std::string firstId = first.getOrderId();
+    book.addOrder(std::move(first));
+    book.addOrder(std::move(second));
+
+    EXPECT_TRUE(book.cancelOrder(firstId));
+    EXPECT_FALSE(book.cancelOrder(firstId));
+    EXPECT_EQ(book.getVolumeAtPrice(100.0), 3);
+
+    // The cancelled order at the front must not trade
+    book.addOrder(OrderBook::Order(100.0, 3, OrderBook::OrderType::SELL));
+    book.matchOrders();
+    EXPECT_EQ(book.getVolumeAtPrice(100.0), 0);
+    EXPECT_THROW(book.getBestBid(), std::runtime_error);
+}
+
+TEST_F(OrderBookTest, CancellingLastOrderRemovesLevel) {
+    OrderBook::Order best(101.0, 5, OrderBook::OrderType::BUY);
+    std::string bestId = best.getOrderId();
+    book.addOrder(std::move(best));
+    book.addOrder(OrderBook::Order(100.0, 5, OrderBook::OrderType::BUY));
+
+    EXPECT_TRUE(book.cancelOrder(bestId));
+    EXPECT_EQ(book.getBestBid(), 100.0);
+}
+
+TEST_F(OrderBookTest, ModifyQuantityAndPriority) {
+    OrderBook::Order first(100.0, 5, OrderBook::OrderType::SELL);
+    OrderBook::Order second(100.0, 5, OrderBook::OrderType::SELL);
+    std::string firstId = first.getOrderId();
+    std::string secondId = second.getOrderId();
+    book.addOrder(std::move(first));
+    book.addOrder(std::move(second));
+
+    // Reduce keeps priority, increase loses it
+    EXPECT_TRUE(book.modifyOrder(firstId, 2));
+    EXPECT_EQ(book.getVolumeAtPrice(100.0), 7);
+    EXPECT_TRUE(book.modifyOrder(firstId, 8));
+    EXPECT_EQ(book.getVolumeAtPrice(100.0), 13);
+
+    book.addOrder(OrderBook::Order(100.0, 5, OrderBook::OrderType::BUY));
+    book.matchOrders();
+
+    // The second order was filled first, the amended one is intact
+    EXPECT_FALSE(book.cancelOrder(secondId));
+    EXPECT_EQ(book.getVolumeAtPrice(100.0), 8);
+    EXPECT_TRUE(book.modifyOrder(firstId, 0));
+    EXPECT_EQ(book.getVolumeAtPrice(100.0), 0);
+}
+
+TEST_F(OrderBookTest, EventFileRoundTrip) {
+    std::vector<OrderBook::OrderEvent> events{
+        {0, 10000, 50, OrderBook::EventType::ADD, static_cast<uint8_t>(OrderBook::OrderType::BUY), 0},
+        {0, 0, 20, OrderBook::EventType::MODIFY, 0, 0},
+        {0, 0, 0, OrderBook::EventType::CANCEL, 0, 0}
+    };
+    const std::string path = "event_file_roundtrip.bin";
+    OrderBook::writeEventFile(path, 0.01, events);
+
+    {
+        OrderBook::EventFile file(path);
+        ASSERT_EQ(file.size(), 3u);
+        EXPECT_DOUBLE_EQ(file.tickSize(), 0.01);
+        EXPECT_EQ(file.begin()[0].priceTicks, 10000);
+        EXPECT_EQ(file.begin()[1].type, OrderBook::EventType::MODIFY);
+        EXPECT_EQ(file.begin()[1].quantity, 20);
+    }
+    std::remove(path.c_str());
+
+    EXPECT_THROW(OrderBook::EventFile("missing_event_file.bin"), std::runtime_error);
+}
+
+TEST_F(OrderBookTest, TopOfBookL2Snapshot) {
+    book.addOrder(OrderBook::Order(100.0, 5, OrderBook::OrderType::BUY));
+    book.addOrder(OrderBook::Order(99.0, 7, OrderBook::OrderType::BUY));
+    book.addOrder(OrderBook::Order(98.0, 9, OrderBook::OrderType::BUY));
+    book.addOrder(OrderBook::Order(101.0, 3, OrderBook::OrderType::SELL));
+    book.addOrder(OrderBook::Order(102.0, 4, OrderBook::OrderType::SELL));
+
+    OrderBook::L2Snapshot<2> snapshot{};
+    book.fillSnapshot(snapshot);
+
+    // Bids best-first (descending), asks best-first (ascending), capped at depth
+    ASSERT_EQ(snapshot.bidLevels, 2u);
+    ASSERT_EQ(snapshot.askLevels, 2u);
+    EXPECT_EQ(snapshot.bidPrices[0], 100.0);
+    EXPECT_EQ(snapshot.bidVolumes[0], 5);
+    EXPECT_EQ(snapshot.bidPrices[1], 99.0);
+    EXPECT_EQ(snapshot.askPrices[0], 101.0);
+    EXPECT_EQ(snapshot.askVolumes[1], 4);
+
+    book.fillSnapshot(snapshot, 1);
+    EXPECT_EQ(snapshot.bidLevels, 1u);
+    EXPECT_EQ(snapshot.askLevels, 1u);
+}
+
+TEST_F(OrderBookTest, SnapshotSequenceTracksChanges) {
+    OrderBook::L2Snapshot<5> snapshot{};
+    book.addOrder(OrderBook::Order(100.0, 5, OrderBook::OrderType::BUY));
+    book.fillSnapshot(snapshot);
+    EXPECT_EQ(snapshot.sequence, book.getSequence());
+
+    // Nothing to match: book unchanged
+    book.matchOrders();
+    EXPECT_EQ(snapshot.sequence, book.getSequence());
+
+    book.addOrder(OrderBook::Order(99.0, 2, OrderBook::OrderType::SELL));
+    book.matchOrders();
+    EXPECT_NE(snapshot.sequence, book.getSequence());
+
+    book.fillSnapshot(snapshot);
+    EXPECT_EQ(snapshot.bidVolumes[0], 3);
+    EXPECT_EQ(snapshot.askLevels, 0u);
+}
+
+TEST_F(OrderBookTest, PublishedViewFollowsMatches) {
+    auto view = book.enablePublishing();
+    EXPECT_EQ(view->load().bidLevels, 0u);
+
+    book.addOrder(OrderBook::Order(100.0, 10, OrderBook::OrderType::BUY));
+    book.addOrder(OrderBook::Order(99.0, 4, OrderBook::OrderType::SELL));
+    book.addOrder(OrderBook::Order(101.0, 2, OrderBook::OrderType::SELL));
+
+    // Readers only see state published after matching
+    EXPECT_EQ(view->load().bidLevels, 0u);
+    book.matchOrders();
+
+    auto snapshot = view->load();
+    ASSERT_EQ(snapshot.bidLevels, 1u);
+    ASSERT_EQ(snapshot.askLevels, 1u);
+    EXPECT_EQ(snapshot.bidPrices[0], 100.0);
+    EXPECT_EQ(snapshot.bidVolumes[0], 6);
+    EXPECT_EQ(snapshot.askPrices[0], 101.0);
+    EXPECT_EQ(snapshot.sequence, book.getSequence());
+}
+
+TEST_F(OrderBookTest, PublishedViewFollowsCancelAndModify) {
+    OrderBook::Order resting(100.0, 10, OrderBook::OrderType::BUY);
+    std::string restingId = resting.getOrderId();
+    book.addOrder(std::move(resting));
+    book.addOrder(OrderBook::Order(99.0, 4, OrderBook::OrderType::BUY));
+    auto view = book.enablePublishing();
+    ASSERT_EQ(view->load().bidLevels, 2u);
+
+    // No match runs after these, yet readers must see them
+    ASSERT_TRUE(book.modifyOrder(restingId, 6));
+    auto snapshot = view->load();
+    EXPECT_EQ(snapshot.bidVolumes[0], 6);
+    EXPECT_EQ(snapshot.sequence, book.getSequence());
+
+    ASSERT_TRUE(book.cancelOrder(restingId));
+    snapshot = view->load();
+    ASSERT_EQ(snapshot.bidLevels, 1u);
+    EXPECT_EQ(snapshot.bidPrices[0], 99.0);
+    EXPECT_EQ(snapshot.bidVolumes[0], 4);
+    EXPECT_EQ(snapshot.sequence, book.getSequence());
+}
+
+TEST_F(OrderBookTest, ConcurrentReadersSeeConsistentSnapshots) {
+    auto view = book.enablePublishing();
+    std::atomic<bool> done{false};
+    std::atomic<long> reads{0};
+    std::atomic<long> inconsistencies{0};
+
+    // The writer keeps the book mirrored around 100.5: every published
+    // snapshot has bids and asks with equal level counts and volumes, so any
+    // torn read shows up as an asymmetry.
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&] {
+            uint64_t lastSequence = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                auto snapshot = view->load();
+                bool consistent = snapshot.bidLevels == snapshot.askLevels
+                    && snapshot.sequence >= lastSequence;
+                for (size_t i = 0; consistent && i < snapshot.bidLevels; ++i) {
+                    consistent = snapshot.bidVolumes[i] == snapshot.askVolumes[i]
+                        && snapshot.bidPrices[i] + snapshot.askPrices[i] == 201.0;
+                }
+                if (!consistent) {
+                    inconsistencies.fetch_add(1, std::memory_order_relaxed);
+                }
+                lastSequence = snapshot.sequence;
+                reads.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (int i = 0; i < 20000; ++i) {
+        double offset = i % 12;
+        int quantity = i % 7 + 1;
+        book.addOrder(OrderBook::Order(100.0 - offset, quantity, OrderBook::OrderType::BUY));
+        book.addOrder(OrderBook::Order(101.0 + offset, quantity, OrderBook::OrderType::SELL));
+        book.matchOrders();
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_GT(reads.load(), 0);
+    EXPECT_EQ(inconsistencies.load(), 0);
+    EXPECT_EQ(view->load().sequence, book.getSequence());
+    EXPECT_EQ(view->load().bidLevels, OrderBook::kPublishedDepth);
+}
+
+TEST_F(OrderBookTest, RollingVWAPOverLastTrades) {
+    auto now = std::chrono::system_clock::now();
+    marketData.recordTrade({"b1", "s1", 100.0, 10, now});
+    marketData.recordTrade({"b2", "s2", 102.0, 30, now});
+    marketData.recordTrade({"b3", "s3", 101.0, 10, now});
+
+    EXPECT_DOUBLE_EQ(marketData.getVWAP(1), 101.0);
+    EXPECT_DOUBLE_EQ(marketData.getVWAP(2), (102.0 * 30 + 101.0 * 10) / 40);
+    EXPECT_DOUBLE_EQ(marketData.getVWAP(100), (100.0 * 10 + 102.0 * 30 + 101.0 * 10) / 50);
+}
+
+TEST_F(OrderBookTest, RollingWindowExpiresOldTrades) {
+    OrderBook::MarketData windowed(16, std::chrono::seconds(10));
+    auto start = std::chrono::system_clock::now();
+
+    windowed.recordTrade({"b1", "s1", 105.0, 5, start});
+    windowed.recordTrade({"b2", "s2", 95.0, 7, start + std::chrono::seconds(4)});
+    windowed.recordTrade({"b3", "s3", 100.0, 3, start + std::chrono::seconds(8)});
+
+    EXPECT_EQ(windowed.getWindowVolume(), 15);
+    EXPECT_DOUBLE_EQ(windowed.getWindowHigh(), 105.0);
+    EXPECT_DOUBLE_EQ(windowed.getWindowLow(), 95.0);
+
+    // First trade falls out of the window
+    windowed.advanceTime(start + std::chrono::seconds(12));
+    EXPECT_EQ(windowed.getWindowTradeCount(), 2u);
+    EXPECT_EQ(windowed.getWindowVolume(), 10);
+    EXPECT_DOUBLE_EQ(windowed.getWindowVWAP(), (95.0 * 7 + 100.0 * 3) / 10);
+    EXPECT_DOUBLE_EQ(windowed.getWindowHigh(), 100.0);
+    EXPECT_DOUBLE_EQ(windowed.getWindowLow(), 95.0);
+
+    // Quiet market: everything expires
+    windowed.advanceTime(start + std::chrono::minutes(1));
+    EXPECT_EQ(windowed.getWindowVolume(), 0);
+    EXPECT_THROW(windowed.getWindowHigh(), std::runtime_error);
+    EXPECT_DOUBLE_EQ(windowed.getLastTradePrice(), 100.0);
+}
+
+TEST_F(OrderBookTest, TradeHistoryIsBounded) {
+    OrderBook::MarketData bounded(4, std::chrono::hours(1));
+    auto now = std::chrono::system_clock::now();
+
+    for (int i = 1; i <= 10; ++i) {
+        bounded.recordTrade({"b", "s", static_cast<double>(i), 1, now});
+    }
+
+    // Only the last four trades are retained and aggregated
+    EXPECT_EQ(bounded.size(), 4u);
+    EXPECT_EQ(bounded.getRecentTrades(100).size(), 4u);
+    EXPECT_EQ(bounded.getRecentTrades(100).front().price, 7.0);
+    EXPECT_EQ(bounded.getWindowVolume(), 4);
+    EXPECT_DOUBLE_EQ(bounded.getVWAP(100), (7.0 + 8.0 + 9.0 + 10.0) / 4);
+    EXPECT_DOUBLE_EQ(bounded.getWindowLow(), 7.0);
+    EXPECT_DOUBLE_EQ(bounded.getWindowHigh(), 10.0);
+}
+
+TEST_F(OrderBookTest, WindowOverflowIsReported) {
+    OrderBook::MarketData small(8, std::chrono::seconds(10));
+    auto start = std::chrono::system_clock::now();
+
+    // Twenty trades inside one ten second window, but only eight fit
+    for (int i = 1; i <= 20; ++i) {
+        small.recordTrade({"b", "s", static_cast<double>(i), 1, start + std::chrono::milliseconds(i)});
+    }
+    EXPECT_EQ(small.getWindowTradeCount(), 8u);
+    EXPECT_EQ(small.getWindowVolume(), 8);
+    EXPECT_DOUBLE_EQ(small.getWindowLow(), 13.0);
+    EXPECT_TRUE(small.isWindowTruncated());
+    EXPECT_EQ(small.getWindowOverflowCount(), 12u);
+
+    // Once the overwritten trades would have aged out anyway, the window is whole again
+    small.advanceTime(start + std::chrono::seconds(11));
+    EXPECT_FALSE(small.isWindowTruncated());
+    EXPECT_EQ(small.getWindowOverflowCount(), 12u);
+
+    // A ring sized for the peak rate keeps the whole window
+    OrderBook::MarketData sized(OrderBook::MarketData::capacityFor(std::chrono::seconds(10), 2.0),
+                                std::chrono::seconds(10));
+    for (int i = 0; i < 20; ++i) {
+        sized.recordTrade({"b", "s", static_cast<double>(i + 1), 1, start + std::chrono::milliseconds(500 * i)});
+    }
+    EXPECT_EQ(sized.getWindowTradeCount(), 20u);
+    EXPECT_EQ(sized.getWindowVolume(), 20);
+    EXPECT_DOUBLE_EQ(sized.getWindowLow(), 1.0);
+    EXPECT_FALSE(sized.isWindowTruncated());
+}
+
 int main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,160 @@
+#include "../include/WebpageCounter.h"
+#include "../include/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Every thread increments the same page; returns increments per second
+double hammerOnePage(const Config& config, size_t numThreads, size_t incrementsPerThread,
+                     std::shared_ptr<ILogger> logger = Logger::getInstance()) {
+    WebpageCounter counter(1, std::move(logger), config);
+
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&counter, incrementsPerThread]() {
+            for (size_t j = 0; j < incrementsPerThread; ++j) {
+                counter.incrementVisitCount(0);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t expected = numThreads * incrementsPerThread;
+    if (counter.getVisitCount(0) != expected) {
+        std::cerr << "Lost increments: expected " << expected << ", got " << counter.getVisitCount(0) << std::endl;
+    }
+    return expected / elapsed;
+}
+
+// Seconds taken by body()
+template<typename Body>
+double timeIt(Body body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    size_t incrementsPerThread = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+    size_t maxThreads = argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+                                 : std::max(4u, std::thread::hardware_concurrency());
+
+    Config mutexConfig;
+    mutexConfig.enableLogging = false;
+    Config atomicConfig = mutexConfig;
+    atomicConfig.useAtomicOperations = true;
+    Config stripedConfig = mutexConfig;
+    stripedConfig.useStripedCounters = true;
+
+    std::cout << "Single hot page, " << incrementsPerThread << " increments per thread ("
+              << std::thread::hardware_concurrency() << " hardware threads)\n";
+    std::cout << "threads      mutex (ops/s)     atomic (ops/s)    striped (ops/s)\n";
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        double mutexRate = hammerOnePage(mutexConfig, threads, incrementsPerThread);
+        double atomicRate = hammerOnePage(atomicConfig, threads, incrementsPerThread);
+        double stripedRate = hammerOnePage(stripedConfig, threads, incrementsPerThread);
+        std::cout << std::setw(7) << threads << std::fixed << std::setprecision(0)
+                  << std::setw(19) << mutexRate << std::setw(19) << atomicRate
+                  << std::setw(19) << stripedRate << std::endl;
+    }
+
+    // Logging on versus off, with the asynchronous logger staging every increment
+    atomicConfig.enableLogging = true;
+    auto logger = Logger::create("counter_benchmark.log");
+    std::cout << "\nAtomic mode with logging (file: counter_benchmark.log)\n";
+    std::cout << "threads    logging off (ops/s)  logging on (ops/s)   slowdown\n";
+    Config quietConfig = atomicConfig;
+    quietConfig.enableLogging = false;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        double offRate = hammerOnePage(quietConfig, threads, incrementsPerThread, logger);
+        double onRate = hammerOnePage(atomicConfig, threads, incrementsPerThread, logger);
+        logger->flush();  // include the writer's work before the next row
+        std::cout << std::setw(7) << threads << std::fixed << std::setprecision(0)
+                  << std::setw(22) << offRate << std::setw(20) << onRate
+                  << std::setw(10) << std::setprecision(2) << offRate / onRate << "x" << std::endl;
+    }
+
+    // Overlapping batches with duplicates, drawn from a small hot set of pages
+    std::cout << "\nBatches over 1000 hot pages, " << incrementsPerThread << " increments per thread (Mops/s)\n";
+    std::cout << "batch size  threads      mutex     atomic    striped\n";
+    for (size_t batchSize : {16, 1024, 65536}) {
+        std::vector<size_t> batch(batchSize);
+        std::mt19937_64 generator(batchSize);
+        for (auto& page : batch) {
+            page = generator() % 1000;
+        }
+        size_t batchesPerThread = std::max<size_t>(1, incrementsPerThread / batchSize);
+        for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+            std::vector<double> rates;
+            for (const Config* config : {&mutexConfig, &quietConfig, &stripedConfig}) {
+                WebpageCounter counter(1000, logger, *config);
+                double seconds = timeIt([&] {
+                    std::vector<std::thread> workers;
+                    for (size_t t = 0; t < threads; ++t) {
+                        workers.emplace_back([&counter, &batch, batchesPerThread]() {
+                            for (size_t i = 0; i < batchesPerThread; ++i) {
+                                counter.batchIncrement(batch);
+                            }
+                        });
+                    }
+                    for (auto& worker : workers) {
+                        worker.join();
+                    }
+                });
+                rates.push_back(threads * batchesPerThread * batchSize / seconds / 1e6);
+            }
+            std::cout << std::setw(10) << batchSize << std::setw(9) << threads << std::setprecision(1);
+            for (double rate : rates) {
+                std::cout << std::setw(11) << rate;
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    // Construction cost with many pages, in memory and in a counter file
+    const size_t manyPages = 10'000'000;
+    const std::string countsPath = "counter_benchmark_counts.bin";
+    const std::string checkpointPath = "counter_benchmark_checkpoint.bin";
+    std::remove(countsPath.c_str());
+    Config fileConfig = quietConfig;
+    fileConfig.counterFilePath = countsPath;
+
+    std::cout << "\nStartup with " << manyPages << " pages (ms)\n";
+    std::cout << std::fixed << std::setprecision(1);
+    double memoryAtomic = timeIt([&] { WebpageCounter counter(manyPages, logger, quietConfig); });
+    double memoryMutex = timeIt([&] { WebpageCounter counter(manyPages, logger, mutexConfig); });
+    double fileCreate = timeIt([&] { WebpageCounter counter(manyPages, logger, fileConfig); });
+    double fileReopen = 0;
+    double checkpoint = 0;
+    {
+        WebpageCounter counter(manyPages, logger, fileConfig);
+        for (size_t page = 0; page < manyPages; page += 7) {
+            counter.incrementVisitCount(page);
+        }
+        checkpoint = timeIt([&] { counter.checkpoint(checkpointPath); });
+    }
+    fileReopen = timeIt([&] {
+        WebpageCounter counter(manyPages, logger, fileConfig);
+        if (counter.getVisitCount(manyPages - 1 - (manyPages - 1) % 7) != 1) {
+            std::cerr << "Counter file lost its counts" << std::endl;
+        }
+    });
+    std::cout << "in memory, atomic      " << std::setw(8) << memoryAtomic * 1e3 << "\n"
+              << "in memory, mutex       " << std::setw(8) << memoryMutex * 1e3 << "\n"
+              << "counter file, new      " << std::setw(8) << fileCreate * 1e3 << "\n"
+              << "counter file, reopen   " << std::setw(8) << fileReopen * 1e3 << "\n"
+              << "checkpoint (80 MB)     " << std::setw(8) << checkpoint * 1e3 << std::endl;
+    std::remove(countsPath.c_str());
+    std::remove(checkpointPath.c_str());
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "../include/ConcurrentCounterMap.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct PhaseResult {
+    double opsPerSecond = 0;
+    double maxOpMicros = 0;   // slowest single operation on any thread
+};
+
+// Runs body(thread, i) for i in [0, opsPerThread) on every thread, timing each call
+template<typename Body>
+PhaseResult runPhase(size_t numThreads, size_t opsPerThread, Body body) {
+    std::vector<double> maxMicros(numThreads, 0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            double slowest = 0;
+            for (size_t i = 0; i < opsPerThread; ++i) {
+                auto before = std::chrono::steady_clock::now();
+                body(t, i);
+                double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - before).count();
+                slowest = std::max(slowest, micros);
+            }
+            maxMicros[t] = slowest;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    PhaseResult result;
+    result.opsPerSecond = numThreads * opsPerThread / elapsed;
+    result.maxOpMicros = *std::max_element(maxMicros.begin(), maxMicros.end());
+    return result;
+}
+
+void report(const char* phase, const PhaseResult& result) {
+    std::cout << std::left << std::setw(28) << phase << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << result.opsPerSecond / 1e6 << " Mops/s"
+              << std::setw(14) << result.maxOpMicros << " us max" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    size_t numKeys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+    size_t numThreads = argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+                                 : std::max(1u, std::thread::hardware_concurrency());
+    size_t keysPerThread = numKeys / numThreads;
+    numKeys = keysPerThread * numThreads;
+
+    std::cout << numKeys << " keys, " << numThreads << " threads, starting from "
+              << ConcurrentCounterMap::MIN_CAPACITY << " slots" << std::endl;
+
+    ConcurrentCounterMap map;
+
+    // Every key is new, so the table doubles its way up from the minimum size
+    report("insert (grows the table)", runPhase(numThreads, keysPerThread, [&](size_t t, size_t i) {
+        map.add(t * keysPerThread + i + 1);
+    }));
+
+    std::vector<std::mt19937_64> generators;
+    for (size_t t = 0; t < numThreads; ++t) {
+        generators.emplace_back(t + 1);
+    }
+    report("increment existing keys", runPhase(numThreads, keysPerThread, [&](size_t t, size_t) {
+        map.add(generators[t]() % numKeys + 1);
+    }));
+
+    std::vector<uint64_t> sums(numThreads, 0);
+    report("read random keys", runPhase(numThreads, keysPerThread, [&](size_t t, size_t) {
+        sums[t] += map.get(generators[t]() % numKeys + 1);
+    }));
+
+    uint64_t total = 0;
+    for (size_t key = 1; key <= numKeys; ++key) {
+        total += map.get(key);
+    }
+    if (total != 2 * numKeys || map.size() != numKeys) {
+        std::cerr << "Count mismatch: expected " << 2 * numKeys << " visits over " << numKeys
+                  << " keys, got " << total << " over " << map.size() << std::endl;
+        return 1;
+    }
+
+    std::cout << "capacity " << map.capacity() << " slots, "
+              << std::setprecision(1) << static_cast<double>(map.memoryBytes()) / map.size()
+              << " bytes per key (16-byte slots, load " << std::setprecision(2)
+              << static_cast<double>(map.size()) / map.capacity() << ")" << std::endl;
+    return 0;
+}
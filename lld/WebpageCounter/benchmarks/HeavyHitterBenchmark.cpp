@@ -0,0 +1,96 @@
+#include "../include/HeavyHitterSketch.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Zipf(s = 1.1) page ids over a large id space, drawn by inverting the CDF
+std::vector<uint64_t> zipfStream(size_t length, size_t distinct, uint64_t seed) {
+    std::vector<double> cdf(distinct);
+    double total = 0;
+    for (size_t i = 0; i < distinct; ++i) {
+        total += 1.0 / std::pow(static_cast<double>(i + 1), 1.1);
+        cdf[i] = total;
+    }
+    std::mt19937_64 generator(seed);
+    std::uniform_real_distribution<double> uniform(0, total);
+    std::vector<uint64_t> stream(length);
+    for (auto& key : stream) {
+        key = static_cast<uint64_t>(std::lower_bound(cdf.begin(), cdf.end(), uniform(generator)) - cdf.begin());
+    }
+    return stream;
+}
+
+int main(int argc, char** argv) {
+    size_t visits = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+    size_t numThreads = argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+                                 : std::max(1u, std::thread::hardware_concurrency());
+    const size_t distinct = 1'000'000;
+    const size_t k = 10;
+
+    std::cout << visits << " Zipf visits over " << distinct << " pages, " << numThreads << " threads" << std::endl;
+    std::vector<std::vector<uint64_t>> streams;
+    for (size_t t = 0; t < numThreads; ++t) {
+        streams.push_back(zipfStream(visits / numThreads, distinct, t + 1));
+    }
+
+    HeavyHitterSketch sketch;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&sketch, &streams, t]() {
+            for (uint64_t key : streams[t]) {
+                sketch.add(key);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double addSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const int queries = 1000;
+    start = std::chrono::steady_clock::now();
+    std::vector<HeavyHitterSketch::Entry> top;
+    for (int i = 0; i < queries; ++i) {
+        top = sketch.topK(k);
+    }
+    double topMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / queries;
+
+    // Exact counts for comparison
+    std::unordered_map<uint64_t, uint64_t> exact;
+    for (const auto& stream : streams) {
+        for (uint64_t key : stream) {
+            ++exact[key];
+        }
+    }
+    std::vector<std::pair<uint64_t, uint64_t>> exactTop(exact.begin(), exact.end());
+    std::partial_sort(exactTop.begin(), exactTop.begin() + k, exactTop.end(), [](const auto& x, const auto& y) {
+        return x.second > y.second;
+    });
+
+    size_t recalled = 0;
+    double worstError = 0;
+    for (const auto& entry : top) {
+        for (size_t i = 0; i < k; ++i) {
+            recalled += exactTop[i].first == entry.key;
+        }
+        worstError = std::max(worstError, static_cast<double>(entry.count - exact[entry.key]) / exact[entry.key]);
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "add:   " << std::setw(8) << visits / addSeconds / 1e6 << " Mops/s" << std::endl
+              << "topK:  " << std::setw(8) << topMicros << " us for k = " << k << std::endl
+              << "recall " << recalled << "/" << k << ", worst overcount " << std::setprecision(3)
+              << worstError * 100 << "%" << std::endl
+              << "sketch " << sketch.memoryBytes() / 1024 << " KiB fixed (" << sketch.shardCount()
+              << " shards), exact map held " << exact.size() << " keys" << std::endl;
+    return recalled == k ? 0 : 1;
+}
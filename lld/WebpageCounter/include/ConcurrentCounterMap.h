@@ -0,0 +1,96 @@
+#ifndef CONCURRENT_COUNTER_MAP_H
+#define CONCURRENT_COUNTER_MAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include "StripedCounter.h"
+
+// Growable hash map from 64-bit keys to counters, for tracking an open-ended
+// set of pages. Only the key is stored: callers keying by a hash (keyFor)
+// get one shared counter for colliding inputs.
+//
+// Entries are 16-byte {key, count} slots in an open-addressing table with
+// linear probing. When a table reaches 3/4 load, a table twice the size is
+// linked behind it. Writers then copy the old table over in 4096-slot chunks,
+// one chunk per increment, so no thread ever stops the world. Reads never
+// write to the table or wait.
+//
+// Copying a slot freezes its count first, so increments racing with a copy are
+// redirected to the new table instead of being lost. A slot in a newer table
+// stays "unsettled" until any frozen count for the same key has been added in,
+// and readers fill the gap from the older table meanwhile. Old tables are freed
+// once every operation that could still see them has finished.
+class ConcurrentCounterMap {
+public:
+    static constexpr uint64_t EMPTY_KEY = 0;            // reserved
+    static constexpr uint64_t SEALED_KEY = UINT64_MAX;  // reserved
+    static constexpr size_t MIN_CAPACITY = 1024;
+
+    explicit ConcurrentCounterMap(size_t initialCapacity = MIN_CAPACITY);
+    ~ConcurrentCounterMap();
+
+    ConcurrentCounterMap(const ConcurrentCounterMap&) = delete;
+    ConcurrentCounterMap& operator=(const ConcurrentCounterMap&) = delete;
+    ConcurrentCounterMap(ConcurrentCounterMap&&) = delete;
+    ConcurrentCounterMap& operator=(ConcurrentCounterMap&&) = delete;
+
+    // Adds delta to the key's counter, creating it at zero first. The two
+    // reserved keys are rejected with std::invalid_argument.
+    void add(uint64_t key, uint64_t delta = 1);
+
+    // Zero for keys that were never added
+    uint64_t get(uint64_t key) const;
+
+    // Drops every key. Increments racing with clear may be lost.
+    void clear();
+
+    size_t size() const { return keyCount.sum(0); }  // distinct keys
+    size_t capacity() const;                          // slots in the newest table
+    size_t memoryBytes() const;                       // slot storage of all linked tables
+
+    // 64-bit key for a URL. Distinct URLs collide with probability about
+    // n^2 / 2^65 for n URLs, and colliding URLs are counted together.
+    static uint64_t keyFor(std::string_view url);
+
+private:
+    struct Slot;
+    struct Table;
+
+    struct alignas(StripedCounterArray::CACHE_LINE_SIZE) ActiveStripe {
+        std::atomic<size_t> active[2];
+    };
+
+    class Guard;
+
+    Slot& locate(Table*& table, uint64_t key, bool& viaMoved);
+    static bool applyDelta(Slot& slot, uint64_t delta, bool settle);
+    Table* grow(Table* table);
+    void helpMigrate(Table* table);
+    void migrateSlot(Table* table, Slot& slot);
+    void retire(Table* table, bool withSuccessors) const;
+    void tryReclaim() const;
+    bool drained(uint64_t parity) const;
+    static void destroy(Table* table);
+
+    const size_t initialCapacity;
+    std::atomic<Table*> head;            // oldest linked table; only it is ever copied out
+    StripedCounterArray keyCount;
+
+    // Reclamation: operations register in their stripe under the epoch's
+    // parity, and an unlinked table is freed after two epoch flips have each
+    // seen the older parity drain
+    std::unique_ptr<ActiveStripe[]> activeStripes;
+    size_t activeMask;
+    mutable std::atomic<uint64_t> epoch{0};
+    mutable std::atomic<Table*> retired{nullptr};
+    mutable std::atomic<bool> reclaimPending{false};
+    mutable std::atomic<bool> reclaiming{false};
+    mutable Table* graceBatch = nullptr;  // owned by whoever holds reclaiming
+    mutable int gracePhase = 0;
+    mutable uint64_t graceParity = 0;
+};
+
+#endif // CONCURRENT_COUNTER_MAP_H
@@ -0,0 +1,50 @@
+#ifndef COUNTER_FILE_H
+#define COUNTER_FILE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Array of counters living in a memory-mapped file (POSIX). Increments are
+// plain atomic operations on the shared mapping, so the kernel owns the data:
+// it survives a crash of the process, and reopening the file is a single
+// mmap however many counters it holds. syncToDisk() also makes it survive a
+// crash of the machine.
+//
+// Layout: a 64-byte header, then one 8-byte counter per slot.
+class CounterFile {
+public:
+    // Opens the file, or creates it with every counter zero. A file holding
+    // fewer counters is extended; one holding more is rejected.
+    CounterFile(const std::string& path, size_t counters);
+    ~CounterFile();
+
+    CounterFile(const CounterFile&) = delete;
+    CounterFile& operator=(const CounterFile&) = delete;
+    CounterFile(CounterFile&&) = delete;
+    CounterFile& operator=(CounterFile&&) = delete;
+
+    std::atomic<size_t>* counters() const { return slots; }
+    size_t size() const { return count; }
+
+    // Blocks until the counters written so far are on disk
+    void syncToDisk() const;
+
+    // Writes a copy of the counters to path, readable as a CounterFile.
+    // Writers keep running: every increment finished before the call is in
+    // the copy, no counter is torn, and later increments may or may not be.
+    // The copy is written beside path and renamed over it, so a crash leaves
+    // either the previous checkpoint or the new one.
+    void checkpoint(const std::string& path) const;
+
+private:
+    std::string path;
+    int fd;
+    void* mapping;
+    size_t mappedBytes;
+    size_t count;
+    std::atomic<size_t>* slots;
+};
+
+#endif // COUNTER_FILE_H
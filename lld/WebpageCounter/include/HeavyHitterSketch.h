@@ -0,0 +1,92 @@
+#ifndef HEAVY_HITTER_SKETCH_H
+#define HEAVY_HITTER_SKETCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct HeavyHitterOptions {
+    size_t width = 4096;      // counters per sketch row, rounded up to a power of two
+    size_t depth = 4;         // sketch rows; each adds one independent hash
+    size_t candidates = 128;  // heavy-hitter candidates kept per shard
+    size_t shards = 0;        // 0 means one per hardware thread; rounded up to a power of two
+};
+
+// Approximate per-key counts in fixed memory, plus the most frequent keys.
+//
+// Each shard is a Count-Min sketch with conservative update and a min-heap of
+// the keys with the highest estimates in that shard (Space-Saving style: a key
+// replaces the smallest candidate once its estimate passes it). Threads write
+// to their own shard; queries add the shards' estimates together.
+//
+// Estimates never undercount. With N total increments, an estimate exceeds the
+// true count by more than e*N/width with probability at most e^-depth.
+//
+// topK only ranks keys that are a candidate in some shard, so it can miss a
+// key spread thinly over many shards. It is guaranteed (with the same
+// probability) to consider every key whose true total exceeds
+// N/candidates + e*N/width.
+class HeavyHitterSketch {
+public:
+    static constexpr size_t MAX_DEPTH = 16;
+
+    struct Entry {
+        uint64_t key;
+        uint64_t count;      // estimated
+        std::string label;   // whatever was passed with the key, e.g. the URL
+    };
+
+    explicit HeavyHitterSketch(const HeavyHitterOptions& options = HeavyHitterOptions{});
+
+    HeavyHitterSketch(const HeavyHitterSketch&) = delete;
+    HeavyHitterSketch& operator=(const HeavyHitterSketch&) = delete;
+    HeavyHitterSketch(HeavyHitterSketch&&) = delete;
+    HeavyHitterSketch& operator=(HeavyHitterSketch&&) = delete;
+
+    // label is only copied when the key becomes a candidate
+    void add(uint64_t key, uint64_t delta = 1, std::string_view label = {});
+    uint64_t estimate(uint64_t key) const;
+
+    // Up to k keys with the highest estimates, highest first. The shards'
+    // candidate counts are merged first, and only keys whose merged bounds
+    // can still reach the top k are estimated from the sketch.
+    std::vector<Entry> topK(size_t k) const;
+
+    // Increments racing with clear may survive it
+    void clear();
+
+    size_t shardCount() const { return shards.size(); }
+    // Fixed footprint, not counting candidate labels
+    size_t memoryBytes() const;
+
+private:
+    struct Candidate {
+        uint64_t count;
+        uint64_t key;
+        std::string label;
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;  // uncontended unless threads outnumber shards, or a query is copying candidates
+        std::unique_ptr<std::atomic<uint64_t>[]> counters;  // depth rows of width; read without the lock
+        std::vector<Candidate> heap;                         // min-heap on count
+        std::vector<uint64_t> heapKeys;                      // heap[i].key, kept dense for scanning
+    };
+
+    void rowSlots(uint64_t key, size_t* slots) const;
+    uint64_t shardEstimate(const Shard& shard, const size_t* slots) const;
+    void offerCandidate(Shard& shard, uint64_t key, uint64_t count, std::string_view label);
+    void siftDown(Shard& shard, size_t index);
+
+    size_t widthMask;
+    size_t depth;
+    size_t maxCandidates;
+    std::vector<std::unique_ptr<Shard>> shards;
+};
+
+#endif // HEAVY_HITTER_SKETCH_H
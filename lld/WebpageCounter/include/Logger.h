@@ -1,34 +1,99 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
-#include <string>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
 #include <memory>
 #include <mutex>
-#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Structured log messages. Callers pass the numbers and text, and the text
+// is only built when the message is written out.
+enum class LogEvent : uint32_t {
+    Text,                   // text
+    CounterInitialized,     // a = pages
+    PageIncremented,        // a = page
+    PagesBatchIncremented,  // a = pages
+    PageQueried,            // a = page, b = count
+    UrlIncremented,         // text = url
+    UrlQueried,             // b = count, text = url
+    CountersReset,
+};
+
+// Appends the text of one message, without a newline
+void formatLogEvent(std::string& out, LogEvent event, uint64_t a, uint64_t b, std::string_view text);
 
 // Logger interface
 class ILogger {
 public:
     virtual void log(const std::string& message) = 0;
+    // Loggers that can defer formatting override this; by default the
+    // message is formatted here and passed to log()
+    virtual void logEvent(LogEvent event, uint64_t a = 0, uint64_t b = 0, std::string_view text = {});
     virtual ~ILogger() = default;
 };
 
-// Concrete Logger implementation
+struct LoggerOptions {
+    size_t threadBufferBytes = 1 << 20;          // staging ring per logging thread
+    bool dropWhenFull = false;                   // drop (and count) instead of waiting for the writer
+    std::chrono::milliseconds idleWait{2};       // writer sleep when every ring is empty
+};
+
+// Asynchronous file logger. Each logging thread appends fixed binary records
+// to its own single-producer ring, with no lock or syscall on that path. A
+// background thread drains all rings, formats the records, and writes each
+// pass to the file in one buffered write. Messages from one thread keep
+// their order; messages from different threads are interleaved per pass.
 class Logger : public ILogger {
 private:
-    inline static std::shared_ptr<Logger> instance = nullptr;
-    inline static std::ofstream logFile;
-    inline static std::mutex logMutex;
+    struct ThreadBuffer;
+    struct BufferNode;
 
-    Logger() = default;
+    explicit Logger(const std::string& path, const LoggerOptions& options);
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
     Logger(Logger&&) = delete;
     Logger& operator=(Logger&&) = delete;
-    
+
+    ThreadBuffer& localBuffer();
+    std::shared_ptr<ThreadBuffer> acquireBuffer();
+    void requestDrain();
+    void writerLoop();
+    bool drain(std::string& out);
+
+    const uint64_t id;
+    const LoggerOptions options;
+    std::ofstream logFile;
+    std::atomic<BufferNode*> buffers{nullptr};
+    std::atomic<uint64_t> flushRequests{0};
+    std::atomic<uint64_t> flushesDone{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> drainRequested{false};  // a producer found its ring full
+    std::mutex writerMutex;                 // only for the writer's sleep and flush()
+    std::condition_variable writerWake;
+    std::condition_variable flushDone;
+    std::thread writer;
+
 public:
+    ~Logger() override;
+
+    // Process-wide logger writing to log.txt
     static std::shared_ptr<Logger> getInstance();
+    static std::shared_ptr<Logger> create(const std::string& path, const LoggerOptions& options = LoggerOptions{});
+
     void log(const std::string& message) override;
+    void logEvent(LogEvent event, uint64_t a = 0, uint64_t b = 0, std::string_view text = {}) override;
+
+    // Blocks until everything logged before the call is in the file
+    void flush();
+    uint64_t droppedMessages() const;
+    // Staging rings allocated so far; at most one per thread logging concurrently
+    size_t ringCount() const;
 };
 
-#endif // LOGGER_H 
\ No newline at end of file
+#endif // LOGGER_H
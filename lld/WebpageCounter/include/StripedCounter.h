@@ -0,0 +1,61 @@
+#ifndef STRIPED_COUNTER_H
+#define STRIPED_COUNTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Small dense number for the calling thread, assigned the first time a thread
+// asks; used to spread threads over stripes
+size_t currentThreadOrdinal();
+
+// Array of counters split into per-thread stripes. Every stripe holds one slot
+// per counter in its own run of cache lines, so threads bumping the same (or a
+// neighbouring) counter write to different lines. Reads add up all stripes.
+// No path takes a lock.
+class StripedCounterArray {
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // stripes == 0 uses one stripe per hardware thread; always rounded up to a power of two
+    explicit StripedCounterArray(size_t size, size_t stripes = 0);
+
+    StripedCounterArray(const StripedCounterArray&) = delete;
+    StripedCounterArray& operator=(const StripedCounterArray&) = delete;
+    StripedCounterArray(StripedCounterArray&&) = delete;
+    StripedCounterArray& operator=(StripedCounterArray&&) = delete;
+
+    void add(size_t index, size_t delta = 1) {
+        // Relaxed RMW: a stripe is only shared when there are more threads than stripes
+        slot(currentStripe(), index).fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    // Not a snapshot: increments racing with the read may or may not be included
+    size_t sum(size_t index) const;
+
+    // Zeroes every stripe; increments racing with reset may survive it
+    void reset();
+
+    size_t size() const { return count; }
+    size_t stripeCount() const { return stripeMask + 1; }
+
+private:
+    static constexpr size_t SLOTS_PER_LINE = CACHE_LINE_SIZE / sizeof(std::atomic<size_t>);
+
+    struct alignas(CACHE_LINE_SIZE) CacheLine {
+        std::atomic<size_t> slots[SLOTS_PER_LINE];
+    };
+
+    size_t currentStripe() const;
+
+    std::atomic<size_t>& slot(size_t stripe, size_t index) const {
+        return lines[stripe * linesPerStripe + index / SLOTS_PER_LINE].slots[index % SLOTS_PER_LINE];
+    }
+
+    size_t count;
+    size_t stripeMask;
+    size_t linesPerStripe;
+    std::unique_ptr<CacheLine[]> lines;
+};
+
+#endif // STRIPED_COUNTER_H
@@ -1,11 +1,20 @@
 #ifndef WEBPAGE_COUNTER_H
 #define WEBPAGE_COUNTER_H
 
-#include <array>
 #include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
+#include "ConcurrentCounterMap.h"
+#include "CounterFile.h"
+#include "HeavyHitterSketch.h"
+#include "StripedCounter.h"
+#include "WindowedCounter.h"
 
 // Forward declarations
 class ILogger;
@@ -14,7 +23,23 @@ class ILogger;
 struct Config {
     bool enableLogging = true;
     bool useAtomicOperations = false;
+    // Per-thread striped counters summed on read; takes precedence over
+    // useAtomicOperations. The counts themselves take no lock, but
+    // trackHeavyHitters still takes a per-thread sketch shard mutex per hit.
+    bool useStripedCounters = false;
+    size_t counterStripes = 0;  // 0 means one stripe per hardware thread
     size_t maxPages = 1000;
+    // Approximate per-page and per-URL counts in fixed memory, for topPages/topUrls
+    bool trackHeavyHitters = false;
+    // URL counts come from the sketch alone and the exact map stays empty;
+    // implies trackHeavyHitters
+    bool approximateUrlCounts = false;
+    HeavyHitterOptions heavyHitters;
+    // Per-page counts over the last minute, hour and day (1152 bytes per page)
+    bool trackWindowedCounts = false;
+    // Page counts live in this memory-mapped file and survive restarts and
+    // crashes; empty keeps them in memory. Not available with striped counters.
+    std::string counterFilePath;
 };
 
 // Metrics structure
@@ -31,21 +56,64 @@ struct Metrics {
 // WebpageCounter class declaration
 class WebpageCounter {
 private:
-    static constexpr size_t MAX_PAGES = 1000;
-    std::array<std::atomic<size_t>, MAX_PAGES> visitCounts;
-    std::array<std::unique_ptr<std::mutex>, MAX_PAGES> mutexes;
+    static constexpr size_t MAX_PAGE_LOCKS = 1024;
+    static constexpr size_t DENSE_TALLY_PAGES = 1 << 16;  // per-thread batch tally kept between batches up to this many pages
+
+    struct FreeDeleter {
+        void operator()(void* memory) const { std::free(memory); }
+    };
+
+    std::atomic<size_t>* visitCounts = nullptr;              // totalPages counters in memory or in counterFile; unused in striped mode
+    std::unique_ptr<std::atomic<size_t>[], FreeDeleter> ownedCounts;  // backs visitCounts without a counter file
+    std::unique_ptr<CounterFile> counterFile;                // backs visitCounts with Config::counterFilePath
+    std::unique_ptr<std::mutex[]> pageLocks;                 // page i uses pageLocks[i % numPageLocks]; unused in striped mode
+    size_t numPageLocks = 0;
+    std::unique_ptr<StripedCounterArray> stripedCounts;      // striped mode only
+    std::unique_ptr<StripedCounterArray> stripedIncrements;  // striped mode only, backs metrics.totalIncrements
+    ConcurrentCounterMap urlCounts;                          // pages tracked by URL, grows as needed
+    std::unique_ptr<HeavyHitterSketch> pageHitters;          // heavy-hitter tracking only
+    std::unique_ptr<HeavyHitterSketch> urlHitters;           // heavy-hitter tracking only
+    std::unique_ptr<WindowedCounterArray> windowedCounts;    // windowed tracking only
     std::shared_ptr<ILogger> logger;
     size_t totalPages;
     mutable Metrics metrics;
     Config config;
+    std::chrono::steady_clock::time_point startTime;         // origin for windowed counts
+
+    uint64_t secondsSinceStart() const;
+    std::mutex& lockFor(size_t pageIndex) const { return pageLocks[pageIndex % numPageLocks]; }
+    // Distinct pages of a valid batch with how often each appears
+    void aggregateVisits(const std::vector<size_t>& indices, std::vector<std::pair<size_t, size_t>>& visits) const;
 
 public:
     WebpageCounter(size_t totalPages, std::shared_ptr<ILogger> logger, const Config& config = Config{});
     void incrementVisitCount(size_t pageIndex);
+    // Pages listed more than once are counted once per listing. Never fails
+    // because of other threads; an invalid index rejects the whole batch.
     void batchIncrement(const std::vector<size_t>& indices);
     size_t getVisitCount(size_t pageIndex) const;
+    // Needs Config::trackWindowedCounts; reads one ring of buckets
+    size_t getWindowedVisitCount(size_t pageIndex, TimeWindow window) const;
+    double getVisitRate(size_t pageIndex, TimeWindow window) const;  // visits per second
+    // Pages identified by URL instead of index; any number of URLs can be
+    // tracked. Counts are keyed by a 64-bit hash of the URL and URLs are not
+    // stored, so two URLs whose hashes collide (probability about n^2 / 2^65
+    // for n URLs) share one counter.
+    void incrementUrlVisitCount(std::string_view url);
+    size_t getUrlVisitCount(std::string_view url) const;
+    size_t getTrackedUrlCount() const;
+    // Most visited pages and URLs with estimated counts, highest first.
+    // Needs Config::trackHeavyHitters; cost depends on the sketch size only.
+    std::vector<std::pair<size_t, size_t>> topPages(size_t k) const;
+    std::vector<std::pair<std::string, size_t>> topUrls(size_t k) const;
     Metrics getMetrics() const;
     void reset();
+
+    // Need Config::counterFilePath. syncToDisk() blocks until the page counts
+    // are on disk; checkpoint() copies them to another counter file while
+    // writers keep running (see CounterFile::checkpoint).
+    void syncToDisk() const;
+    void checkpoint(const std::string& path) const;
 };
 
 #endif // WEBPAGE_COUNTER_H 
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef WINDOWED_COUNTER_H
+#define WINDOWED_COUNTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+enum class TimeWindow {
+    Minute,  // 60 one-second buckets
+    Hour,    // 60 one-minute buckets
+    Day,     // 24 one-hour buckets
+};
+
+// Per-counter visit counts over the last minute, hour and day, kept in rings
+// of time buckets. Each bucket word packs the bucket's time slot with its
+// count, so a bucket left over from an earlier pass round the ring is
+// recognised and restarted by the next increment that lands on it. Nothing
+// sweeps the rings in the background, and a query reads one ring.
+//
+// Times are whole seconds since a caller-chosen origin (WebpageCounter uses
+// its construction time) and must not go backwards by more than a bucket.
+class WindowedCounterArray {
+public:
+    explicit WindowedCounterArray(size_t size);
+
+    WindowedCounterArray(const WindowedCounterArray&) = delete;
+    WindowedCounterArray& operator=(const WindowedCounterArray&) = delete;
+    WindowedCounterArray(WindowedCounterArray&&) = delete;
+    WindowedCounterArray& operator=(WindowedCounterArray&&) = delete;
+
+    void add(size_t index, uint64_t nowSeconds, uint64_t delta = 1);
+
+    // Visits in the current bucket and the ones before it that fit the window
+    uint64_t count(size_t index, TimeWindow window, uint64_t nowSeconds) const;
+
+    // Visits per second over the time the window's buckets actually cover,
+    // which is shorter than the window until that much time has passed
+    double rate(size_t index, TimeWindow window, uint64_t nowSeconds) const;
+
+    // Increments racing with reset may survive it
+    void reset();
+
+    size_t size() const { return numCounters; }
+    static uint64_t windowSeconds(TimeWindow window);
+
+private:
+    struct Ring {
+        size_t offset;        // first bucket of the ring within a counter's buckets
+        size_t buckets;
+        uint64_t bucketSeconds;
+    };
+
+    static constexpr Ring RINGS[] = {
+        {0, 60, 1},
+        {60, 60, 60},
+        {120, 24, 3600},
+    };
+    static constexpr size_t BUCKETS_PER_COUNTER = 144;
+
+    // Bucket word: time slot tag in the top 32 bits, count in the low 32.
+    // Tags compare modulo 2^32 slots, so a bucket is only mistaken for a
+    // current one after 2^31 seconds (68 years) untouched; a bucket holds up
+    // to 2^32 - 1 visits.
+    static constexpr unsigned COUNT_BITS = 32;
+    static constexpr uint64_t COUNT_MASK = (uint64_t{1} << COUNT_BITS) - 1;
+    static constexpr uint64_t TAG_MASK = (uint64_t{1} << (64 - COUNT_BITS)) - 1;
+
+    std::atomic<uint64_t>* bucketsFor(size_t index) const {
+        return &buckets[index * BUCKETS_PER_COUNTER];
+    }
+
+    size_t numCounters;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+};
+
+#endif // WINDOWED_COUNTER_H
@@ -0,0 +1,404 @@
+#include "../include/ConcurrentCounterMap.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+namespace {
+
+// Count word layout: value in the low 62 bits, plus two state flags
+constexpr uint64_t MOVED = uint64_t{1} << 63;    // frozen; the value now lives in a newer table
+constexpr uint64_t SETTLED = uint64_t{1} << 62;  // no older table holds an uncopied count for this key
+constexpr uint64_t VALUE_MASK = SETTLED - 1;
+
+constexpr size_t MIGRATION_CHUNK = 4096;
+constexpr size_t MAX_CHAIN = 64;  // tables double, so a chain can never be this long
+
+size_t homeSlot(uint64_t key, size_t mask) {
+    // Murmur3 finalizer, so sequential page ids spread over the table
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return static_cast<size_t>(key) & mask;
+}
+
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t rounded = 1;
+    while (rounded < value) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+} // namespace
+
+// All-zero bytes are an empty slot with a zero count
+struct ConcurrentCounterMap::Slot {
+    std::atomic<uint64_t> key;
+    std::atomic<uint64_t> count;
+};
+
+static_assert(std::is_trivially_default_constructible<std::atomic<uint64_t>>::value,
+              "Slots are used straight out of calloc");
+
+struct ConcurrentCounterMap::Table {
+    explicit Table(size_t capacity)
+        : capacity(capacity)
+        , mask(capacity - 1)
+        , maxLoad(capacity / 4 * 3)
+        , chunks((capacity + MIGRATION_CHUNK - 1) / MIGRATION_CHUNK)
+        , slots(static_cast<Slot*>(std::calloc(capacity, sizeof(Slot))))
+    {
+        // calloc hands back untouched zero pages, so a new table costs little
+        // until it is filled, and the thread that grows the map does no O(n) work
+        if (!slots) {
+            throw std::bad_alloc();
+        }
+    }
+
+    ~Table() { std::free(slots); }
+
+    Table(const Table&) = delete;
+    Table& operator=(const Table&) = delete;
+
+    const size_t capacity;
+    const size_t mask;
+    const size_t maxLoad;
+    const size_t chunks;
+    Slot* const slots;
+    std::atomic<size_t> used{0};              // slots holding a key
+    std::atomic<bool> growing{false};
+    std::atomic<Table*> next{nullptr};        // larger table this one is copied into
+    std::atomic<size_t> migrateCursor{0};     // next chunk to hand out
+    std::atomic<size_t> migratedChunks{0};
+    Table* nextRetired = nullptr;
+    bool retireSuccessors = false;            // free the whole chain behind this table too
+};
+
+// Registers an operation for the duration of a scope so tables it may be
+// looking at are not freed underneath it
+class ConcurrentCounterMap::Guard {
+public:
+    explicit Guard(const ConcurrentCounterMap& map) : map(map) {
+        uint64_t parity = map.epoch.load(std::memory_order_seq_cst) & 1;
+        active = &map.activeStripes[currentThreadOrdinal() & map.activeMask].active[parity];
+        active->fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    ~Guard() {
+        active->fetch_sub(1, std::memory_order_seq_cst);
+        if (map.reclaimPending.load(std::memory_order_relaxed)) {
+            map.tryReclaim();
+        }
+    }
+
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+private:
+    const ConcurrentCounterMap& map;
+    std::atomic<size_t>* active;
+};
+
+ConcurrentCounterMap::ConcurrentCounterMap(size_t initialCapacity)
+    : initialCapacity(roundUpToPowerOfTwo(std::max(initialCapacity, MIN_CAPACITY)))
+    , head(new Table(this->initialCapacity))
+    , keyCount(1)
+{
+    size_t stripes = roundUpToPowerOfTwo(std::max(1u, std::thread::hardware_concurrency()));
+    activeStripes = std::make_unique<ActiveStripe[]>(stripes);
+    activeMask = stripes - 1;
+    for (size_t i = 0; i < stripes; ++i) {
+        activeStripes[i].active[0].store(0, std::memory_order_relaxed);
+        activeStripes[i].active[1].store(0, std::memory_order_relaxed);
+    }
+}
+
+ConcurrentCounterMap::~ConcurrentCounterMap() {
+    Table* table = head.load(std::memory_order_relaxed);
+    table->retireSuccessors = true;
+    destroy(table);
+
+    for (Table* list : {graceBatch, retired.load(std::memory_order_relaxed)}) {
+        while (list) {
+            Table* nextRetired = list->nextRetired;
+            destroy(list);
+            list = nextRetired;
+        }
+    }
+}
+
+void ConcurrentCounterMap::add(uint64_t key, uint64_t delta) {
+    if (key == EMPTY_KEY || key == SEALED_KEY) {
+        throw std::invalid_argument("Reserved counter key: " + std::to_string(key));
+    }
+
+    Guard guard(*this);
+    Table* table = head.load(std::memory_order_acquire);
+    if (table->next.load(std::memory_order_acquire)) {
+        helpMigrate(table);
+    }
+
+    bool viaMoved = false;
+    for (;;) {
+        Slot& slot = locate(table, key, viaMoved);
+        // Only a writer that found no trace of the key in older tables may settle it
+        if (applyDelta(slot, delta, !viaMoved)) {
+            return;
+        }
+        // Frozen by a copy between locate and the update; follow it
+        viaMoved = true;
+        table = table->next.load(std::memory_order_acquire);
+    }
+}
+
+uint64_t ConcurrentCounterMap::get(uint64_t key) const {
+    if (key == EMPTY_KEY || key == SEALED_KEY) {
+        return 0;
+    }
+
+    Guard guard(*this);
+    Table* chain[MAX_CHAIN];
+    size_t length = 0;
+    for (Table* table = head.load(std::memory_order_acquire); table && length < MAX_CHAIN;
+         table = table->next.load(std::memory_order_acquire)) {
+        chain[length++] = table;
+    }
+
+    // Newest first: an unsettled count still owes whatever the older tables
+    // hold, and a frozen count has not reached the newer tables already read
+    uint64_t total = 0;
+    while (length-- > 0) {
+        const Table* table = chain[length];
+        for (size_t index = homeSlot(key, table->mask); ; index = (index + 1) & table->mask) {
+            const Slot& slot = table->slots[index];
+            uint64_t current = slot.key.load(std::memory_order_acquire);
+            if (current == EMPTY_KEY || current == SEALED_KEY) {
+                break;
+            }
+            if (current == key) {
+                uint64_t count = slot.count.load(std::memory_order_acquire);
+                total += count & VALUE_MASK;
+                if (count & (MOVED | SETTLED)) {
+                    return total;
+                }
+                break;
+            }
+        }
+    }
+    return total;
+}
+
+void ConcurrentCounterMap::clear() {
+    Table* old = head.exchange(new Table(initialCapacity), std::memory_order_acq_rel);
+    keyCount.reset();
+    // Nothing can reach the old chain any more, so it goes as a whole
+    retire(old, true);
+    tryReclaim();
+}
+
+size_t ConcurrentCounterMap::capacity() const {
+    Guard guard(*this);
+    Table* table = head.load(std::memory_order_acquire);
+    while (Table* next = table->next.load(std::memory_order_acquire)) {
+        table = next;
+    }
+    return table->capacity;
+}
+
+size_t ConcurrentCounterMap::memoryBytes() const {
+    Guard guard(*this);
+    size_t bytes = 0;
+    for (Table* table = head.load(std::memory_order_acquire); table; table = table->next.load(std::memory_order_acquire)) {
+        bytes += table->capacity * sizeof(Slot);
+    }
+    return bytes;
+}
+
+uint64_t ConcurrentCounterMap::keyFor(std::string_view url) {
+    uint64_t key = std::hash<std::string_view>{}(url);
+    if (key == EMPTY_KEY) {
+        return 1;
+    }
+    return key == SEALED_KEY ? SEALED_KEY - 1 : key;
+}
+
+ConcurrentCounterMap::Slot& ConcurrentCounterMap::locate(Table*& table, uint64_t key, bool& viaMoved) {
+    for (;;) {
+        size_t index = homeSlot(key, table->mask);
+        for (;;) {
+            Slot& slot = table->slots[index];
+            uint64_t current = slot.key.load(std::memory_order_acquire);
+
+            if (current == EMPTY_KEY) {
+                Table* next = table->next.load(std::memory_order_acquire);
+                if (!next && table->used.load(std::memory_order_relaxed) >= table->maxLoad) {
+                    next = grow(table);
+                    if (!next && table->used.load(std::memory_order_relaxed) >= table->capacity - table->capacity / 8) {
+                        // Nearly full and another thread is still allocating the next table
+                        std::this_thread::yield();
+                        continue;
+                    }
+                }
+                // Once a table has a successor its empty slots are sealed, so the
+                // key can never appear here after a reader or copier passed by
+                uint64_t replacement = next ? SEALED_KEY : key;
+                if (!slot.key.compare_exchange_strong(current, replacement, std::memory_order_acq_rel)) {
+                    continue;  // someone else claimed or sealed the slot; look again
+                }
+                if (next) {
+                    break;
+                }
+                table->used.fetch_add(1, std::memory_order_relaxed);
+                if (!viaMoved) {
+                    keyCount.add(0);
+                }
+                return slot;
+            }
+            if (current == SEALED_KEY) {
+                break;
+            }
+            if (current == key) {
+                if (slot.count.load(std::memory_order_acquire) & MOVED) {
+                    viaMoved = true;
+                    break;
+                }
+                return slot;
+            }
+            index = (index + 1) & table->mask;
+        }
+        table = table->next.load(std::memory_order_acquire);
+    }
+}
+
+bool ConcurrentCounterMap::applyDelta(Slot& slot, uint64_t delta, bool settle) {
+    uint64_t count = slot.count.load(std::memory_order_relaxed);
+    uint64_t flags = settle ? SETTLED : 0;
+    do {
+        if (count & MOVED) {
+            return false;
+        }
+    } while (!slot.count.compare_exchange_weak(count, (count + delta) | flags, std::memory_order_acq_rel));
+    return true;
+}
+
+ConcurrentCounterMap::Table* ConcurrentCounterMap::grow(Table* table) {
+    if (table->growing.exchange(true, std::memory_order_acq_rel)) {
+        return table->next.load(std::memory_order_acquire);
+    }
+    Table* next = new Table(table->capacity * 2);
+    table->next.store(next, std::memory_order_release);
+    return next;
+}
+
+void ConcurrentCounterMap::helpMigrate(Table* table) {
+    size_t chunk = table->migrateCursor.fetch_add(1, std::memory_order_relaxed);
+    if (chunk >= table->chunks) {
+        return;
+    }
+
+    size_t end = std::min(table->capacity, (chunk + 1) * MIGRATION_CHUNK);
+    for (size_t i = chunk * MIGRATION_CHUNK; i < end; ++i) {
+        migrateSlot(table, table->slots[i]);
+    }
+
+    if (table->migratedChunks.fetch_add(1, std::memory_order_acq_rel) + 1 == table->chunks) {
+        // Every count has reached the next table; unlink this one
+        Table* expected = table;
+        if (head.compare_exchange_strong(expected, table->next.load(std::memory_order_acquire),
+                                         std::memory_order_acq_rel)) {
+            retire(table, false);
+        }
+    }
+}
+
+void ConcurrentCounterMap::migrateSlot(Table* table, Slot& slot) {
+    uint64_t key = slot.key.load(std::memory_order_acquire);
+    if (key == EMPTY_KEY && slot.key.compare_exchange_strong(key, SEALED_KEY, std::memory_order_acq_rel)) {
+        return;
+    }
+    if (key == SEALED_KEY) {
+        return;
+    }
+
+    uint64_t value = slot.count.fetch_or(MOVED, std::memory_order_acq_rel) & VALUE_MASK;
+    Table* target = table->next.load(std::memory_order_acquire);
+    bool viaMoved = true;
+    for (;;) {
+        Slot& destination = locate(target, key, viaMoved);
+        if (applyDelta(destination, value, true)) {
+            return;
+        }
+        target = target->next.load(std::memory_order_acquire);
+    }
+}
+
+void ConcurrentCounterMap::retire(Table* table, bool withSuccessors) const {
+    table->retireSuccessors = withSuccessors;
+    Table* top = retired.load(std::memory_order_relaxed);
+    do {
+        table->nextRetired = top;
+    } while (!retired.compare_exchange_weak(top, table, std::memory_order_acq_rel));
+    reclaimPending.store(true, std::memory_order_seq_cst);
+}
+
+void ConcurrentCounterMap::tryReclaim() const {
+    if (reclaiming.exchange(true, std::memory_order_acquire)) {
+        return;
+    }
+
+    if (gracePhase == 0) {
+        graceBatch = retired.exchange(nullptr, std::memory_order_acq_rel);
+        if (graceBatch) {
+            graceParity = epoch.fetch_add(1, std::memory_order_seq_cst) & 1;
+            gracePhase = 1;
+        }
+    }
+    // Operations that began before the unlink are in one of the two parities;
+    // wait for each to drain in turn
+    if (gracePhase == 1 && drained(graceParity)) {
+        graceParity = epoch.fetch_add(1, std::memory_order_seq_cst) & 1;
+        gracePhase = 2;
+    }
+    if (gracePhase == 2 && drained(graceParity)) {
+        while (graceBatch) {
+            Table* nextRetired = graceBatch->nextRetired;
+            destroy(graceBatch);
+            graceBatch = nextRetired;
+        }
+        gracePhase = 0;
+    }
+
+    reclaimPending.store(gracePhase != 0, std::memory_order_seq_cst);
+    if (retired.load(std::memory_order_seq_cst)) {
+        reclaimPending.store(true, std::memory_order_seq_cst);
+    }
+    reclaiming.store(false, std::memory_order_release);
+}
+
+bool ConcurrentCounterMap::drained(uint64_t parity) const {
+    for (size_t i = 0; i <= activeMask; ++i) {
+        if (activeStripes[i].active[parity].load(std::memory_order_seq_cst) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ConcurrentCounterMap::destroy(Table* table) {
+    if (table->retireSuccessors) {
+        Table* next = table->next.load(std::memory_order_relaxed);
+        while (next) {
+            Table* after = next->next.load(std::memory_order_relaxed);
+            delete next;
+            next = after;
+        }
+    }
+    delete table;
+}
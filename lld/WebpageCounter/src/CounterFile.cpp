@@ -0,0 +1,160 @@
+#include "../include/CounterFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char MAGIC[8] = {'W', 'P', 'C', 'O', 'U', 'N', 'T', '1'};
+constexpr size_t CHECKPOINT_CHUNK = 1 << 16;  // counters copied per write()
+
+struct FileHeader {
+    char magic[8];
+    uint64_t counters;
+    char reserved[48];
+};
+
+static_assert(sizeof(FileHeader) == 64, "counters start on a cache line");
+static_assert(sizeof(std::atomic<size_t>) == sizeof(size_t) && std::atomic<size_t>::is_always_lock_free,
+              "counters are used in place in the mapping");
+
+std::runtime_error systemError(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+void writeAll(int fd, const void* data, size_t bytes, const std::string& path) {
+    const char* next = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t written = ::write(fd, next, bytes);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw systemError("Cannot write", path);
+        }
+        next += written;
+        bytes -= static_cast<size_t>(written);
+    }
+}
+
+} // namespace
+
+CounterFile::CounterFile(const std::string& path, size_t counters)
+    : path(path)
+    , fd(-1)
+    , mapping(MAP_FAILED)
+    , mappedBytes(sizeof(FileHeader) + counters * sizeof(size_t))
+    , count(counters)
+    , slots(nullptr)
+{
+    if (counters == 0) {
+        throw std::invalid_argument("Counter file must hold at least one counter");
+    }
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw systemError("Cannot open counter file", path);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw systemError("Cannot stat counter file", path);
+    }
+
+    // An all-zero header is a file whose creation did not finish
+    FileHeader header{};
+    const FileHeader blank{};
+    if (info.st_size != 0) {
+        if (static_cast<size_t>(info.st_size) < sizeof(FileHeader)
+            || ::pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))
+            || (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+                && std::memcmp(&header, &blank, sizeof(header)) != 0)) {
+            ::close(fd);
+            throw std::runtime_error("Not a counter file: " + path);
+        }
+        if (header.counters > counters) {
+            ::close(fd);
+            throw std::invalid_argument("Counter file " + path + " holds " + std::to_string(header.counters)
+                                        + " counters, more than the " + std::to_string(counters) + " requested");
+        }
+    }
+
+    // New space reads as zero and takes no disk until written
+    if (static_cast<size_t>(info.st_size) < mappedBytes && ::ftruncate(fd, static_cast<off_t>(mappedBytes)) != 0) {
+        ::close(fd);
+        throw systemError("Cannot size counter file", path);
+    }
+
+    mapping = ::mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        ::close(fd);
+        throw systemError("Cannot map counter file", path);
+    }
+
+    // The header is written last: a crash before this point leaves a blank
+    // header or the old counter count, and the next open redoes the work
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.counters = counters;
+    std::memcpy(mapping, &header, sizeof(header));
+    slots = reinterpret_cast<std::atomic<size_t>*>(static_cast<char*>(mapping) + sizeof(FileHeader));
+}
+
+CounterFile::~CounterFile() {
+    // Unmapping does not lose anything: the page cache still has the writes
+    ::munmap(mapping, mappedBytes);
+    ::close(fd);
+}
+
+void CounterFile::syncToDisk() const {
+    if (::msync(mapping, mappedBytes, MS_SYNC) != 0) {
+        throw systemError("Cannot sync counter file", path);
+    }
+}
+
+void CounterFile::checkpoint(const std::string& target) const {
+    const std::string temporary = target + ".tmp";
+    int out = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        throw systemError("Cannot create checkpoint", temporary);
+    }
+
+    try {
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.counters = count;
+        writeAll(out, &header, sizeof(header), temporary);
+
+        // Read each counter atomically rather than copying the mapping's
+        // bytes, which writers are changing underneath
+        std::vector<size_t> chunk(std::min(count, CHECKPOINT_CHUNK));
+        for (size_t first = 0; first < count; first += chunk.size()) {
+            size_t n = std::min(chunk.size(), count - first);
+            for (size_t i = 0; i < n; ++i) {
+                chunk[i] = slots[first + i].load(std::memory_order_relaxed);
+            }
+            writeAll(out, chunk.data(), n * sizeof(size_t), temporary);
+        }
+
+        if (::fsync(out) != 0) {
+            throw systemError("Cannot sync checkpoint", temporary);
+        }
+    } catch (...) {
+        ::close(out);
+        std::remove(temporary.c_str());
+        throw;
+    }
+    ::close(out);
+
+    if (std::rename(temporary.c_str(), target.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        throw systemError("Cannot install checkpoint", target);
+    }
+}
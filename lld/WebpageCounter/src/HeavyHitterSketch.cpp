@@ -0,0 +1,290 @@
+#include "../include/HeavyHitterSketch.h"
+#include "../include/StripedCounter.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+uint64_t mix(uint64_t value) {
+    // splitmix64 finaliser; page indices are small and consecutive
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t rounded = 1;
+    while (rounded < value) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+} // namespace
+
+HeavyHitterSketch::HeavyHitterSketch(const HeavyHitterOptions& options)
+    : widthMask(roundUpToPowerOfTwo(options.width) - 1)
+    , depth(options.depth)
+    , maxCandidates(options.candidates)
+{
+    if (options.width == 0) {
+        throw std::invalid_argument("Sketch width must be positive");
+    }
+    if (depth == 0 || depth > MAX_DEPTH) {
+        throw std::invalid_argument("Sketch depth must be between 1 and " + std::to_string(MAX_DEPTH));
+    }
+    if (maxCandidates == 0) {
+        throw std::invalid_argument("Heavy-hitter candidate count must be positive");
+    }
+
+    size_t shardTotal = roundUpToPowerOfTwo(options.shards ? options.shards : std::thread::hardware_concurrency());
+    shards.reserve(shardTotal);
+    for (size_t i = 0; i < shardTotal; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->counters = std::make_unique<std::atomic<uint64_t>[]>((widthMask + 1) * depth);
+        shard->heap.reserve(maxCandidates);
+        shard->heapKeys.reserve(maxCandidates);
+        shards.push_back(std::move(shard));
+    }
+    clear();
+}
+
+void HeavyHitterSketch::rowSlots(uint64_t key, size_t* slots) const {
+    // A separate mix per row. Double hashing (h1 + row * h2) is cheaper, but two
+    // keys then collide in every row with probability 1/width^2, which at
+    // width 4096 and a million keys lets tail pages shadow hot ones.
+    uint64_t hash = key;
+    for (size_t row = 0; row < depth; ++row) {
+        hash = mix(hash);
+        slots[row] = row * (widthMask + 1) + (hash & widthMask);
+    }
+}
+
+uint64_t HeavyHitterSketch::shardEstimate(const Shard& shard, const size_t* slots) const {
+    uint64_t smallest = UINT64_MAX;
+    for (size_t row = 0; row < depth; ++row) {
+        smallest = std::min(smallest, shard.counters[slots[row]].load(std::memory_order_relaxed));
+    }
+    return smallest;
+}
+
+void HeavyHitterSketch::add(uint64_t key, uint64_t delta, std::string_view label) {
+    size_t slots[MAX_DEPTH];
+    rowSlots(key, slots);
+
+    Shard& shard = *shards[currentThreadOrdinal() & (shards.size() - 1)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // Conservative update: only raise rows that are below the new estimate,
+    // which keeps the other keys sharing those counters from inflating
+    uint64_t count = shardEstimate(shard, slots) + delta;
+    for (size_t row = 0; row < depth; ++row) {
+        std::atomic<uint64_t>& counter = shard.counters[slots[row]];
+        if (counter.load(std::memory_order_relaxed) < count) {
+            counter.store(count, std::memory_order_relaxed);
+        }
+    }
+    offerCandidate(shard, key, count, label);
+}
+
+void HeavyHitterSketch::offerCandidate(Shard& shard, uint64_t key, uint64_t count, std::string_view label) {
+    // A candidate's count is an earlier estimate of its key and estimates only
+    // grow, so a key whose estimate is below the heap minimum is not in the heap
+    bool full = shard.heap.size() == maxCandidates;
+    if (full && count < shard.heap.front().count) {
+        return;
+    }
+
+    auto found = std::find(shard.heapKeys.begin(), shard.heapKeys.end(), key);
+    if (found != shard.heapKeys.end()) {
+        size_t index = static_cast<size_t>(found - shard.heapKeys.begin());
+        shard.heap[index].count = count;
+        siftDown(shard, index);
+        return;
+    }
+
+    if (!full) {
+        shard.heap.push_back(Candidate{count, key, std::string(label)});
+        shard.heapKeys.push_back(key);
+        size_t index = shard.heap.size() - 1;
+        while (index > 0) {
+            size_t parent = (index - 1) / 2;
+            if (shard.heap[parent].count <= shard.heap[index].count) {
+                break;
+            }
+            std::swap(shard.heap[parent], shard.heap[index]);
+            std::swap(shard.heapKeys[parent], shard.heapKeys[index]);
+            index = parent;
+        }
+    } else if (count > shard.heap.front().count) {
+        // Evict the weakest candidate
+        Candidate& weakest = shard.heap.front();
+        weakest.count = count;
+        weakest.key = key;
+        weakest.label.assign(label);
+        shard.heapKeys.front() = key;
+        siftDown(shard, 0);
+    }
+}
+
+void HeavyHitterSketch::siftDown(Shard& shard, size_t index) {
+    const size_t size = shard.heap.size();
+    for (;;) {
+        size_t smallest = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+        if (left < size && shard.heap[left].count < shard.heap[smallest].count) {
+            smallest = left;
+        }
+        if (right < size && shard.heap[right].count < shard.heap[smallest].count) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            return;
+        }
+        std::swap(shard.heap[index], shard.heap[smallest]);
+        std::swap(shard.heapKeys[index], shard.heapKeys[smallest]);
+        index = smallest;
+    }
+}
+
+uint64_t HeavyHitterSketch::estimate(uint64_t key) const {
+    size_t slots[MAX_DEPTH];
+    rowSlots(key, slots);
+
+    uint64_t total = 0;
+    for (const auto& shard : shards) {
+        total += shardEstimate(*shard, slots);
+    }
+    return total;
+}
+
+std::vector<HeavyHitterSketch::Entry> HeavyHitterSketch::topK(size_t k) const {
+    if (k == 0) {
+        return {};
+    }
+
+    // Only keys that are a candidate somewhere are ranked. A key is dropped from
+    // a shard only once `candidates` other keys estimate at least its count
+    // there, so a key missing everywhere has, in each shard s, a count of at
+    // most N_s/candidates plus that shard's sketch error. Summed over shards,
+    // every key with a total above N/candidates + e*N/width is a candidate
+    // (w.h.p.); a key spread evenly below that can be missed.
+    struct Seen {
+        uint64_t key;
+        uint64_t count;  // the shard's candidate count
+        size_t shard;
+    };
+    std::vector<Seen> seen;
+    seen.reserve(shards.size() * maxCandidates);
+    std::vector<uint64_t> floors(shards.size(), 0);  // smallest candidate count of each full shard
+    uint64_t floorTotal = 0;
+    for (size_t s = 0; s < shards.size(); ++s) {
+        Shard& shard = *shards[s];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const Candidate& candidate : shard.heap) {
+            seen.push_back(Seen{candidate.key, candidate.count, s});
+        }
+        if (shard.heap.size() == maxCandidates) {
+            floors[s] = shard.heap.front().count;
+            floorTotal += floors[s];
+        }
+    }
+    std::sort(seen.begin(), seen.end(), [](const Seen& x, const Seen& y) { return x.key < y.key; });
+
+    // Merge the shards' Space-Saving counts, as for mergeable summaries: a
+    // key's candidate counts add up to a lower bound, and each shard that
+    // does not hold the key adds at most its smallest candidate count. Both
+    // bounds are good up to the sketch's own overcount.
+    struct Merged {
+        uint64_t key;
+        uint64_t lower;
+        uint64_t upper;
+        size_t shard;  // a shard holding the key, where its label is
+    };
+    std::vector<Merged> merged;
+    for (size_t i = 0; i < seen.size();) {
+        Merged entry{seen[i].key, 0, floorTotal, seen[i].shard};
+        for (; i < seen.size() && seen[i].key == entry.key; ++i) {
+            entry.lower += seen[i].count;
+            entry.upper += seen[i].count - floors[seen[i].shard];
+        }
+        merged.push_back(entry);
+    }
+
+    // Only keys whose upper bound reaches the k-th largest lower bound can
+    // make the cut, so the sketch is read for those alone rather than for
+    // every candidate of every shard
+    uint64_t threshold = 0;
+    if (merged.size() > k) {
+        std::vector<uint64_t> lowers;
+        lowers.reserve(merged.size());
+        for (const Merged& entry : merged) {
+            lowers.push_back(entry.lower);
+        }
+        std::nth_element(lowers.begin(), lowers.begin() + (k - 1), lowers.end(), std::greater<uint64_t>());
+        threshold = lowers[k - 1];
+    }
+
+    std::vector<Entry> result;
+    std::vector<size_t> labelShard;
+    for (const Merged& entry : merged) {
+        if (entry.upper >= threshold) {
+            result.push_back(Entry{entry.key, estimate(entry.key), {}});
+            labelShard.push_back(entry.shard);
+        }
+    }
+
+    std::vector<size_t> order(result.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    auto ranked = [&result](size_t x, size_t y) {
+        const Entry& a = result[x];
+        const Entry& b = result[y];
+        return a.count != b.count ? a.count > b.count : a.key < b.key;
+    };
+    k = std::min(k, result.size());
+    std::partial_sort(order.begin(), order.begin() + k, order.end(), ranked);
+
+    // Labels are only copied for the keys that made the cut, from the shard
+    // the key was seen in unless it has been evicted there since
+    std::vector<Entry> top;
+    top.reserve(k);
+    for (size_t i = 0; i < k; ++i) {
+        Entry& entry = result[order[i]];
+        size_t hint = labelShard[order[i]];
+        for (size_t n = 0; n < shards.size() && entry.label.empty(); ++n) {
+            Shard& shard = *shards[(hint + n) % shards.size()];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto found = std::find(shard.heapKeys.begin(), shard.heapKeys.end(), entry.key);
+            if (found != shard.heapKeys.end()) {
+                entry.label = shard.heap[static_cast<size_t>(found - shard.heapKeys.begin())].label;
+            }
+        }
+        top.push_back(std::move(entry));
+    }
+    return top;
+}
+
+void HeavyHitterSketch::clear() {
+    const size_t counterTotal = (widthMask + 1) * depth;
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (size_t i = 0; i < counterTotal; ++i) {
+            shard->counters[i].store(0, std::memory_order_relaxed);
+        }
+        shard->heap.clear();
+        shard->heapKeys.clear();
+    }
+}
+
+size_t HeavyHitterSketch::memoryBytes() const {
+    size_t perShard = sizeof(Shard)
+        + (widthMask + 1) * depth * sizeof(std::atomic<uint64_t>)
+        + maxCandidates * (sizeof(Candidate) + sizeof(uint64_t));
+    return shards.size() * perShard;
+}
@@ -1,19 +1,380 @@
 #include "../include/Logger.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
 
-std::shared_ptr<Logger> Logger::getInstance() {
-    if (!instance) {
-        instance = std::shared_ptr<Logger>(new Logger());
+namespace {
+
+// One staged message; the text, if any, follows padded to 8 bytes
+struct RecordHeader {
+    uint32_t event;
+    uint32_t textBytes;
+    uint64_t a;
+    uint64_t b;
+};
+
+constexpr uint32_t PADDING_EVENT = UINT32_MAX;  // rest of the ring up to the wrap point is unused
+constexpr size_t WRITE_CHUNK = 1 << 20;         // bytes of formatted text per file write
+
+size_t paddedSize(size_t textBytes) {
+    return sizeof(RecordHeader) + (textBytes + 7) / 8 * 8;
+}
+
+void appendNumber(std::string& out, uint64_t value) {
+    char digits[20];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+} // namespace
+
+void formatLogEvent(std::string& out, LogEvent event, uint64_t a, uint64_t b, std::string_view text) {
+    switch (event) {
+    case LogEvent::Text:
+        out.append(text);
+        break;
+    case LogEvent::CounterInitialized:
+        out.append("Initialized counter with ");
+        appendNumber(out, a);
+        out.append(" pages");
+        break;
+    case LogEvent::PageIncremented:
+        out.append("Incremented visit count for page ");
+        appendNumber(out, a);
+        break;
+    case LogEvent::PagesBatchIncremented:
+        out.append("Batch incremented ");
+        appendNumber(out, a);
+        out.append(" pages");
+        break;
+    case LogEvent::PageQueried:
+        out.append("Retrieved visit count for page ");
+        appendNumber(out, a);
+        out.append(": ");
+        appendNumber(out, b);
+        break;
+    case LogEvent::UrlIncremented:
+        out.append("Incremented visit count for URL ");
+        out.append(text);
+        break;
+    case LogEvent::UrlQueried:
+        out.append("Retrieved visit count for URL ");
+        out.append(text);
+        out.append(": ");
+        appendNumber(out, b);
+        break;
+    case LogEvent::CountersReset:
+        out.append("Reset all counters");
+        break;
+    }
+}
+
+void ILogger::logEvent(LogEvent event, uint64_t a, uint64_t b, std::string_view text) {
+    std::string message;
+    formatLogEvent(message, event, a, b, text);
+    log(message);
+}
+
+// Single-producer, single-consumer byte ring. Positions only grow; the
+// offset into storage is position & mask.
+struct Logger::ThreadBuffer {
+    explicit ThreadBuffer(size_t capacity)
+        : capacity(capacity)
+        , mask(capacity - 1)
+        , storage(new unsigned char[capacity])
+    {
+    }
+
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<unsigned char[]> storage;
+
+    // Producer side
+    alignas(64) std::atomic<size_t> head{0};
+    size_t cachedTail = 0;
+    std::atomic<uint64_t> dropped{0};
+
+    // Writer side
+    alignas(64) std::atomic<size_t> tail{0};
+    uint64_t reportedDrops = 0;
+
+    std::atomic<bool> inUse{true};  // false once the owning thread has exited
+    std::atomic<bool> closed{false};  // the logger is gone; threads drop their cached handle
+};
+
+struct Logger::BufferNode {
+    std::shared_ptr<ThreadBuffer> buffer;
+    BufferNode* next;
+};
+
+Logger::Logger(const std::string& path, const LoggerOptions& options)
+    : id([] {
+          static std::atomic<uint64_t> nextId{1};
+          return nextId.fetch_add(1, std::memory_order_relaxed);
+      }())
+    , options(options)
+    , logFile(path, std::ios::out)
+{
+    if (!logFile.is_open()) {
+        throw std::runtime_error("Cannot open log file: " + path);
+    }
+    writer = std::thread([this] { writerLoop(); });
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        stopping.store(true, std::memory_order_release);
     }
+    writerWake.notify_all();
+    writer.join();
+
+    BufferNode* node = buffers.load(std::memory_order_acquire);
+    while (node) {
+        BufferNode* next = node->next;
+        node->buffer->closed.store(true, std::memory_order_release);
+        delete node;
+        node = next;
+    }
+}
+
+std::shared_ptr<Logger> Logger::getInstance() {
+    static std::shared_ptr<Logger> instance = create("log.txt");
     return instance;
 }
 
+std::shared_ptr<Logger> Logger::create(const std::string& path, const LoggerOptions& options) {
+    return std::shared_ptr<Logger>(new Logger(path, options));
+}
+
 void Logger::log(const std::string& message) {
-    std::lock_guard<std::mutex> lock(logMutex);
-    if (!logFile.is_open()) {
-        logFile.open("log.txt", std::ios::out);  // Open in write mode
+    logEvent(LogEvent::Text, 0, 0, message);
+}
+
+void Logger::logEvent(LogEvent event, uint64_t a, uint64_t b, std::string_view text) {
+    ThreadBuffer& buffer = localBuffer();
+    text = text.substr(0, buffer.capacity / 4);
+    const size_t size = paddedSize(text.size());
+
+    size_t position = buffer.head.load(std::memory_order_relaxed);
+    size_t offset = position & buffer.mask;
+    size_t contiguous = buffer.capacity - offset;
+    // A record never wraps; the tail end of the ring is skipped instead
+    size_t needed = contiguous < size ? contiguous + size : size;
+
+    while (position + needed - buffer.cachedTail > buffer.capacity) {
+        buffer.cachedTail = buffer.tail.load(std::memory_order_acquire);
+        if (position + needed - buffer.cachedTail <= buffer.capacity) {
+            break;
+        }
+        requestDrain();
+        if (options.dropWhenFull) {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::this_thread::yield();
     }
-    if (logFile.is_open()) {
-        logFile << message << std::endl;
-        logFile.flush();  // Ensure immediate writing
+
+    if (contiguous < size) {
+        if (contiguous >= sizeof(RecordHeader)) {
+            RecordHeader padding{PADDING_EVENT, 0, 0, 0};
+            std::memcpy(&buffer.storage[offset], &padding, sizeof(padding));
+        }
+        position += contiguous;
+        offset = 0;
+    }
+
+    RecordHeader header{static_cast<uint32_t>(event), static_cast<uint32_t>(text.size()), a, b};
+    std::memcpy(&buffer.storage[offset], &header, sizeof(header));
+    if (!text.empty()) {
+        std::memcpy(&buffer.storage[offset + sizeof(header)], text.data(), text.size());
     }
-} 
\ No newline at end of file
+    buffer.head.store(position + size, std::memory_order_release);
+}
+
+void Logger::requestDrain() {
+    // One wake-up per writer pass; later producers see the flag still set and
+    // skip the mutex. Notifying under the mutex means the writer is either
+    // asleep and gets the signal, or has not yet checked the flag.
+    if (drainRequested.load(std::memory_order_relaxed) || drainRequested.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(writerMutex);
+    writerWake.notify_one();
+}
+
+void Logger::flush() {
+    uint64_t request = flushRequests.fetch_add(1, std::memory_order_acq_rel) + 1;
+    // Under the mutex, like requestDrain: the writer has either not yet
+    // checked flushRequests or is asleep and gets the signal
+    std::unique_lock<std::mutex> lock(writerMutex);
+    writerWake.notify_one();
+    flushDone.wait(lock, [this, request] { return flushesDone.load(std::memory_order_acquire) >= request; });
+}
+
+uint64_t Logger::droppedMessages() const {
+    uint64_t total = 0;
+    for (BufferNode* node = buffers.load(std::memory_order_acquire); node; node = node->next) {
+        total += node->buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t Logger::ringCount() const {
+    size_t count = 0;
+    for (BufferNode* node = buffers.load(std::memory_order_acquire); node; node = node->next) {
+        ++count;
+    }
+    return count;
+}
+
+Logger::ThreadBuffer& Logger::localBuffer() {
+    // One ring per logger per thread, so a thread that alternates between
+    // loggers keeps its rings (and its message order) instead of handing them
+    // back and rescanning the registry on every switch. Logger ids are never
+    // reused, so a stale entry cannot match a new logger.
+    struct LocalBuffer {
+        uint64_t owner;
+        std::shared_ptr<ThreadBuffer> buffer;
+    };
+    struct LocalBuffers {
+        std::vector<LocalBuffer> entries;
+
+        ~LocalBuffers() {
+            for (auto& entry : entries) {
+                entry.buffer->inUse.store(false, std::memory_order_release);
+            }
+        }
+    };
+    thread_local LocalBuffers local;
+
+    for (auto& entry : local.entries) {
+        if (entry.owner == id) {
+            return *entry.buffer;
+        }
+    }
+
+    // Rings of loggers destroyed since the last miss are no longer needed
+    local.entries.erase(std::remove_if(local.entries.begin(), local.entries.end(),
+                                       [](const LocalBuffer& entry) {
+                                           return entry.buffer->closed.load(std::memory_order_acquire);
+                                       }),
+                        local.entries.end());
+    local.entries.push_back({id, acquireBuffer()});
+    return *local.entries.back().buffer;
+}
+
+std::shared_ptr<Logger::ThreadBuffer> Logger::acquireBuffer() {
+    // Adopt a ring left behind by a finished thread before allocating
+    for (BufferNode* node = buffers.load(std::memory_order_acquire); node; node = node->next) {
+        bool free = false;
+        if (node->buffer->inUse.compare_exchange_strong(free, true, std::memory_order_acq_rel)) {
+            return node->buffer;
+        }
+    }
+
+    size_t capacity = 4096;
+    while (capacity < options.threadBufferBytes) {
+        capacity <<= 1;
+    }
+    auto node = new BufferNode{std::make_shared<ThreadBuffer>(capacity), nullptr};
+    node->next = buffers.load(std::memory_order_relaxed);
+    while (!buffers.compare_exchange_weak(node->next, node, std::memory_order_acq_rel)) {
+    }
+    return node->buffer;
+}
+
+void Logger::writerLoop() {
+    std::string out;
+    out.reserve(WRITE_CHUNK + 4096);
+
+    for (;;) {
+        uint64_t requested = flushRequests.load(std::memory_order_acquire);
+        bool stop = stopping.load(std::memory_order_acquire);
+        drainRequested.store(false, std::memory_order_release);
+
+        bool drained = drain(out);
+        if (!out.empty()) {
+            logFile.write(out.data(), static_cast<std::streamsize>(out.size()));
+            out.clear();
+        }
+        if (drained || requested != flushesDone.load(std::memory_order_relaxed)) {
+            logFile.flush();
+        }
+
+        if (requested != flushesDone.load(std::memory_order_relaxed)) {
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                flushesDone.store(requested, std::memory_order_release);
+            }
+            flushDone.notify_all();
+        }
+        if (stop) {
+            return;
+        }
+        if (!drained) {
+            std::unique_lock<std::mutex> lock(writerMutex);
+            writerWake.wait_for(lock, options.idleWait, [this, requested] {
+                return stopping.load(std::memory_order_acquire)
+                    || drainRequested.load(std::memory_order_acquire)
+                    || flushRequests.load(std::memory_order_acquire) != requested;
+            });
+        }
+    }
+}
+
+bool Logger::drain(std::string& out) {
+    // Rings are pushed onto the front of the list; visit them oldest first
+    thread_local std::vector<ThreadBuffer*> rings;
+    rings.clear();
+    for (BufferNode* node = buffers.load(std::memory_order_acquire); node; node = node->next) {
+        rings.push_back(node->buffer.get());
+    }
+
+    bool any = false;
+    for (auto ring = rings.rbegin(); ring != rings.rend(); ++ring) {
+        ThreadBuffer& buffer = **ring;
+
+        uint64_t dropped = buffer.dropped.load(std::memory_order_relaxed);
+        if (dropped != buffer.reportedDrops) {
+            out.append("Dropped ");
+            appendNumber(out, dropped - buffer.reportedDrops);
+            out.append(" log messages: writer fell behind\n");
+            buffer.reportedDrops = dropped;
+        }
+
+        size_t position = buffer.tail.load(std::memory_order_relaxed);
+        const size_t end = buffer.head.load(std::memory_order_acquire);
+        while (position < end) {
+            size_t offset = position & buffer.mask;
+            size_t contiguous = buffer.capacity - offset;
+            RecordHeader header;
+            if (contiguous < sizeof(RecordHeader)) {
+                position += contiguous;
+                continue;
+            }
+            std::memcpy(&header, &buffer.storage[offset], sizeof(header));
+            if (header.event == PADDING_EVENT) {
+                position += contiguous;
+                continue;
+            }
+
+            std::string_view text(reinterpret_cast<const char*>(&buffer.storage[offset + sizeof(header)]), header.textBytes);
+            formatLogEvent(out, static_cast<LogEvent>(header.event), header.a, header.b, text);
+            out.push_back('\n');
+            position += paddedSize(header.textBytes);
+            any = true;
+
+            if (out.size() >= WRITE_CHUNK) {
+                // Hand space back to the producer before the slow part
+                buffer.tail.store(position, std::memory_order_release);
+                logFile.write(out.data(), static_cast<std::streamsize>(out.size()));
+                out.clear();
+            }
+        }
+        buffer.tail.store(position, std::memory_order_release);
+    }
+    return any;
+}
@@ -0,0 +1,53 @@
+#include "../include/StripedCounter.h"
+#include <stdexcept>
+#include <thread>
+
+StripedCounterArray::StripedCounterArray(size_t size, size_t stripes)
+    : count(size)
+    , stripeMask(0)
+    , linesPerStripe((size + SLOTS_PER_LINE - 1) / SLOTS_PER_LINE)
+{
+    if (size == 0) {
+        throw std::invalid_argument("Striped counter array must hold at least one counter");
+    }
+    if (stripes == 0) {
+        stripes = std::thread::hardware_concurrency();
+    }
+    size_t rounded = 1;
+    while (rounded < stripes) {
+        rounded <<= 1;
+    }
+    stripeMask = rounded - 1;
+
+    lines = std::make_unique<CacheLine[]>(rounded * linesPerStripe);
+    reset();
+}
+
+size_t currentThreadOrdinal() {
+    // Threads are numbered in the order they first ask
+    static std::atomic<size_t> nextThread{0};
+    thread_local const size_t ordinal = nextThread.fetch_add(1, std::memory_order_relaxed);
+    return ordinal;
+}
+
+size_t StripedCounterArray::currentStripe() const {
+    // Round-robin over the stripes in thread order
+    return currentThreadOrdinal() & stripeMask;
+}
+
+size_t StripedCounterArray::sum(size_t index) const {
+    size_t total = 0;
+    for (size_t stripe = 0; stripe <= stripeMask; ++stripe) {
+        total += slot(stripe, index).load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void StripedCounterArray::reset() {
+    size_t totalLines = (stripeMask + 1) * linesPerStripe;
+    for (size_t i = 0; i < totalLines; ++i) {
+        for (auto& value : lines[i].slots) {
+            value.store(0, std::memory_order_relaxed);
+        }
+    }
+}
@@ -1,4 +1,3 @@
-#include <iostream>
 #include <vector>
 #include <mutex>
 #include <memory>
@@ -9,6 +8,8 @@
 #include <array>
 #include <thread>
 #include <fstream>  // Added for file operations
+#include <new>
+#include <type_traits>
 #include "../include/WebpageCounter.h"
 #include "../include/Logger.h"
 
@@ -42,61 +43,54 @@ WebpageCounter::WebpageCounter(size_t totalPages, std::shared_ptr<ILogger> logge
     , totalPages(totalPages)
     , metrics()
     , config(config)
+    , startTime(std::chrono::steady_clock::now())
 {
-    std::cout << "Starting constructor initialization..." << std::endl;
-
     if (!this->logger) {
         throw std::invalid_argument("Logger cannot be null");
     }
-    std::cout << "Logger validated..." << std::endl;
-
     if (totalPages <= 0) {
         throw std::invalid_argument("Total pages must be positive");
     }
-
-    if (totalPages > MAX_PAGES) {
-        throw std::invalid_argument("Total pages exceeds maximum allowed");
+    if (config.useStripedCounters && !config.counterFilePath.empty()) {
+        throw std::invalid_argument("Striped counters cannot be kept in a counter file");
     }
-    std::cout << "Bounds checking passed..." << std::endl;
 
     try {
-        std::cout << "Starting array initialization..." << std::endl;
-        
-        for (size_t i = 0; i < totalPages; ++i) {
-            std::cout << "Initializing page " << i << "..." << std::endl;
-            
-            try {
-                visitCounts[i].store(0, std::memory_order_relaxed);
-                std::cout << "Atomic initialized for page " << i << std::endl;
-                
-                mutexes[i] = std::make_unique<std::mutex>();
-                if (!mutexes[i]) {
-                    throw std::runtime_error("Failed to create mutex for page " + std::to_string(i));
-                }
-                std::cout << "Mutex created for page " << i << std::endl;
-            } catch (const std::exception& e) {
-                std::cerr << "Error initializing page " << i << ": " << e.what() << std::endl;
-                throw;
-            }
+        if (config.trackHeavyHitters || config.approximateUrlCounts) {
+            pageHitters = std::make_unique<HeavyHitterSketch>(config.heavyHitters);
+            urlHitters = std::make_unique<HeavyHitterSketch>(config.heavyHitters);
         }
 
-        for (size_t i = 0; i < totalPages; ++i) {
-            if (!mutexes[i]) {
-                throw std::runtime_error("Mutex verification failed for page " + std::to_string(i));
-            }
-            int count = visitCounts[i].load(std::memory_order_relaxed);
-            if (count != 0) {
-                throw std::runtime_error("Visit count verification failed for page " + std::to_string(i));
+        if (config.trackWindowedCounts) {
+            windowedCounts = std::make_unique<WindowedCounterArray>(totalPages);
+        }
+
+        if (config.useStripedCounters) {
+            stripedCounts = std::make_unique<StripedCounterArray>(totalPages, config.counterStripes);
+            stripedIncrements = std::make_unique<StripedCounterArray>(1, config.counterStripes);
+        } else {
+            // Nothing here touches every page, so startup does not grow with totalPages
+            if (config.counterFilePath.empty()) {
+                // calloc hands back untouched zero pages instead of clearing them here
+                static_assert(std::is_trivially_default_constructible<std::atomic<size_t>>::value,
+                              "Counts are used straight out of calloc");
+                ownedCounts.reset(static_cast<std::atomic<size_t>*>(std::calloc(totalPages, sizeof(std::atomic<size_t>))));
+                if (!ownedCounts) {
+                    throw std::bad_alloc();
+                }
+                visitCounts = ownedCounts.get();
+            } else {
+                counterFile = std::make_unique<CounterFile>(config.counterFilePath, totalPages);
+                visitCounts = counterFile->counters();
             }
+            numPageLocks = std::min(totalPages, MAX_PAGE_LOCKS);
+            pageLocks = std::make_unique<std::mutex[]>(numPageLocks);
         }
-        std::cout << "Initialization verification passed" << std::endl;
 
         if (config.enableLogging) {
-            this->logger->log("Initialized counter with " + std::to_string(totalPages) + " pages");
+            this->logger->logEvent(LogEvent::CounterInitialized, totalPages);
         }
-        std::cout << "Constructor initialization completed successfully" << std::endl;
     } catch (const std::exception& e) {
-        std::cerr << "Exception during initialization: " << e.what() << std::endl;
         throw std::runtime_error("Failed to initialize arrays: " + std::string(e.what()));
     }
 }
@@ -107,19 +101,37 @@ void WebpageCounter::incrementVisitCount(size_t pageIndex) {
         throw InvalidPageIndex(static_cast<int>(pageIndex));
     }
 
+    if (config.useStripedCounters) {
+        stripedCounts->add(pageIndex);
+        stripedIncrements->add(0);
+        if (pageHitters) {
+            pageHitters->add(pageIndex);
+        }
+        if (windowedCounts) {
+            windowedCounts->add(pageIndex, secondsSinceStart());
+        }
+        if (config.enableLogging) {
+            logger->logEvent(LogEvent::PageIncremented, pageIndex);
+        }
+        return;
+    }
+
     if (config.useAtomicOperations) {
         visitCounts[pageIndex].fetch_add(1, std::memory_order_relaxed);
     } else {
-        if (!mutexes[pageIndex]) {
-            throw std::runtime_error("Mutex not initialized for page " + std::to_string(pageIndex));
-        }
-        std::lock_guard<std::mutex> lock(*mutexes[pageIndex]);
+        std::lock_guard<std::mutex> lock(lockFor(pageIndex));
         visitCounts[pageIndex].store(visitCounts[pageIndex].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
     }
     metrics.totalIncrements.fetch_add(1, std::memory_order_relaxed);
+    if (pageHitters) {
+        pageHitters->add(pageIndex);
+    }
+    if (windowedCounts) {
+        windowedCounts->add(pageIndex, secondsSinceStart());
+    }
     
     if (config.enableLogging) {
-        logger->log("Incremented visit count for page " + std::to_string(pageIndex));
+        logger->logEvent(LogEvent::PageIncremented, pageIndex);
     }
 }
 
@@ -128,36 +140,100 @@ void WebpageCounter::batchIncrement(const std::vector<size_t>& indices) {
         return;
     }
 
-    std::vector<size_t> sortedIndices = indices;
-    std::sort(sortedIndices.begin(), sortedIndices.end());
-    sortedIndices.erase(std::unique(sortedIndices.begin(), sortedIndices.end()), sortedIndices.end());
-    
-    std::vector<std::unique_lock<std::mutex>> locks;
-    locks.reserve(sortedIndices.size());
-    
-    for (size_t index : sortedIndices) {
-        if (index < 0 || index >= totalPages) {
-            metrics.errorCount.fetch_add(1, std::memory_order_relaxed);
-            throw InvalidPageIndex(static_cast<int>(index));
+    // Check the whole batch before applying any of it. Written with subtract,
+    // not and or so that it vectorizes on plain SSE2, which has no 64-bit
+    // compare: for index < 2^63, index - totalPages borrows (top bit set)
+    // exactly when the index is in range, and larger indices set the top bit
+    // of index itself.
+    size_t outOfRange = 0;
+    for (size_t index : indices) {
+        outOfRange |= index | ~(index - totalPages);
+    }
+    if (outOfRange >> 63) {
+        metrics.errorCount.fetch_add(1, std::memory_order_relaxed);
+        size_t invalid = *std::find_if(indices.begin(), indices.end(), [this](size_t index) { return index >= totalPages; });
+        throw InvalidPageIndex(static_cast<int>(invalid));
+    }
+
+    thread_local std::vector<std::pair<size_t, size_t>> visits;
+    aggregateVisits(indices, visits);
+    const uint64_t now = windowedCounts ? secondsSinceStart() : 0;
+
+    // One add per distinct page. Nothing waits on another batch: atomic and
+    // striped counts are plain adds, and mutex mode holds one page lock at a time.
+    for (const auto& [page, count] : visits) {
+        if (config.useStripedCounters) {
+            stripedCounts->add(page, count);
+        } else if (config.useAtomicOperations) {
+            visitCounts[page].fetch_add(count, std::memory_order_relaxed);
+        } else {
+            std::lock_guard<std::mutex> lock(lockFor(page));
+            visitCounts[page].store(visitCounts[page].load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
         }
-        if (!mutexes[index]) {
-            throw std::runtime_error("Mutex not initialized for page " + std::to_string(index));
+        if (pageHitters) {
+            pageHitters->add(page, count);
         }
-        
-        std::unique_lock<std::mutex> lock(*mutexes[index], std::try_to_lock);
-        if (!lock.owns_lock()) {
-            throw std::runtime_error("Failed to acquire lock for page " + std::to_string(index));
+        if (windowedCounts) {
+            windowedCounts->add(page, now, count);
         }
-        locks.push_back(std::move(lock));
     }
-    
-    for (size_t index : sortedIndices) {
-        visitCounts[index].fetch_add(1, std::memory_order_relaxed);
-        metrics.totalIncrements.fetch_add(1, std::memory_order_relaxed);
+
+    // Scratch sized by a huge batch is not kept for the life of the thread
+    if (visits.capacity() > DENSE_TALLY_PAGES) {
+        std::vector<std::pair<size_t, size_t>>().swap(visits);
+    }
+
+    if (config.useStripedCounters) {
+        stripedIncrements->add(0, indices.size());
+    } else {
+        metrics.totalIncrements.fetch_add(indices.size(), std::memory_order_relaxed);
     }
-    
     if (config.enableLogging) {
-        logger->log("Batch incremented " + std::to_string(sortedIndices.size()) + " pages");
+        logger->logEvent(LogEvent::PagesBatchIncremented, indices.size());
+    }
+}
+
+void WebpageCounter::aggregateVisits(const std::vector<size_t>& indices, std::vector<std::pair<size_t, size_t>>& visits) const {
+    visits.clear();
+
+    // Dense per-thread tally when the page space is small next to the batch:
+    // one pass, no sort. The tally is left zeroed for the next batch, but only
+    // kept while it covers at most DENSE_TALLY_PAGES pages (256 KiB); a larger
+    // one was sized for a batch of comparable size and is freed afterwards.
+    if (totalPages <= std::max(DENSE_TALLY_PAGES, 4 * indices.size()) && indices.size() <= UINT32_MAX) {
+        thread_local std::vector<uint32_t> tally;
+        if (tally.size() < totalPages) {
+            tally.resize(totalPages);
+        }
+        for (size_t index : indices) {
+            if (tally[index]++ == 0) {
+                visits.emplace_back(index, 0);
+            }
+        }
+        for (auto& [page, count] : visits) {
+            count = tally[page];
+            tally[page] = 0;
+        }
+        if (tally.size() > DENSE_TALLY_PAGES) {
+            std::vector<uint32_t>().swap(tally);
+        }
+        return;
+    }
+
+    // Huge page space: sort a copy and count the runs
+    thread_local std::vector<size_t> sorted;
+    sorted.assign(indices.begin(), indices.end());
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 0; i < sorted.size();) {
+        size_t run = i + 1;
+        while (run < sorted.size() && sorted[run] == sorted[i]) {
+            ++run;
+        }
+        visits.emplace_back(sorted[i], run - i);
+        i = run;
+    }
+    if (sorted.capacity() > DENSE_TALLY_PAGES) {
+        std::vector<size_t>().swap(sorted);
     }
 }
 
@@ -167,44 +243,172 @@ size_t WebpageCounter::getVisitCount(size_t pageIndex) const {
         throw InvalidPageIndex(static_cast<int>(pageIndex));
     }
 
-    int count;
-    if (config.useAtomicOperations) {
+    size_t count;
+    if (config.useStripedCounters) {
+        count = stripedCounts->sum(pageIndex);
+    } else if (config.useAtomicOperations) {
         count = visitCounts[pageIndex].load(std::memory_order_relaxed);
     } else {
-        if (!mutexes[pageIndex]) {
-            throw std::runtime_error("Mutex not initialized for page " + std::to_string(pageIndex));
-        }
-        std::lock_guard<std::mutex> lock(*mutexes[pageIndex]);
+        std::lock_guard<std::mutex> lock(lockFor(pageIndex));
         count = visitCounts[pageIndex].load(std::memory_order_relaxed);
     }
     
     metrics.totalQueries.fetch_add(1, std::memory_order_relaxed);
     
     if (config.enableLogging) {
-        logger->log("Retrieved visit count for page " + std::to_string(pageIndex) + ": " + std::to_string(count));
+        logger->logEvent(LogEvent::PageQueried, pageIndex, count);
     }
     
     return count;
 }
 
+size_t WebpageCounter::getWindowedVisitCount(size_t pageIndex, TimeWindow window) const {
+    if (!windowedCounts) {
+        throw std::runtime_error("Windowed counts are not enabled");
+    }
+    if (pageIndex >= totalPages) {
+        metrics.errorCount.fetch_add(1, std::memory_order_relaxed);
+        throw InvalidPageIndex(static_cast<int>(pageIndex));
+    }
+    metrics.totalQueries.fetch_add(1, std::memory_order_relaxed);
+    return windowedCounts->count(pageIndex, window, secondsSinceStart());
+}
+
+double WebpageCounter::getVisitRate(size_t pageIndex, TimeWindow window) const {
+    if (!windowedCounts) {
+        throw std::runtime_error("Windowed counts are not enabled");
+    }
+    if (pageIndex >= totalPages) {
+        metrics.errorCount.fetch_add(1, std::memory_order_relaxed);
+        throw InvalidPageIndex(static_cast<int>(pageIndex));
+    }
+    metrics.totalQueries.fetch_add(1, std::memory_order_relaxed);
+    return windowedCounts->rate(pageIndex, window, secondsSinceStart());
+}
+
+uint64_t WebpageCounter::secondsSinceStart() const {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - startTime).count());
+}
+
+void WebpageCounter::incrementUrlVisitCount(std::string_view url) {
+    uint64_t key = ConcurrentCounterMap::keyFor(url);
+    if (!config.approximateUrlCounts) {
+        urlCounts.add(key);
+    }
+    if (urlHitters) {
+        urlHitters->add(key, 1, url);
+    }
+    if (config.useStripedCounters) {
+        stripedIncrements->add(0);
+    } else {
+        metrics.totalIncrements.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (config.enableLogging) {
+        logger->logEvent(LogEvent::UrlIncremented, 0, 0, url);
+    }
+}
+
+size_t WebpageCounter::getUrlVisitCount(std::string_view url) const {
+    uint64_t key = ConcurrentCounterMap::keyFor(url);
+    size_t count = config.approximateUrlCounts ? urlHitters->estimate(key) : urlCounts.get(key);
+    metrics.totalQueries.fetch_add(1, std::memory_order_relaxed);
+
+    if (config.enableLogging) {
+        logger->logEvent(LogEvent::UrlQueried, 0, count, url);
+    }
+    return count;
+}
+
+size_t WebpageCounter::getTrackedUrlCount() const {
+    return urlCounts.size();
+}
+
+std::vector<std::pair<size_t, size_t>> WebpageCounter::topPages(size_t k) const {
+    if (!pageHitters) {
+        throw std::runtime_error("Heavy-hitter tracking is not enabled");
+    }
+    std::vector<std::pair<size_t, size_t>> pages;
+    for (const auto& entry : pageHitters->topK(k)) {
+        pages.emplace_back(entry.key, entry.count);
+    }
+    metrics.totalQueries.fetch_add(1, std::memory_order_relaxed);
+    return pages;
+}
+
+std::vector<std::pair<std::string, size_t>> WebpageCounter::topUrls(size_t k) const {
+    if (!urlHitters) {
+        throw std::runtime_error("Heavy-hitter tracking is not enabled");
+    }
+    std::vector<std::pair<std::string, size_t>> urls;
+    for (auto& entry : urlHitters->topK(k)) {
+        urls.emplace_back(std::move(entry.label), entry.count);
+    }
+    metrics.totalQueries.fetch_add(1, std::memory_order_relaxed);
+    return urls;
+}
+
+void WebpageCounter::syncToDisk() const {
+    if (!counterFile) {
+        throw std::runtime_error("Page counts are not kept in a counter file");
+    }
+    counterFile->syncToDisk();
+}
+
+void WebpageCounter::checkpoint(const std::string& path) const {
+    if (!counterFile) {
+        throw std::runtime_error("Page counts are not kept in a counter file");
+    }
+    counterFile->checkpoint(path);
+}
+
 Metrics WebpageCounter::getMetrics() const {
-    return metrics;
+    Metrics snapshot = metrics;
+    if (config.useStripedCounters) {
+        snapshot.totalIncrements = stripedIncrements->sum(0);
+    }
+    return snapshot;
 }
 
 void WebpageCounter::reset() {
+    if (config.useStripedCounters) {
+        stripedCounts->reset();
+        stripedIncrements->reset();
+        urlCounts.clear();
+        if (pageHitters) {
+            pageHitters->clear();
+            urlHitters->clear();
+        }
+        if (windowedCounts) {
+            windowedCounts->reset();
+        }
+        metrics = Metrics{};
+        if (config.enableLogging) {
+            logger->logEvent(LogEvent::CountersReset);
+        }
+        return;
+    }
+
     std::vector<std::unique_lock<std::mutex>> locks;
-    locks.reserve(totalPages);
-    
+    locks.reserve(numPageLocks);
+    for (size_t i = 0; i < numPageLocks; ++i) {
+        locks.emplace_back(pageLocks[i]);
+    }
     for (size_t i = 0; i < totalPages; ++i) {
-        if (!mutexes[i]) {
-            throw std::runtime_error("Mutex not initialized for page " + std::to_string(i));
-        }
-        locks.emplace_back(*mutexes[i]);
         visitCounts[i].store(0, std::memory_order_relaxed);
     }
     
+    urlCounts.clear();
+    if (pageHitters) {
+        pageHitters->clear();
+        urlHitters->clear();
+    }
+    if (windowedCounts) {
+        windowedCounts->reset();
+    }
     metrics = Metrics{};
     if (config.enableLogging) {
-        logger->log("Reset all counters");
+        logger->logEvent(LogEvent::CountersReset);
     }
 }
@@ -0,0 +1,75 @@
+#include "../include/WindowedCounter.h"
+#include <algorithm>
+#include <stdexcept>
+
+WindowedCounterArray::WindowedCounterArray(size_t size)
+    : numCounters(size)
+{
+    if (size == 0) {
+        throw std::invalid_argument("Windowed counter array must hold at least one counter");
+    }
+    static_assert(RINGS[2].offset + RINGS[2].buckets == BUCKETS_PER_COUNTER, "rings must fill a counter's buckets");
+    buckets = std::make_unique<std::atomic<uint64_t>[]>(size * BUCKETS_PER_COUNTER);
+    reset();
+}
+
+void WindowedCounterArray::add(size_t index, uint64_t nowSeconds, uint64_t delta) {
+    std::atomic<uint64_t>* counter = bucketsFor(index);
+    for (const Ring& ring : RINGS) {
+        uint64_t slot = nowSeconds / ring.bucketSeconds;
+        uint64_t tag = slot & TAG_MASK;
+        std::atomic<uint64_t>& bucket = counter[ring.offset + slot % ring.buckets];
+
+        uint64_t word = bucket.load(std::memory_order_relaxed);
+        for (;;) {
+            // How many slots the bucket is behind; a huge value means it is
+            // ahead, i.e. this caller is late, and the visit goes in anyway.
+            // An empty bucket has nothing to keep and is always claimed, so a
+            // never-used bucket (tag 0) cannot pass for one that is ahead.
+            uint64_t behind = (tag - (word >> COUNT_BITS)) & TAG_MASK;
+            bool ahead = behind > TAG_MASK / 2 && (word & COUNT_MASK) != 0;
+            if (behind == 0 || ahead) {
+                bucket.fetch_add(delta, std::memory_order_relaxed);
+                break;
+            }
+            // Left over from an earlier pass round the ring: restart it
+            if (bucket.compare_exchange_weak(word, (tag << COUNT_BITS) | delta, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+    }
+}
+
+uint64_t WindowedCounterArray::count(size_t index, TimeWindow window, uint64_t nowSeconds) const {
+    const Ring& ring = RINGS[static_cast<size_t>(window)];
+    const std::atomic<uint64_t>* counter = bucketsFor(index) + ring.offset;
+    uint64_t tag = (nowSeconds / ring.bucketSeconds) & TAG_MASK;
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < ring.buckets; ++i) {
+        uint64_t word = counter[i].load(std::memory_order_relaxed);
+        if (((tag - (word >> COUNT_BITS)) & TAG_MASK) < ring.buckets) {
+            total += word & COUNT_MASK;
+        }
+    }
+    return total;
+}
+
+double WindowedCounterArray::rate(size_t index, TimeWindow window, uint64_t nowSeconds) const {
+    const Ring& ring = RINGS[static_cast<size_t>(window)];
+    // Full buckets before the current one, plus the part of the current one so far
+    uint64_t covered = (ring.buckets - 1) * ring.bucketSeconds + nowSeconds % ring.bucketSeconds + 1;
+    covered = std::min(covered, nowSeconds + 1);
+    return static_cast<double>(count(index, window, nowSeconds)) / static_cast<double>(covered);
+}
+
+void WindowedCounterArray::reset() {
+    for (size_t i = 0; i < numCounters * BUCKETS_PER_COUNTER; ++i) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t WindowedCounterArray::windowSeconds(TimeWindow window) {
+    const Ring& ring = RINGS[static_cast<size_t>(window)];
+    return ring.buckets * ring.bucketSeconds;
+}
@@ -1,8 +1,25 @@
 #include "../include/WebpageCounter.h"
 #include "../include/Logger.h"
+#include "../include/ConcurrentCounterMap.h"
+#include "../include/CounterFile.h"
+#include "../include/WindowedCounter.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
+#include <string>
 #include <thread>
 #include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+void expectEqual(size_t actual, size_t expected, const std::string& what) {
+    if (actual != expected) {
+        throw std::runtime_error(what + ": expected " + std::to_string(expected) + ", got " + std::to_string(actual));
+    }
+}
 
 void runSingleThreadTest(WebpageCounter& counter) {
     std::cout << "\nTest Case 1: Single thread operations" << std::endl;
@@ -66,6 +83,630 @@ void runMultiThreadTest(WebpageCounter& counter) {
     std::cout << "Error count: " << metrics.errorCount << std::endl;
 }
 
+void runStripedCounterTest(std::shared_ptr<ILogger> logger) {
+    std::cout << "\nTest Case 3: Striped counters" << std::endl;
+    Config config;
+    config.enableLogging = false;
+    config.useStripedCounters = true;
+    config.counterStripes = 4;
+    WebpageCounter counter(10, std::move(logger), config);
+
+    const int numThreads = 8;  // more threads than stripes, so stripes are shared
+    const int incrementsPerThread = 10000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&counter, i]() {
+            for (int j = 0; j < incrementsPerThread; ++j) {
+                counter.incrementVisitCount(0);
+                counter.incrementVisitCount(1 + i % 2);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    expectEqual(counter.getVisitCount(0), numThreads * incrementsPerThread, "Striped page 0");
+    expectEqual(counter.getVisitCount(1), numThreads / 2 * incrementsPerThread, "Striped page 1");
+    expectEqual(counter.getVisitCount(2), numThreads / 2 * incrementsPerThread, "Striped page 2");
+    expectEqual(counter.getVisitCount(3), 0, "Striped page 3");
+
+    counter.batchIncrement({3, 4, 9});
+    expectEqual(counter.getVisitCount(9), 1, "Striped batch page 9");
+    expectEqual(counter.getMetrics().totalIncrements, 2 * numThreads * incrementsPerThread + 3, "Striped total increments");
+
+    bool threw = false;
+    try {
+        counter.incrementVisitCount(10);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    expectEqual(threw, true, "Striped out-of-range increment throws");
+
+    counter.reset();
+    expectEqual(counter.getVisitCount(0), 0, "Striped page 0 after reset");
+    expectEqual(counter.getMetrics().totalIncrements, 0, "Striped total increments after reset");
+    std::cout << "Striped counters passed" << std::endl;
+}
+
+void runCounterMapTest() {
+    std::cout << "\nTest Case 4: Growing counter map" << std::endl;
+    ConcurrentCounterMap map;
+
+    // Enough distinct keys for several doublings while other threads keep
+    // incrementing a shared set of keys that has to survive every copy
+    const int numThreads = 4;
+    const uint64_t keysPerThread = 20000;
+    const uint64_t sharedKeys = 64;
+    const int sharedRounds = 200;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&map, t]() {
+            for (uint64_t i = 0; i < keysPerThread; ++i) {
+                map.add(1000000 + t * keysPerThread + i, i % 3 + 1);
+                if (i % (keysPerThread / sharedRounds) == 0) {
+                    for (uint64_t key = 1; key <= sharedKeys; ++key) {
+                        map.add(key);
+                    }
+                }
+            }
+        });
+    }
+    // Concurrent reader: shared counts never go backwards
+    std::atomic<bool> done{false};
+    std::atomic<bool> wentBackwards{false};
+    std::thread reader([&map, &done, &wentBackwards]() {
+        uint64_t last = 0;
+        while (!done.load()) {
+            uint64_t current = map.get(1);
+            if (current < last) {
+                wentBackwards = true;
+            }
+            last = current;
+        }
+    });
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    done = true;
+    reader.join();
+    expectEqual(wentBackwards, false, "Shared count monotonic during resize");
+
+    expectEqual(map.size(), numThreads * keysPerThread + sharedKeys, "Distinct keys");
+    for (int t = 0; t < numThreads; ++t) {
+        for (uint64_t i = 0; i < keysPerThread; ++i) {
+            expectEqual(map.get(1000000 + t * keysPerThread + i), i % 3 + 1, "Private key count");
+        }
+    }
+    for (uint64_t key = 1; key <= sharedKeys; ++key) {
+        expectEqual(map.get(key), numThreads * sharedRounds, "Shared key count");
+    }
+    expectEqual(map.get(999), 0, "Missing key");
+    if (map.capacity() < numThreads * keysPerThread) {
+        throw std::runtime_error("Counter map did not grow");
+    }
+
+    bool threw = false;
+    try {
+        map.add(ConcurrentCounterMap::EMPTY_KEY);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    expectEqual(threw, true, "Reserved key rejected");
+
+    map.clear();
+    expectEqual(map.size(), 0, "Keys after clear");
+    expectEqual(map.get(1), 0, "Shared key after clear");
+    map.add(1);
+    expectEqual(map.get(1), 1, "Key added after clear");
+    std::cout << "Growing counter map passed" << std::endl;
+}
+
+void runUrlCounterTest(std::shared_ptr<ILogger> logger) {
+    std::cout << "\nTest Case 5: URL counters beyond the old 1000 page limit" << std::endl;
+    Config config;
+    config.enableLogging = false;
+    config.useStripedCounters = true;
+    WebpageCounter counter(5000, std::move(logger), config);
+
+    counter.incrementVisitCount(4999);
+    expectEqual(counter.getVisitCount(4999), 1, "Page 4999");
+
+    for (int i = 0; i < 3000; ++i) {
+        counter.incrementUrlVisitCount("https://example.com/page/" + std::to_string(i));
+    }
+    counter.incrementUrlVisitCount("https://example.com/page/7");
+    expectEqual(counter.getTrackedUrlCount(), 3000, "Tracked URLs");
+    expectEqual(counter.getUrlVisitCount("https://example.com/page/7"), 2, "URL page 7");
+    expectEqual(counter.getUrlVisitCount("https://example.com/page/2999"), 1, "URL page 2999");
+    expectEqual(counter.getUrlVisitCount("https://example.com/missing"), 0, "Missing URL");
+    expectEqual(counter.getMetrics().totalIncrements, 3002, "Total increments with URLs");
+
+    counter.reset();
+    expectEqual(counter.getTrackedUrlCount(), 0, "Tracked URLs after reset");
+    std::cout << "URL counters passed" << std::endl;
+}
+
+void runAsyncLoggerTest() {
+    std::cout << "\nTest Case 6: Asynchronous logger" << std::endl;
+    const std::string path = "webpage_counter_test_async.log";
+    const int numThreads = 4;
+    const uint64_t messagesPerThread = 20000;
+    {
+        LoggerOptions options;
+        options.threadBufferBytes = 4096;  // small ring so producers wrap and wait on the writer
+        auto logger = Logger::create(path, options);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&logger, t]() {
+                for (uint64_t i = 0; i < messagesPerThread; ++i) {
+                    logger->logEvent(LogEvent::PageQueried, t, i);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        logger->log("plain text message");
+        logger->logEvent(LogEvent::UrlIncremented, 0, 0, "https://example.com/a");
+        logger->flush();
+        expectEqual(logger->droppedMessages(), 0, "Dropped messages");
+    }
+
+    // Every message arrives, each thread's in order, formatted like the old synchronous logger
+    std::ifstream in(path);
+    std::string line;
+    std::vector<uint64_t> nextExpected(numThreads, 0);
+    size_t lines = 0;
+    const std::string prefix = "Retrieved visit count for page ";
+    while (std::getline(in, line)) {
+        ++lines;
+        if (line.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        size_t colon = line.find(':');
+        int thread = std::stoi(line.substr(prefix.size(), colon - prefix.size()));
+        uint64_t value = std::stoull(line.substr(colon + 2));
+        expectEqual(value, nextExpected[thread]++, "Per-thread log order");
+    }
+    for (int t = 0; t < numThreads; ++t) {
+        expectEqual(nextExpected[t], messagesPerThread, "Messages per thread");
+    }
+    expectEqual(lines, numThreads * messagesPerThread + 2, "Log lines");
+    in.close();
+    std::remove(path.c_str());
+
+    // A producer blocked on a full ring wakes the writer rather than waiting
+    // out its idle sleep: 20000 messages through a 4 KiB ring fill it hundreds
+    // of times, which would take minutes at one idleWait per refill
+    {
+        LoggerOptions options;
+        options.threadBufferBytes = 4096;
+        options.idleWait = std::chrono::milliseconds(1000);
+        auto logger = Logger::create(path, options);
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < messagesPerThread; ++i) {
+            logger->logEvent(LogEvent::PageQueried, 0, i);
+        }
+        logger->flush();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        expectEqual(elapsed < std::chrono::seconds(20), 1, "Full ring wakes the writer");
+    }
+    std::remove(path.c_str());
+
+    // Drop mode never waits and reports what it lost
+    const size_t submitted = 100000;
+    uint64_t dropped = 0;
+    {
+        LoggerOptions options;
+        options.threadBufferBytes = 4096;
+        options.dropWhenFull = true;
+        auto logger = Logger::create(path, options);
+        for (size_t i = 0; i < submitted; ++i) {
+            logger->logEvent(LogEvent::PageIncremented, i);
+        }
+        logger->flush();
+        dropped = logger->droppedMessages();
+        std::cout << "Drop mode dropped " << dropped << " of " << submitted << " messages" << std::endl;
+    }
+    // Every message is either written or counted as dropped, and the drops
+    // reported in the file add up to the counter
+    in.open(path);
+    size_t written = 0;
+    uint64_t reported = 0;
+    const std::string droppedPrefix = "Dropped ";
+    while (std::getline(in, line)) {
+        if (line.compare(0, droppedPrefix.size(), droppedPrefix) == 0) {
+            reported += std::stoull(line.substr(droppedPrefix.size()));
+        } else {
+            ++written;
+        }
+    }
+    in.close();
+    expectEqual(dropped > 0, 1, "Drop mode drops when the ring is full");
+    expectEqual(written + dropped, submitted, "Written plus dropped messages");
+    expectEqual(reported, dropped, "Reported drops");
+    std::remove(path.c_str());
+
+    // Threads alternating between two loggers keep one ring per logger each,
+    // so neither logger's per-thread order is disturbed by the switching
+    const std::string otherPath = "webpage_counter_test_async_other.log";
+    {
+        auto first = Logger::create(path);
+        auto second = Logger::create(otherPath);
+        std::atomic<int> started{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; ++t) {
+            threads.emplace_back([&first, &second, &started, t]() {
+                for (uint64_t i = 0; i < 5000; ++i) {
+                    first->logEvent(LogEvent::PageQueried, t, i);
+                    second->logEvent(LogEvent::PageQueried, t, i);
+                    if (i == 0) {
+                        // Both threads hold their rings before either can finish
+                        ++started;
+                        while (started.load() < 2) {
+                            std::this_thread::yield();
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        first->flush();
+        second->flush();
+        expectEqual(first->ringCount(), 2, "Rings of the first logger");
+        expectEqual(second->ringCount(), 2, "Rings of the second logger");
+    }
+    for (const std::string& file : {path, otherPath}) {
+        in.open(file);
+        std::vector<uint64_t> next(2, 0);
+        while (std::getline(in, line)) {
+            size_t colon = line.find(':');
+            int thread = std::stoi(line.substr(prefix.size(), colon - prefix.size()));
+            expectEqual(std::stoull(line.substr(colon + 2)), next[thread]++, "Per-thread order across loggers");
+        }
+        in.close();
+        expectEqual(next[0] + next[1], 10000, "Messages per logger");
+        std::remove(file.c_str());
+    }
+    std::cout << "Asynchronous logger passed" << std::endl;
+}
+
+void runHeavyHitterTest(std::shared_ptr<ILogger> logger) {
+    std::cout << "\nTest Case 7: Approximate heavy hitters" << std::endl;
+    Config config;
+    config.enableLogging = false;
+    config.useAtomicOperations = true;
+    config.approximateUrlCounts = true;
+    config.heavyHitters.width = 16384;
+    config.heavyHitters.shards = 4;
+    WebpageCounter counter(50, std::move(logger), config);
+
+    // Ten hot URLs, 4 * (500 - 40h) visits each, buried in 200000 one-off URLs
+    const int numThreads = 4;
+    const int hotUrls = 10;
+    const int coldPerThread = 50000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&counter, t]() {
+            int hotLeft[hotUrls];
+            for (int h = 0; h < hotUrls; ++h) {
+                hotLeft[h] = 500 - 40 * h;
+            }
+            for (int i = 0; i < coldPerThread; ++i) {
+                counter.incrementUrlVisitCount("https://example.com/cold/" + std::to_string(t) + "/" + std::to_string(i));
+                int h = i % hotUrls;
+                if (hotLeft[h] > 0) {
+                    --hotLeft[h];
+                    counter.incrementUrlVisitCount("https://example.com/hot/" + std::to_string(h));
+                }
+                counter.incrementVisitCount(i % 7 == 0 ? 42 : i % 50);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Estimates may only overcount, by at most e * N / width with high probability
+    const size_t totalUrlVisits = numThreads * coldPerThread + numThreads * (hotUrls * 500 - 40 * 45);
+    const size_t errorBound = static_cast<size_t>(2.72 * totalUrlVisits / 16384) + 1;
+    auto top = counter.topUrls(hotUrls);
+    expectEqual(top.size(), hotUrls, "Top URL count");
+    for (int h = 0; h < hotUrls; ++h) {
+        size_t expected = numThreads * (500 - 40 * h);
+        expectEqual(top[h].first == "https://example.com/hot/" + std::to_string(h), 1, "Top URL rank " + std::to_string(h));
+        expectEqual(top[h].second >= expected && top[h].second <= expected + errorBound, 1, "Top URL estimate " + std::to_string(h));
+    }
+    expectEqual(counter.getUrlVisitCount("https://example.com/cold/0/0") >= 1, 1, "Cold URL estimate");
+    expectEqual(counter.getTrackedUrlCount(), 0, "Exact URL map unused");
+
+    auto pages = counter.topPages(1);
+    expectEqual(pages.size(), 1, "Top page count");
+    expectEqual(pages[0].first, 42, "Top page");
+    expectEqual(pages[0].second >= counter.getVisitCount(42), 1, "Top page estimate");
+
+    counter.reset();
+    expectEqual(counter.topUrls(5).size(), 0, "Top URLs after reset");
+
+    Config exact;
+    exact.enableLogging = false;
+    WebpageCounter untracked(1, Logger::getInstance(), exact);
+    bool threw = false;
+    try {
+        untracked.topPages(1);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    expectEqual(threw, 1, "topPages without tracking throws");
+    std::cout << "Approximate heavy hitters passed" << std::endl;
+}
+
+void runWindowedCounterTest(std::shared_ptr<ILogger> logger) {
+    std::cout << "\nTest Case 8: Windowed visit counts" << std::endl;
+    WindowedCounterArray windows(2);
+
+    // One visit a second for two minutes
+    for (uint64_t t = 0; t < 120; ++t) {
+        windows.add(0, t);
+    }
+    expectEqual(windows.count(0, TimeWindow::Minute, 119), 60, "Last minute");
+    expectEqual(windows.count(0, TimeWindow::Hour, 119), 120, "Last hour");
+    expectEqual(windows.count(0, TimeWindow::Day, 119), 120, "Last day");
+    expectEqual(windows.count(1, TimeWindow::Day, 119), 0, "Untouched counter");
+    expectEqual(windows.rate(0, TimeWindow::Minute, 119) == 1.0, 1, "Minute rate");
+    expectEqual(windows.rate(0, TimeWindow::Hour, 119) == 1.0, 1, "Hour rate over the time covered so far");
+
+    // Two hours later the minute and hour rings have gone stale without being touched
+    const uint64_t later = 2 * 3600 + 5;
+    expectEqual(windows.count(0, TimeWindow::Minute, later), 0, "Minute after two hours");
+    expectEqual(windows.count(0, TimeWindow::Hour, later), 0, "Hour after two hours");
+    expectEqual(windows.count(0, TimeWindow::Day, later), 120, "Day after two hours");
+
+    // Landing on a stale bucket restarts it
+    windows.add(0, later);
+    expectEqual(windows.count(0, TimeWindow::Minute, later), 1, "Minute after restarting a bucket");
+    expectEqual(windows.count(0, TimeWindow::Day, 25 * 3600), 1, "Day after 25 hours");
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&windows]() {
+            for (int i = 0; i < 10000; ++i) {
+                windows.add(1, 100000 + i % 3);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    expectEqual(windows.count(1, TimeWindow::Minute, 100002), 40000, "Concurrent windowed increments");
+
+    // A bucket last used 8388660 s (about 97 days) earlier is stale and must
+    // be restarted, even though that gap is past half of a 24-bit tag range
+    WindowedCounterArray longLived(1);
+    longLived.add(0, 0);
+    const uint64_t halfWrapLater = 60 * 139811;
+    longLived.add(0, halfWrapLater);
+    expectEqual(longLived.count(0, TimeWindow::Minute, halfWrapLater), 1, "Minute after 97 idle days");
+    expectEqual(longLived.count(0, TimeWindow::Day, halfWrapLater), 1, "Day after 97 idle days");
+
+    // Slots keep counting across the 32-bit tag boundary
+    const uint64_t wrap = uint64_t{1} << 32;
+    longLived.add(0, wrap - 30);
+    longLived.add(0, wrap + 10);
+    expectEqual(longLived.count(0, TimeWindow::Minute, wrap + 10), 2, "Minute across the tag wrap");
+    expectEqual(longLived.count(0, TimeWindow::Minute, wrap + 45), 1, "Minute after the tag wrap");
+
+    Config config;
+    config.enableLogging = false;
+    config.useAtomicOperations = true;
+    config.trackWindowedCounts = true;
+    WebpageCounter counter(4, logger, config);
+    for (int i = 0; i < 5; ++i) {
+        counter.incrementVisitCount(3);
+    }
+    counter.batchIncrement({3, 2});
+    expectEqual(counter.getWindowedVisitCount(3, TimeWindow::Minute), 6, "Counter last minute");
+    expectEqual(counter.getWindowedVisitCount(2, TimeWindow::Day), 1, "Counter last day");
+    expectEqual(counter.getVisitRate(3, TimeWindow::Minute) > 0, 1, "Counter minute rate");
+    counter.reset();
+    expectEqual(counter.getWindowedVisitCount(3, TimeWindow::Hour), 0, "Windowed after reset");
+
+    Config untrackedConfig;
+    untrackedConfig.enableLogging = false;
+    WebpageCounter untracked(1, logger, untrackedConfig);
+    bool threw = false;
+    try {
+        untracked.getVisitRate(0, TimeWindow::Minute);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    expectEqual(threw, 1, "Windowed query without tracking throws");
+    std::cout << "Windowed visit counts passed" << std::endl;
+}
+
+void runCounterFileTest(std::shared_ptr<ILogger> logger) {
+    std::cout << "\nTest Case 9: Counters in a memory-mapped file" << std::endl;
+    const std::string path = "webpage_counter_test_counts.bin";
+    const std::string checkpointPath = "webpage_counter_test_checkpoint.bin";
+    std::remove(path.c_str());
+    std::remove(checkpointPath.c_str());
+
+    Config config;
+    config.enableLogging = false;
+    config.useAtomicOperations = true;
+    config.counterFilePath = path;
+    {
+        WebpageCounter counter(1000, logger, config);
+        for (int i = 0; i < 3; ++i) {
+            counter.incrementVisitCount(7);
+        }
+        counter.incrementVisitCount(999);
+        counter.batchIncrement({1, 2, 7});
+        counter.syncToDisk();
+        counter.checkpoint(checkpointPath);
+        counter.incrementVisitCount(7);
+    }
+
+    // Reopening picks up where the last process stopped, and can add pages
+    {
+        WebpageCounter counter(2000, logger, config);
+        expectEqual(counter.getVisitCount(7), 5, "Page 7 after reopening");
+        expectEqual(counter.getVisitCount(999), 1, "Page 999 after reopening");
+        expectEqual(counter.getVisitCount(2), 1, "Page 2 after reopening");
+        expectEqual(counter.getVisitCount(1999), 0, "New page after reopening");
+    }
+    {
+        CounterFile checkpoint(checkpointPath, 1000);
+        expectEqual(checkpoint.counters()[7].load(), 4, "Page 7 in checkpoint");
+        expectEqual(checkpoint.counters()[999].load(), 1, "Page 999 in checkpoint");
+    }
+
+    // A file with more pages than asked for, or that is not a counter file, is refused
+    bool threw = false;
+    try {
+        WebpageCounter counter(10, logger, config);
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    expectEqual(threw, 1, "Counter file larger than requested");
+    {
+        std::ofstream junk(checkpointPath, std::ios::trunc);
+        junk << "not a counter file, not a counter file, not a counter file, not a counter file";
+    }
+    threw = false;
+    try {
+        CounterFile junk(checkpointPath, 10);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    expectEqual(threw, 1, "Junk file refused");
+
+    // Counts survive a process that dies without unmapping or syncing
+    pid_t child = fork();
+    if (child == 0) {
+        CounterFile file(path, 2000);
+        file.counters()[1500].fetch_add(42);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    expectEqual(WIFEXITED(status) && WEXITSTATUS(status) == 0, 1, "Crashing child exited");
+    {
+        WebpageCounter counter(2000, logger, config);
+        expectEqual(counter.getVisitCount(1500), 42, "Page 1500 written by the crashed process");
+    }
+
+    // Checkpoints taken while writers run never go backwards and end with every increment
+    {
+        WebpageCounter counter(2000, logger, config);
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 2; ++t) {
+            writers.emplace_back([&counter]() {
+                for (int i = 0; i < 100000; ++i) {
+                    counter.incrementVisitCount(0);
+                }
+            });
+        }
+        size_t previous = 0;
+        for (int i = 0; i < 5; ++i) {
+            counter.checkpoint(checkpointPath);
+            CounterFile checkpoint(checkpointPath, 2000);
+            size_t seen = checkpoint.counters()[0].load();
+            expectEqual(seen >= previous, 1, "Checkpoints are monotone");
+            previous = seen;
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+        counter.checkpoint(checkpointPath);
+        CounterFile checkpoint(checkpointPath, 2000);
+        expectEqual(checkpoint.counters()[0].load(), 200000, "Final checkpoint");
+    }
+
+    Config striped;
+    striped.useStripedCounters = true;
+    striped.counterFilePath = path;
+    threw = false;
+    try {
+        WebpageCounter counter(10, logger, striped);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    expectEqual(threw, 1, "Striped counters refuse a counter file");
+
+    std::remove(path.c_str());
+    std::remove(checkpointPath.c_str());
+    std::cout << "Counter file passed" << std::endl;
+}
+
+void runBatchIncrementTest(std::shared_ptr<ILogger> logger) {
+    std::cout << "\nTest Case 10: Batch increments" << std::endl;
+    Config mutexConfig;
+    mutexConfig.enableLogging = false;
+    Config atomicConfig = mutexConfig;
+    atomicConfig.useAtomicOperations = true;
+    Config stripedConfig = mutexConfig;
+    stripedConfig.useStripedCounters = true;
+
+    for (const Config& config : {mutexConfig, atomicConfig, stripedConfig}) {
+        WebpageCounter counter(10, logger, config);
+
+        // Duplicates count once per listing
+        counter.batchIncrement({1, 1, 0, 1});
+        expectEqual(counter.getVisitCount(1), 3, "Duplicated page in batch");
+        expectEqual(counter.getVisitCount(0), 1, "Single page in batch");
+        expectEqual(counter.getMetrics().totalIncrements, 4, "Batch increments");
+
+        // An invalid index rejects the whole batch
+        bool threw = false;
+        try {
+            counter.batchIncrement({2, 10, 2});
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        expectEqual(threw, 1, "Invalid index in batch throws");
+        expectEqual(counter.getVisitCount(2), 0, "Rejected batch applies nothing");
+
+        // Overlapping batches from many threads never fail
+        std::atomic<size_t> failures{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&counter, &failures]() {
+                for (int i = 0; i < 2000; ++i) {
+                    try {
+                        counter.batchIncrement({5, 6, 5, 7});
+                    } catch (const std::exception&) {
+                        failures.fetch_add(1);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        expectEqual(failures.load(), 0, "Failed batches under contention");
+        expectEqual(counter.getVisitCount(5), 16000, "Page 5 after concurrent batches");
+        expectEqual(counter.getVisitCount(7), 8000, "Page 7 after concurrent batches");
+    }
+
+    // A page space too large for the dense tally goes through the sorting path
+    WebpageCounter large(1 << 20, logger, atomicConfig);
+    std::vector<size_t> batch;
+    for (size_t i = 0; i < 3000; ++i) {
+        batch.push_back((i % 1000) * 1000);
+    }
+    large.batchIncrement(batch);
+    expectEqual(large.getVisitCount(0), 3, "Sorted batch page 0");
+    expectEqual(large.getVisitCount(999000), 3, "Sorted batch page 999000");
+    expectEqual(large.getVisitCount(1), 0, "Sorted batch untouched page");
+    expectEqual(large.getMetrics().totalIncrements, 3000, "Sorted batch increments");
+    std::cout << "Batch increments passed" << std::endl;
+}
+
 int main() {
     try {
         std::cout << "Starting WebpageCounter Test..." << std::endl;
@@ -91,6 +732,14 @@ int main() {
         // Run tests
         runSingleThreadTest(counter);
         runMultiThreadTest(counter);
+        runStripedCounterTest(Logger::getInstance());
+        runCounterMapTest();
+        runUrlCounterTest(Logger::getInstance());
+        runAsyncLoggerTest();
+        runHeavyHitterTest(Logger::getInstance());
+        runWindowedCounterTest(Logger::getInstance());
+        runCounterFileTest(Logger::getInstance());
+        runBatchIncrementTest(Logger::getInstance());
         
         // Final reset and check
         std::cout << "\nResetting counters again..." << std::endl;
@@ -0,0 +1,101 @@
+#include "../include/document.h"
+#include "../include/document_renderer.h"
+#include "../include/render_engine.h"
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Renders a generated document of about the requested size, first one
+// element at a time as before, then through RenderEngine cold, unchanged,
+// and after single edits.
+//
+// Usage: render_benchmark [megabytes=256]
+
+namespace {
+
+void buildDocument(size_t targetBytes) {
+    Document* doc = Document::getInstance();
+    doc->clear();
+    const std::string sentence = "The quick brown fox jumps over the lazy dog.\n";
+    size_t bytes = 0;
+    for (size_t i = 0; bytes < targetBytes; ++i) {
+        if (i % 10 == 9) {
+            auto table = std::make_unique<TableElement>(8, 4);
+            for (int row = 0; row < 8; ++row) {
+                for (int col = 0; col < 4; ++col) {
+                    table->setCell(row, col, "cell " + std::to_string(i + row * 4 + col));
+                }
+            }
+            doc->addElement(std::move(table));
+            bytes += 400;
+        } else if (i % 10 == 4) {
+            doc->addElement(std::make_unique<ImageElement>("images/photo_" + std::to_string(i) + ".jpg", 1920, 1080));
+            bytes += 20;
+        } else {
+            std::string text;
+            for (size_t s = 0; s < 20; ++s) {
+                text += sentence;
+            }
+            doc->addElement(std::make_unique<TextElement>(text, "normal"));
+            bytes += text.size();
+        }
+    }
+}
+
+void measure(const std::string& name, const std::function<size_t()>& step) {
+    auto start = std::chrono::steady_clock::now();
+    size_t bytes = step();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(6)
+              << std::setw(10) << seconds << " s" << std::setw(8) << bytes / (1024 * 1024) << " MB";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256;
+    Document* doc = Document::getInstance();
+
+    std::cout << "Building a " << megabytes << " MB document..." << std::endl;
+    buildDocument(megabytes * 1024 * 1024);
+    size_t elements = doc->size();
+    std::cout << elements << " elements" << std::endl;
+
+    // The previous way: a strategy per element, appended one by one
+    measure("one at a time", [&] {
+        TextRenderer text;
+        ImageRenderer image;
+        TableRenderer table;
+        std::string output;
+        for (const auto& element : doc->getElements()) {
+            IRenderer* strategy = &text;
+            if (element->getType() == "image") {
+                strategy = &image;
+            } else if (element->getType() == "table") {
+                strategy = &table;
+            }
+            output += DocumentRenderer(strategy).render(*element);
+            output += '\n';
+        }
+        return output.size();
+    });
+    std::cout << std::endl;
+
+    RenderEngine engine;
+    auto renderStep = [&](const std::string& name) {
+        measure(name, [&] { return engine.render(doc->getElements()).size(); });
+        std::cout << std::setw(10) << engine.renderedLastTime() << " rendered" << std::endl;
+    };
+    renderStep("engine, cold");
+    renderStep("engine, unchanged");
+    static_cast<TextElement&>(doc->editElement(elements / 2 - 1)).setContent("Edited paragraph");
+    renderStep("engine, 1 edit");
+    doc->insertElement(elements / 3, std::make_unique<TextElement>("Inserted paragraph"));
+    renderStep("engine, 1 insert");
+    doc->removeElement(elements / 4);
+    renderStep("engine, 1 removal");
+    return 0;
+}
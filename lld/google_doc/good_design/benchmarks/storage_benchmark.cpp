@@ -0,0 +1,212 @@
+#include "../include/binary_document.h"
+#include "../include/change_log.h"
+#include "../include/document.h"
+#include "../include/document_storage.h"
+#include "../third_party/json.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Saves and loads a generated document of about the requested size, printing
+// time, throughput and peak memory for each step. Peak memory is read from
+// /proc (Linux) and reset before each step; freed heap is trimmed first so
+// every step starts from what is really in use.
+//
+// Usage: storage_benchmark [megabytes=1024] [--dom]
+// --dom also runs the old whole-document nlohmann::json path for comparison.
+
+namespace {
+
+using json = nlohmann::json;
+
+size_t statusKilobytes(const std::string& field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, field.size(), field) == 0) {
+            return std::strtoull(line.c_str() + field.size() + 1, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+size_t fileBytes(const std::string& path) {
+    struct stat info;
+    return ::stat(path.c_str(), &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+}
+
+void buildDocument(size_t targetBytes) {
+    Document* doc = Document::getInstance();
+    doc->clear();
+    const std::string sentence = "The quick brown fox jumps over the \"lazy\" dog.\n";
+    size_t bytes = 0;
+    for (size_t i = 0; bytes < targetBytes; ++i) {
+        if (i % 10 == 9) {
+            auto table = std::make_unique<TableElement>(8, 4);
+            for (int row = 0; row < 8; ++row) {
+                for (int col = 0; col < 4; ++col) {
+                    table->setCell(row, col, "cell " + std::to_string(i + row * 4 + col));
+                }
+            }
+            table->setStyle("bordered");
+            doc->addElement(std::move(table));
+            bytes += 650;
+        } else if (i % 10 == 4) {
+            doc->addElement(std::make_unique<ImageElement>("images/photo_" + std::to_string(i) + ".jpg", 1920, 1080));
+            bytes += 100;
+        } else {
+            std::string text;
+            for (size_t s = 0; s < 20; ++s) {
+                text += sentence;
+            }
+            doc->addElement(std::make_unique<TextElement>(text, i % 2 ? "bold" : "normal"));
+            bytes += text.size() + 80;
+        }
+    }
+}
+
+// Runs one step and reports it against the size of the file it wrote or
+// read; an empty path reports no throughput
+void measure(const std::string& name, const std::string& path, const std::function<bool()>& step) {
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+    std::ofstream("/proc/self/clear_refs") << "5";  // reset peak RSS
+    size_t before = statusKilobytes("VmRSS:");
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = step();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t peak = statusKilobytes("VmHWM:");
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(6)
+              << std::setw(10) << seconds << " s";
+    if (path.empty()) {
+        std::cout << std::string(14, ' ');
+    } else {
+        std::cout << std::setw(9) << std::setprecision(0) << fileBytes(path) / seconds / (1024 * 1024) << " MB/s";
+    }
+    std::cout << std::setw(9) << (peak > before ? peak - before : 0) / 1024 << " MB peak growth"
+              << (ok ? "" : "  FAILED") << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t megabytes = 1024;
+    bool dom = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dom") {
+            dom = true;
+        } else {
+            megabytes = std::strtoull(arg.c_str(), nullptr, 10);
+        }
+    }
+
+    const std::string prettyPath = "storage_benchmark_pretty.json";
+    const std::string compactPath = "storage_benchmark_compact.json";
+    const std::string binaryPath = "storage_benchmark.bin";
+    const std::string incrementalPath = "storage_benchmark_incremental.bin";
+    Document* doc = Document::getInstance();
+    DocumentStorage storage;
+
+    std::cout << "Building a " << megabytes << " MB document..." << std::endl;
+    buildDocument(megabytes * 1024 * 1024);
+    size_t elements = doc->size();
+    std::cout << elements << " elements" << std::endl;
+
+    measure("save (pretty)", prettyPath, [&] { return storage.saveToFile(prettyPath); });
+    measure("save (compact)", compactPath, [&] { return storage.saveToFile(compactPath, JsonWriter::Style::Compact); });
+    std::cout << "pretty file " << fileBytes(prettyPath) / (1024 * 1024) << " MB, compact file "
+              << fileBytes(compactPath) / (1024 * 1024) << " MB" << std::endl;
+
+    // Loading replaces the document, so clear it first to count only the
+    // loaded copy and the reader
+    doc->clear();
+    measure("load (pretty)", prettyPath, [&] { return storage.loadFromFile(prettyPath) && doc->size() == elements; });
+    doc->clear();
+    measure("load (compact)", compactPath, [&] { return storage.loadFromFile(compactPath) && doc->size() == elements; });
+
+    // Binary: opening maps the file, and elements are decoded when reached
+    measure("save (binary)", binaryPath, [&] { return storage.saveToBinaryFile(binaryPath); });
+    std::cout << "binary file " << fileBytes(binaryPath) / (1024 * 1024) << " MB" << std::endl;
+    doc->clear();
+    measure("open (binary)", "", [&] { return storage.loadFromBinaryFile(binaryPath) && doc->size() == elements; });
+    measure("read middle (binary)", "", [&] { return doc->getElement(elements / 2).getType() != ""; });
+    measure("read all (binary)", binaryPath, [&] {
+        size_t read = 0;
+        for (const auto& element : doc->getElements()) {
+            read += element->getType().empty() ? 0 : 1;
+        }
+        return read == elements;
+    });
+
+    // Incremental: the first save writes the whole file, the next only the
+    // one element inserted since. Both are synced to disk before returning.
+    measure("save (incr, whole)", incrementalPath, [&] { return storage.saveIncremental(incrementalPath); });
+    doc->insertElement(elements / 2, std::make_unique<TextElement>("inserted", "bold"));
+    measure("save (incr, 1 edit)", "", [&] { return storage.saveIncremental(incrementalPath); });
+    measure("open (incr)", "", [&] { return storage.loadIncremental(incrementalPath) && doc->size() == elements + 1; });
+
+    if (dom) {
+        // The previous implementation: the whole document as one json value
+        measure("dom save (pretty)", prettyPath, [&] {
+            json documentJson = json::array();
+            for (const auto& element : doc->getElements()) {
+                json j;
+                j["type"] = element->getType();
+                if (element->getType() == "text") {
+                    const auto& text = static_cast<const TextElement&>(*element);
+                    j.merge_patch(json{{"content", text.getContent()}, {"style", text.getStyle()}});
+                } else if (element->getType() == "image") {
+                    const auto& image = static_cast<const ImageElement&>(*element);
+                    j.merge_patch(json{{"path", image.getImagePath()}, {"width", image.getWidth()},
+                                       {"height", image.getHeight()}});
+                } else if (element->getType() == "table") {
+                    const auto& table = static_cast<const TableElement&>(*element);
+                    j.merge_patch(json{{"data", table.getData()}, {"style", table.getStyle()}});
+                }
+                documentJson.push_back(j);
+            }
+            std::ofstream file(prettyPath);
+            file << documentJson.dump(4);
+            return static_cast<bool>(file);
+        });
+        doc->clear();
+        measure("dom load (pretty)", prettyPath, [&] {
+            std::ifstream file(prettyPath);
+            json documentJson;
+            file >> documentJson;
+            for (const auto& j : documentJson) {
+                if (j["type"] == "text") {
+                    doc->addElement(std::make_unique<TextElement>(j["content"], j["style"]));
+                } else if (j["type"] == "image") {
+                    doc->addElement(std::make_unique<ImageElement>(j["path"], j["width"], j["height"]));
+                } else {
+                    auto table = std::make_unique<TableElement>();
+                    table->setData(j["data"]);
+                    table->setStyle(j["style"]);
+                    doc->addElement(std::move(table));
+                }
+            }
+            return doc->size() == elements;
+        });
+    }
+
+    std::remove(prettyPath.c_str());
+    std::remove(compactPath.c_str());
+    std::remove(binaryPath.c_str());
+    std::remove(ChangeLog::pathFor(incrementalPath, BinaryDocument(incrementalPath).id()).c_str());
+    std::remove(incrementalPath.c_str());
+    return 0;
+}
@@ -0,0 +1,62 @@
+#ifndef BINARY_DOCUMENT_H
+#define BINARY_DOCUMENT_H
+
+#include "element_tree.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Document in the binary container format, memory-mapped (POSIX) and read
+// one element at a time. Opening checks only the header, so it takes the
+// same time whatever the size of the file; an element is decoded when
+// load() is called for it, which ElementTree does the first time one of
+// its leaves is reached.
+//
+// Layout, in host byte order:
+//   header        magic, file id, element count, and the offset and size of
+//                 each section
+//   string pool   the bytes of every string, short repeated ones stored once
+//   index table   per element: kind, payload offset and payload size
+//   payloads      per element: fixed fields and references into the pool
+class BinaryDocument : public ElementSource {
+public:
+    // Maps the file; throws std::runtime_error if it cannot be read or is
+    // not in this format
+    explicit BinaryDocument(const std::string& path);
+    ~BinaryDocument() override;
+
+    BinaryDocument(const BinaryDocument&) = delete;
+    BinaryDocument& operator=(const BinaryDocument&) = delete;
+    BinaryDocument(BinaryDocument&&) = delete;
+    BinaryDocument& operator=(BinaryDocument&&) = delete;
+
+    size_t size() const override { return count; }
+
+    // Random id given to each file written, naming its change log
+    uint64_t id() const { return fileId; }
+
+    // Decodes one element; throws std::runtime_error if its bytes are corrupt
+    std::unique_ptr<IDocumentElement> load(size_t index) const override;
+
+    // Writes elements to path in this format. The file is written beside
+    // path, synced to disk and renamed over it, and the rename is synced
+    // too, so after a crash path holds the old or the new contents in full.
+    // A document still mapped from path keeps reading the old contents.
+    // Returns the new file's id; throws std::runtime_error on failure.
+    static uint64_t write(const std::string& path, const ElementTree& elements);
+
+private:
+    std::string path;
+    const char* mapping;
+    size_t mappedBytes;
+    size_t count;
+    uint64_t fileId;
+    const char* pool;
+    size_t poolBytes;
+    const char* index;
+    const char* payloads;
+    size_t payloadBytes;
+};
+
+#endif // BINARY_DOCUMENT_H
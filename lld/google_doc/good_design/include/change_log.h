@@ -0,0 +1,60 @@
+#ifndef CHANGE_LOG_H
+#define CHANGE_LOG_H
+
+#include "document.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Append-only file of element changes made on top of a binary document file
+// (POSIX). The log belongs to one version of the document file, named by
+// that file's id, so a log left over from before a rewrite is never replayed
+// onto the new file.
+//
+// Layout: a 16-byte header (magic, document file id), then one record per
+// change: checksum, kind, index, element size, and the element itself. A
+// record cut short by a crash fails its checksum and ends the log there.
+//
+// Every append is on disk (fdatasync) before it returns, as is a new log's
+// header and directory entry, so a save that succeeded survives a crash.
+class ChangeLog {
+public:
+    // Opens the log at path, creating it if needed; a log for another
+    // document file id is emptied. Throws std::runtime_error on failure.
+    ChangeLog(const std::string& path, uint64_t documentId);
+    ~ChangeLog();
+
+    ChangeLog(const ChangeLog&) = delete;
+    ChangeLog& operator=(const ChangeLog&) = delete;
+    ChangeLog(ChangeLog&&) = delete;
+    ChangeLog& operator=(ChangeLog&&) = delete;
+
+    // Log path for the document file at documentPath with the given id
+    static std::string pathFor(const std::string& documentPath, uint64_t documentId);
+
+    // Applies every complete record to elements, in order, and cuts off a
+    // partly written tail so new records follow the last good one
+    void replay(ElementTree& elements);
+
+    // Appends records for changes, reading each element's contents now.
+    // Returns once they are on disk.
+    void append(const std::vector<ElementChange>& changes);
+
+    // Raw records from byte offset on, for carrying them to another log
+    std::string recordsFrom(size_t offset) const;
+    void appendRecords(const std::string& records);
+
+    size_t size() const { return bytes; }
+    const std::string& filePath() const { return path; }
+
+private:
+    void writeAll(const std::string& data);
+    void sync();
+
+    std::string path;
+    int fd;
+    size_t bytes;
+};
+
+#endif // CHANGE_LOG_H
@@ -2,8 +2,20 @@
 #define DOCUMENT_H
 
 #include "document_element.h"
-#include <vector>
+#include "element_tree.h"
 #include <memory>
+#include <vector>
+
+// One change to the document's elements, recorded while changes are tracked
+struct ElementChange {
+    enum class Kind { Insert, Erase, Replace };
+
+    Kind kind;
+    size_t index;  // position when the change was made
+    // Insert and Replace: the element, as it is now. Expired once nothing
+    // holds it, which means a later change removed it again.
+    std::weak_ptr<const IDocumentElement> element;
+};
 
 class Document {
 private:
@@ -21,8 +33,14 @@ private:
     Document(Document&&) = delete;
     Document& operator=(Document&&) = delete;
 
-    // Document elements - using unique_ptr for exclusive ownership
-    std::vector<std::unique_ptr<IDocumentElement>> elements;
+    // Document elements - a copy-on-write tree, so snapshots share them
+    ElementTree elements;
+
+    // Changes since takeChanges(), while tracking is on (dirty tracking)
+    bool trackingChanges = false;
+    std::vector<ElementChange> changes;
+
+    void recordChange(ElementChange::Kind kind, size_t index);
 
 public:
     // Get singleton instance
@@ -30,10 +48,29 @@ public:
 
     // Document management methods
     void addElement(std::unique_ptr<IDocumentElement> element);
+    void insertElement(size_t index, std::unique_ptr<IDocumentElement> element);
     void removeElement(size_t index);
-    const std::vector<std::unique_ptr<IDocumentElement>>& getElements() const;
+    // Reads like the former std::vector<std::unique_ptr<IDocumentElement>>
+    // (indexing, at, size, range-for); edits go through editElement()
+    const ElementTree& getElements() const;
+    const IDocumentElement& getElement(size_t index) const;
+    IDocumentElement& editElement(size_t index);
+    size_t size() const;
     void clear();
 
+    // Versions: snapshot() is O(1) and unaffected by later edits;
+    // restore() makes a snapshot the current contents again
+    ElementTree snapshot() const;
+    void restore(const ElementTree& version);
+
+    // Dirty tracking for incremental saves. trackChanges() starts recording
+    // every insert, removal and edit; takeChanges() hands over those made
+    // since the last call. Replacing the contents (clear, restore) cannot be
+    // expressed as changes, so it stops tracking.
+    void trackChanges();
+    bool isTrackingChanges() const;
+    std::vector<ElementChange> takeChanges();
+
     ~Document() {
         delete instance;
         instance = nullptr;
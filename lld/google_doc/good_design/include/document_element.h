@@ -8,8 +8,14 @@
 // Base interface for all document elements
 class IDocumentElement {
 public:
+    // Concrete element type, for dispatch without RTTI
+    enum class Kind { Text, Image, Table };
+
     virtual ~IDocumentElement() = default;
     virtual std::string getType() const = 0;
+    virtual Kind getKind() const = 0;
+    // Independent copy, used when an element shared with a snapshot is edited
+    virtual std::unique_ptr<IDocumentElement> clone() const = 0;
 };
 
 // Interface for elements that can be edited
@@ -46,6 +52,8 @@ public:
     
     // IDocumentElement interface
     std::string getType() const override { return "text"; }
+    Kind getKind() const override { return Kind::Text; }
+    std::unique_ptr<IDocumentElement> clone() const override { return std::make_unique<TextElement>(*this); }
     
     // IEditable interface
     void setContent(const std::string& content) override;
@@ -71,6 +79,8 @@ public:
     
     // IDocumentElement interface
     std::string getType() const override { return "image"; }
+    Kind getKind() const override { return Kind::Image; }
+    std::unique_ptr<IDocumentElement> clone() const override { return std::make_unique<ImageElement>(*this); }
     
     // IRenderable interface
     std::string render() const override;
@@ -93,6 +103,8 @@ public:
     
     // IDocumentElement interface
     std::string getType() const override { return "table"; }
+    Kind getKind() const override { return Kind::Table; }
+    std::unique_ptr<IDocumentElement> clone() const override { return std::make_unique<TableElement>(*this); }
     
     // IEditable interface
     void setContent(const std::string& content) override;
@@ -4,7 +4,8 @@
 #include "document_element.h"
 #include <string>
 
-// Abstract base class for rendering strategies
+// Abstract base class for rendering strategies. RenderEngine calls one
+// renderer from several threads at once, so render must not change state.
 class IRenderer {
 public:
     virtual ~IRenderer() = default;
@@ -23,6 +24,13 @@ public:
     std::string render(const IDocumentElement& element) override;
 };
 
+// Concrete renderer for table elements: a "[Table]" line, then one line of
+// "| cell " per row
+class TableRenderer : public IRenderer {
+public:
+    std::string render(const IDocumentElement& element) override;
+};
+
 // Document renderer class that uses the strategy pattern
 class DocumentRenderer {
 private:
@@ -35,4 +43,4 @@ public:
     }
 };
 
-#endif // DOCUMENT_RENDERER_H 
\ No newline at end of file
+#endif // DOCUMENT_RENDERER_H
@@ -3,36 +3,85 @@
 
 #include <string>
 #include <fstream>
-#include "../third_party/json.hpp"
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <cstdint>
 #include "document.h"
 #include "document_renderer.h"
+#include "json_writer.h"
 
-using json = nlohmann::json;
+class ChangeLog;
 
 class DocumentStorage {
 public:
-    DocumentStorage() = default;
-    ~DocumentStorage() = default;
-    
-    // Save document to file in JSON format
-    bool saveToFile(const std::string& filename);
-    
-    // Load document from JSON file
+    DocumentStorage();
+    ~DocumentStorage();
+
+    // Prevent copying
+    DocumentStorage(const DocumentStorage&) = delete;
+    DocumentStorage& operator=(const DocumentStorage&) = delete;
+
+    // Save document to file in JSON format, one element at a time.
+    // Pretty output is indented by 4; compact output has no whitespace.
+    // Fails if any text is not valid UTF-8, which JSON cannot hold.
+    // Saving over the file incremental saves go to drops its change log.
+    bool saveToFile(const std::string& filename, JsonWriter::Style style = JsonWriter::Style::Pretty);
+
+    // Load document from JSON file, building elements as the parser reaches
+    // them. The document is replaced only if the whole file loads.
     bool loadFromFile(const std::string& filename);
-    
+
+    // Save document to file in the binary format (see binary_document.h).
+    // Saving over the file incremental saves go to starts its change log
+    // afresh, so later incremental saves append to the new file's log.
+    bool saveToBinaryFile(const std::string& filename);
+
+    // Open a binary file in constant time: the document reads each element
+    // from the mapped file the first time it is reached. A change log left
+    // by incremental saves is applied too.
+    bool loadFromBinaryFile(const std::string& filename);
+
+    // Incremental save to a binary file. The first save to a file, or the
+    // first after the document's contents were replaced, writes it whole;
+    // later ones append only the changes since the previous save to a change
+    // log beside it, so their cost follows the size of the edits. Once the
+    // log outgrows a quarter of the file, a background thread folds both
+    // into a fresh file.
+    bool saveIncremental(const std::string& filename);
+
+    // Open a binary file saved incrementally, with its change log applied;
+    // later incremental saves append to that log
+    bool loadIncremental(const std::string& filename);
+
 private:
-    // Helper methods for JSON conversion
-    json elementToJson(const IDocumentElement& element);
-    std::unique_ptr<IDocumentElement> jsonToElement(const json& j);
-    
+    // Change log size that triggers compaction, for small files
+    static constexpr size_t MIN_COMPACT_LOG_BYTES = 1 << 20;
+
+    // Helper methods for incremental saves
+    bool saveWhole(Document* doc, const std::string& filename);
+    void startLog(Document* doc, const std::string& filename, uint64_t id);
+    bool isLogged(const std::string& filename);
+    void dropLog(const std::string& filename);
+    void compact(ElementTree snapshot, size_t logOffset);
+    void waitForCompaction();
+
+    // Incremental save state; the log and counters are shared with the
+    // compaction thread under logMutex
+    std::mutex logMutex;
+    std::string logDocumentPath;
+    std::unique_ptr<ChangeLog> changeLog;
+    size_t documentBytes = 0;
+    bool compacting = false;
+    std::thread compaction;
+
+    // Helper methods for JSON output
+    void writeElement(JsonWriter& writer, const IDocumentElement& element);
+
     // Helper methods for specific element types
-    json textElementToJson(const TextElement& element);
-    json imageElementToJson(const ImageElement& element);
-    json tableElementToJson(const TableElement& element);
-    
-    std::unique_ptr<TextElement> jsonToTextElement(const json& j);
-    std::unique_ptr<ImageElement> jsonToImageElement(const json& j);
-    std::unique_ptr<TableElement> jsonToTableElement(const json& j);
+    void writeTextElement(JsonWriter& writer, const TextElement& element);
+    void writeImageElement(JsonWriter& writer, const ImageElement& element);
+    void writeTableElement(JsonWriter& writer, const TableElement& element);
 };
 
-#endif // DOCUMENT_STORAGE_H 
\ No newline at end of file
+#endif // DOCUMENT_STORAGE_H
@@ -0,0 +1,164 @@
+#ifndef ELEMENT_TREE_H
+#define ELEMENT_TREE_H
+
+#include "document_element.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Elements that can be loaded one at a time by position, e.g. from a file
+class ElementSource {
+public:
+    virtual ~ElementSource() = default;
+    virtual size_t size() const = 0;
+    virtual std::unique_ptr<IDocumentElement> load(size_t index) const = 0;
+};
+
+// Ordered sequence of document elements stored as a B+tree of chunks.
+// Leaves hold up to MAX_CHILDREN elements and inner nodes up to MAX_CHILDREN
+// children, each child tagged with its element count, so insert, erase and
+// positional lookup are O(log n) wherever they happen.
+//
+// Nodes and elements are shared between copies of the tree. Copying a tree
+// (a snapshot) is O(1); an edit copies only the nodes on its path, plus the
+// element itself if a snapshot still holds it (copy-on-write).
+//
+// A tree built over an ElementSource starts as a single node standing for
+// every element. A node is filled in from the source the first time
+// anything reaches it, so only the leaves that are used get loaded.
+//
+// Every position also carries a revision number, new each time an element
+// is put there, loaded or handed out by mutableAt, and kept by copies of
+// the tree. Two positions with the same revision, in this tree or any copy,
+// hold the same contents, so caches of per-element results can key on it.
+class ElementTree {
+public:
+    using ElementPtr = std::shared_ptr<const IDocumentElement>;
+
+    static constexpr size_t MAX_CHILDREN = 64;
+    static constexpr size_t MIN_CHILDREN = MAX_CHILDREN / 4;
+
+private:
+    struct Slot {
+        ElementPtr element;
+        uint64_t revision;
+    };
+
+    struct Node {
+        bool leaf = true;
+        size_t count = 0;                            // elements in this subtree
+        std::vector<Slot> elements;                  // leaves only
+        std::vector<std::shared_ptr<Node>> children; // inner nodes only
+
+        // Not yet loaded: elements [first, first + count) of source, in a
+        // subtree with leaves height levels down
+        std::shared_ptr<const ElementSource> source;
+        size_t first = 0;
+        size_t height = 0;
+        mutable std::once_flag loaded;
+
+        Node() = default;
+        Node(const Node& other);
+    };
+    using NodePtr = std::shared_ptr<Node>;
+
+public:
+    // Forward iterator over the elements in order; yields const ElementPtr&
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ElementPtr;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const ElementPtr*;
+        using reference = const ElementPtr&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return slot().element; }
+        pointer operator->() const { return &**this; }
+        uint64_t revision() const { return slot().revision; }
+        const_iterator& operator++();
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const const_iterator& other) const;
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class ElementTree;
+
+        struct Frame {
+            const Node* node;
+            size_t position;
+        };
+
+        // Root to leaf; a tree of 64-way nodes never gets close to this deep
+        static constexpr size_t MAX_DEPTH = 16;
+
+        void descendLeftmost();
+        const Slot& slot() const { return path[depth - 1].node->elements[path[depth - 1].position]; }
+
+        std::array<Frame, MAX_DEPTH> path{};
+        size_t depth = 0;  // 0 means end()
+    };
+
+    ElementTree() = default;
+    // O(1): elements are loaded from source as they are reached
+    explicit ElementTree(std::shared_ptr<const ElementSource> source);
+
+    size_t size() const { return root ? root->count : 0; }
+    bool empty() const { return size() == 0; }
+
+    // Read like the std::vector<std::unique_ptr<IDocumentElement>> this
+    // replaced: elements[i]->getType(), at(i) (throws std::out_of_range),
+    // front() and back() all yield the owning pointer. O(log n) each.
+    const ElementPtr& operator[](size_t index) const { return find(index); }
+    const ElementPtr& at(size_t index) const { return find(index); }
+    const ElementPtr& front() const { return find(0); }
+    const ElementPtr& back() const { return find(size() - 1); }
+    ElementPtr pointerAt(size_t index) const;
+    // Element at index, made private to this tree first and given a new
+    // revision, since the caller is about to edit it
+    IDocumentElement& mutableAt(size_t index);
+
+    // A shared element is copied before it is edited, so it may also be
+    // held elsewhere, but must not have been created const
+    void insert(size_t index, ElementPtr element);
+    void insert(size_t index, std::unique_ptr<IDocumentElement> element) { insert(index, ElementPtr(std::move(element))); }
+    void replace(size_t index, ElementPtr element);
+    void pushBack(std::unique_ptr<IDocumentElement> element) { insert(size(), std::move(element)); }
+    void erase(size_t index);
+    void clear() { root.reset(); }
+
+    const_iterator begin() const;
+    const_iterator end() const { return const_iterator(); }
+    // O(log n): iterator at the element at index, or end() if there is none
+    const_iterator iteratorAt(size_t index) const;
+
+private:
+    // Fills in a node that stands for part of a source; safe to call from
+    // concurrent readers
+    static const Node& load(const Node& node);
+    static void loadFromSource(Node& node);
+    static NodePtr& makeUnique(NodePtr& node);
+    static uint64_t newRevision();
+    const ElementPtr& find(size_t index) const;
+    // Slot of the element at index, with the path to it made private
+    Slot& unshare(size_t index);
+    static size_t childFor(const Node& node, size_t& index);
+    static NodePtr insertInto(NodePtr& node, size_t index, ElementPtr element);
+    static void eraseFrom(NodePtr& node, size_t index);
+    static void rebalance(Node& parent, size_t child);
+    static NodePtr splitOff(Node& node);
+
+    NodePtr root;
+};
+
+#endif // ELEMENT_TREE_H
@@ -0,0 +1,18 @@
+#ifndef FILE_SYNC_H
+#define FILE_SYNC_H
+
+#include <string>
+
+// Durability for files that are written beside their final name and renamed
+// into place (POSIX). Data written through a stream or write() may sit in
+// the page cache, and a rename or a new directory entry may not be on disk,
+// until these return. Both throw std::runtime_error on failure.
+
+// Flushes the file's contents to disk
+void syncFile(const std::string& path);
+
+// Makes files created, renamed or removed in the directory holding path
+// survive a crash
+void syncParentDirectory(const std::string& path);
+
+#endif // FILE_SYNC_H
@@ -0,0 +1,52 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Streaming JSON writer: values go straight to an output buffer as they are
+// emitted, so memory stays bounded by the buffer and the nesting depth,
+// however large the document. Pretty mode produces the same text as
+// nlohmann::json::dump(4); compact mode has no whitespace at all.
+class JsonWriter {
+public:
+    enum class Style { Pretty, Compact };
+
+    explicit JsonWriter(std::ostream& out, Style style = Style::Pretty);
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    void beginArray();
+    void endArray();
+    void beginObject();
+    void endObject();
+
+    // Object member name; the next call writes its value. Strings must be
+    // UTF-8; std::invalid_argument is thrown for anything else.
+    void key(const std::string& name);
+    void value(const std::string& text);
+    void value(long long number);
+
+    // Hands buffered text to the stream; returns false if the stream failed
+    bool flush();
+
+private:
+    // Bytes buffered before they are handed to the stream
+    static constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+    void beforeValue();
+    void closeContainer(char close);
+    void writeString(const std::string& text);
+    void maybeFlush();
+
+    std::ostream& out;
+    Style style;
+    std::string buffer;
+    std::vector<bool> containerEmpty;  // one entry per open array/object
+    bool afterKey = false;
+};
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,96 @@
+#ifndef RENDER_ENGINE_H
+#define RENDER_ENGINE_H
+
+#include "document_renderer.h"
+#include "element_tree.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A rendered document: each element's output followed by a newline, in
+// order. The pieces are the engine's cached outputs rather than one copied
+// buffer, so a re-render after an edit neither renders nor copies the
+// elements that did not change. Valid until the engine's next render().
+class RenderedDocument {
+public:
+    // Bytes, newlines included
+    size_t size() const { return bytes; }
+    size_t elements() const { return parts.size(); }
+    // One element's output, without its newline
+    const std::string& element(size_t index) const { return *parts[index]; }
+
+    // The whole text in one string; copies every piece
+    std::string str() const;
+    void writeTo(std::ostream& out) const;
+
+private:
+    friend class RenderEngine;
+
+    std::vector<const std::string*> parts;
+    size_t bytes = 0;
+};
+
+std::ostream& operator<<(std::ostream& out, const RenderedDocument& document);
+
+// Renders a whole document, each element followed by a newline. Elements go
+// to a renderer chosen by their kind.
+//
+// The document is split into one chunk per hardware thread, and the chunks
+// look up and render their elements in parallel.
+//
+// Each element's output is cached under its ElementTree revision, which an
+// edit through ElementTree::mutableAt replaces. The cache holds no
+// reference to the elements, so an edit does not have to copy them.
+// Re-rendering after an edit renders only the elements that changed.
+class RenderEngine {
+public:
+    // With the text, image and table renderers
+    RenderEngine();
+
+    // Prevent copying
+    RenderEngine(const RenderEngine&) = delete;
+    RenderEngine& operator=(const RenderEngine&) = delete;
+
+    // Replaces the renderer for one kind of element; drops cached output
+    void setRenderer(IDocumentElement::Kind kind, std::unique_ptr<IRenderer> renderer);
+
+    // Renders elements; the result stays valid until the next call. Throws
+    // if an element cannot be loaded from its file.
+    const RenderedDocument& render(const ElementTree& elements);
+
+    // Elements the last render() had to render rather than take from cache
+    size_t renderedLastTime() const { return rendered; }
+    size_t cachedElements() const { return cache.size(); }
+    void clearCache();
+
+private:
+    // One per IDocumentElement::Kind
+    static constexpr size_t KINDS = 3;
+    // Fewer elements than this per thread are not worth starting a thread
+    static constexpr size_t MIN_CHUNK_ELEMENTS = 4096;
+
+    struct Entry {
+        std::string output;
+        uint64_t lastUsed = 0;  // generation of the last render
+    };
+
+    std::string renderElement(const IDocumentElement& element);
+
+    std::array<std::unique_ptr<IRenderer>, KINDS> renderers;
+    // By ElementTree revision; entries never move once added
+    std::unordered_map<uint64_t, Entry> cache;
+    uint64_t generation = 0;
+    size_t rendered = 0;
+    RenderedDocument output;
+    // Revision and entry of each element in the last output, to find
+    // unchanged elements without a cache lookup
+    std::vector<uint64_t> lastRevisions;
+    std::vector<Entry*> lastParts;
+};
+
+#endif // RENDER_ENGINE_H
@@ -0,0 +1,358 @@
+#include "../include/binary_document.h"
+#include "../include/file_sync.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char MAGIC[8] = {'G', 'D', 'O', 'C', 'B', 'I', 'N', '1'};
+
+enum class ElementKind : uint32_t { Text = 1, Image = 2, Table = 3 };
+
+struct FileHeader {
+    char magic[8];
+    uint64_t elements;
+    uint64_t poolOffset;
+    uint64_t poolBytes;
+    uint64_t indexOffset;
+    uint64_t payloadOffset;
+    uint64_t payloadBytes;
+    uint64_t id;
+};
+
+struct IndexEntry {
+    uint32_t kind;
+    uint32_t payloadBytes;
+    uint64_t payloadOffset;  // from the start of the payload section
+};
+
+struct StringRef {
+    uint64_t offset;  // from the start of the string pool
+    uint64_t length;
+};
+
+static_assert(sizeof(FileHeader) == 64 && sizeof(IndexEntry) == 16 && sizeof(StringRef) == 16,
+              "layout has no padding");
+
+// Strings up to this length are stored once however often they occur
+// (styles, repeated cells), for up to INTERN_MAX_STRINGS distinct values
+constexpr size_t INTERN_MAX_LENGTH = 64;
+constexpr size_t INTERN_MAX_STRINGS = 4096;
+constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+// Streams strings into the pool section as they are added
+class PoolWriter {
+public:
+    explicit PoolWriter(std::ostream& out) : out(out) {}
+
+    StringRef add(const std::string& text) {
+        bool shortString = text.size() <= INTERN_MAX_LENGTH;
+        if (shortString) {
+            auto it = interned.find(text);
+            if (it != interned.end()) {
+                return StringRef{it->second, text.size()};
+            }
+        }
+        StringRef ref{written, text.size()};
+        if (shortString && interned.size() < INTERN_MAX_STRINGS) {
+            interned.emplace(text, written);
+        }
+        buffer += text;
+        written += text.size();
+        if (buffer.size() >= FLUSH_THRESHOLD) {
+            flush();
+        }
+        return ref;
+    }
+
+    void flush() {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+    uint64_t size() const { return written; }
+
+private:
+    std::ostream& out;
+    std::string buffer;
+    uint64_t written = 0;
+    std::unordered_map<std::string, uint64_t> interned;
+};
+
+template <typename T>
+void append(std::string& bytes, const T& value) {
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Bounds-checked reads from one element's payload
+class PayloadReader {
+public:
+    PayloadReader(const char* data, size_t size, const char* pool, size_t poolBytes)
+        : data(data), size(size), pool(pool), poolBytes(poolBytes) {}
+
+    template <typename T>
+    T read() {
+        if (size - position < sizeof(T)) {
+            throw std::runtime_error("Corrupt document file: payload too short");
+        }
+        T value;
+        std::memcpy(&value, data + position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+
+    std::string readString() {
+        StringRef ref = read<StringRef>();
+        if (ref.offset > poolBytes || ref.length > poolBytes - ref.offset) {
+            throw std::runtime_error("Corrupt document file: string outside the pool");
+        }
+        return std::string(pool + ref.offset, ref.length);
+    }
+
+    // Upper bound on how many items of itemBytes each the rest can hold
+    size_t capacity(size_t itemBytes) const { return (size - position) / itemBytes; }
+
+private:
+    const char* data;
+    size_t size;
+    const char* pool;
+    size_t poolBytes;
+    size_t position = 0;
+};
+
+std::runtime_error systemError(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+// Nonzero, and different for every file written
+uint64_t newFileId() {
+    static std::mt19937_64 generator(std::random_device{}() ^ static_cast<uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count()));
+    static std::mutex generatorMutex;
+    std::lock_guard<std::mutex> lock(generatorMutex);
+    uint64_t id;
+    do {
+        id = generator();
+    } while (id == 0);
+    return id;
+}
+
+// Section [offset, offset + bytes) lies inside a file of fileBytes
+bool inside(uint64_t offset, uint64_t bytes, size_t fileBytes) {
+    return offset <= fileBytes && bytes <= fileBytes - offset;
+}
+
+} // namespace
+
+BinaryDocument::BinaryDocument(const std::string& path)
+    : path(path)
+    , mapping(nullptr)
+    , mappedBytes(0)
+    , count(0)
+    , fileId(0)
+    , pool(nullptr)
+    , poolBytes(0)
+    , index(nullptr)
+    , payloads(nullptr)
+    , payloadBytes(0)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw systemError("Cannot open document file", path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw systemError("Cannot stat document file", path);
+    }
+    mappedBytes = static_cast<size_t>(info.st_size);
+    if (mappedBytes < sizeof(FileHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Not a binary document file: " + path);
+    }
+
+    void* address = ::mmap(nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        throw systemError("Cannot map document file", path);
+    }
+    mapping = static_cast<const char*>(address);
+
+    // Only the header is read here; elements are checked as they are loaded
+    FileHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+        || !inside(header.poolOffset, header.poolBytes, mappedBytes)
+        || !inside(header.payloadOffset, header.payloadBytes, mappedBytes)
+        || header.indexOffset > mappedBytes
+        || header.elements > (mappedBytes - header.indexOffset) / sizeof(IndexEntry)) {
+        ::munmap(address, mappedBytes);
+        throw std::runtime_error("Not a binary document file: " + path);
+    }
+
+    count = header.elements;
+    fileId = header.id;
+    pool = mapping + header.poolOffset;
+    poolBytes = header.poolBytes;
+    index = mapping + header.indexOffset;
+    payloads = mapping + header.payloadOffset;
+    payloadBytes = header.payloadBytes;
+}
+
+BinaryDocument::~BinaryDocument() {
+    ::munmap(const_cast<char*>(mapping), mappedBytes);
+}
+
+std::unique_ptr<IDocumentElement> BinaryDocument::load(size_t position) const {
+    if (position >= count) {
+        throw std::out_of_range("Element index out of range");
+    }
+    IndexEntry entry;
+    std::memcpy(&entry, index + position * sizeof(IndexEntry), sizeof(entry));
+    if (!inside(entry.payloadOffset, entry.payloadBytes, payloadBytes)) {
+        throw std::runtime_error("Corrupt document file " + path + ": payload outside its section");
+    }
+    PayloadReader reader(payloads + entry.payloadOffset, entry.payloadBytes, pool, poolBytes);
+
+    switch (static_cast<ElementKind>(entry.kind)) {
+        case ElementKind::Text: {
+            std::string content = reader.readString();
+            return std::make_unique<TextElement>(content, reader.readString());
+        }
+        case ElementKind::Image: {
+            std::string imagePath = reader.readString();
+            int32_t width = reader.read<int32_t>();
+            int32_t height = reader.read<int32_t>();
+            if (width < 0 || height < 0) {
+                throw std::runtime_error("Corrupt document file " + path + ": negative image size");
+            }
+            return std::make_unique<ImageElement>(imagePath, width, height);
+        }
+        case ElementKind::Table: {
+            auto table = std::make_unique<TableElement>();
+            table->setStyle(reader.readString());
+            uint32_t rows = reader.read<uint32_t>();
+            if (rows > reader.capacity(sizeof(uint32_t))) {
+                throw std::runtime_error("Corrupt document file " + path + ": table too large");
+            }
+            std::vector<std::vector<std::string>> data(rows);
+            for (auto& row : data) {
+                uint32_t cols = reader.read<uint32_t>();
+                if (cols > reader.capacity(sizeof(StringRef))) {
+                    throw std::runtime_error("Corrupt document file " + path + ": table too large");
+                }
+                row.reserve(cols);
+                for (uint32_t col = 0; col < cols; ++col) {
+                    row.push_back(reader.readString());
+                }
+            }
+            table->setData(data);
+            return table;
+        }
+    }
+    throw std::runtime_error("Corrupt document file " + path + ": unknown element kind");
+}
+
+uint64_t BinaryDocument::write(const std::string& path, const ElementTree& elements) {
+    const std::string temporary = path + ".tmp";
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw systemError("Cannot create document file", temporary);
+    }
+
+    const uint64_t id = newFileId();
+    try {
+        // Strings go to the file as they come; the index and payloads hold
+        // no string bytes, so they are kept until the pool is done
+        FileHeader header{};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        PoolWriter pool(out);
+        std::vector<IndexEntry> entries;
+        entries.reserve(elements.size());
+        std::string payloadData;
+
+        for (const auto& element : elements) {
+            IndexEntry entry{};
+            entry.payloadOffset = payloadData.size();
+            const std::string type = element->getType();
+            if (type == "text") {
+                const auto& text = static_cast<const TextElement&>(*element);
+                entry.kind = static_cast<uint32_t>(ElementKind::Text);
+                append(payloadData, pool.add(text.getContent()));
+                append(payloadData, pool.add(text.getStyle()));
+            } else if (type == "image") {
+                const auto& image = static_cast<const ImageElement&>(*element);
+                entry.kind = static_cast<uint32_t>(ElementKind::Image);
+                append(payloadData, pool.add(image.getImagePath()));
+                append(payloadData, static_cast<int32_t>(image.getWidth()));
+                append(payloadData, static_cast<int32_t>(image.getHeight()));
+            } else if (type == "table") {
+                const auto& table = static_cast<const TableElement&>(*element);
+                entry.kind = static_cast<uint32_t>(ElementKind::Table);
+                append(payloadData, pool.add(table.getStyle()));
+                append(payloadData, static_cast<uint32_t>(table.getData().size()));
+                for (const auto& row : table.getData()) {
+                    append(payloadData, static_cast<uint32_t>(row.size()));
+                    for (const auto& cell : row) {
+                        append(payloadData, pool.add(cell));
+                    }
+                }
+            } else {
+                throw std::runtime_error("Cannot store element of type " + type);
+            }
+            if (payloadData.size() - entry.payloadOffset > UINT32_MAX) {
+                throw std::runtime_error("Element too large for the binary format");
+            }
+            entry.payloadBytes = static_cast<uint32_t>(payloadData.size() - entry.payloadOffset);
+            entries.push_back(entry);
+        }
+        pool.flush();
+
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.id = id;
+        header.elements = entries.size();
+        header.poolOffset = sizeof(FileHeader);
+        header.poolBytes = pool.size();
+        header.indexOffset = header.poolOffset + header.poolBytes;
+        header.payloadOffset = header.indexOffset + entries.size() * sizeof(IndexEntry);
+        header.payloadBytes = payloadData.size();
+        out.write(reinterpret_cast<const char*>(entries.data()),
+                  static_cast<std::streamsize>(entries.size() * sizeof(IndexEntry)));
+        out.write(payloadData.data(), static_cast<std::streamsize>(payloadData.size()));
+
+        // The header goes in last, so a partly written file is never valid
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.close();
+        if (out.fail()) {
+            throw systemError("Cannot write document file", temporary);
+        }
+        // On disk before the rename, so a crash cannot install a file whose
+        // blocks were never written
+        syncFile(temporary);
+    } catch (...) {
+        out.close();
+        std::remove(temporary.c_str());
+        throw;
+    }
+
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        throw systemError("Cannot install document file", path);
+    }
+    syncParentDirectory(path);
+    return id;
+}
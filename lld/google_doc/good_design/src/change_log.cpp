@@ -0,0 +1,322 @@
+#include "../include/change_log.h"
+#include "../include/file_sync.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char MAGIC[8] = {'G', 'D', 'O', 'C', 'L', 'O', 'G', '1'};
+
+enum class ElementKind : uint32_t { Text = 1, Image = 2, Table = 3 };
+
+struct LogHeader {
+    char magic[8];
+    uint64_t documentId;
+};
+
+struct RecordHeader {
+    uint32_t checksum;  // FNV-1a of the record with this field zero
+    uint32_t kind;      // ElementChange::Kind
+    uint64_t index;
+    uint64_t elementBytes;
+};
+
+static_assert(sizeof(LogHeader) == 16 && sizeof(RecordHeader) == 24, "layout has no padding");
+
+std::runtime_error systemError(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+uint32_t checksum(const char* data, size_t size, uint32_t hash = 2166136261u) {
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+    }
+    return hash;
+}
+
+template <typename T>
+void appendValue(std::string& bytes, const T& value) {
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& bytes, const std::string& text) {
+    appendValue(bytes, static_cast<uint64_t>(text.size()));
+    bytes += text;
+}
+
+// Elements are stored whole, strings inline, so each record stands alone
+void encodeElement(const IDocumentElement& element, std::string& bytes) {
+    const std::string type = element.getType();
+    if (type == "text") {
+        const auto& text = static_cast<const TextElement&>(element);
+        appendValue(bytes, static_cast<uint32_t>(ElementKind::Text));
+        appendString(bytes, text.getContent());
+        appendString(bytes, text.getStyle());
+    } else if (type == "image") {
+        const auto& image = static_cast<const ImageElement&>(element);
+        appendValue(bytes, static_cast<uint32_t>(ElementKind::Image));
+        appendString(bytes, image.getImagePath());
+        appendValue(bytes, static_cast<int32_t>(image.getWidth()));
+        appendValue(bytes, static_cast<int32_t>(image.getHeight()));
+    } else if (type == "table") {
+        const auto& table = static_cast<const TableElement&>(element);
+        appendValue(bytes, static_cast<uint32_t>(ElementKind::Table));
+        appendString(bytes, table.getStyle());
+        appendValue(bytes, static_cast<uint32_t>(table.getData().size()));
+        for (const auto& row : table.getData()) {
+            appendValue(bytes, static_cast<uint32_t>(row.size()));
+            for (const auto& cell : row) {
+                appendString(bytes, cell);
+            }
+        }
+    } else {
+        throw std::runtime_error("Cannot log element of type " + type);
+    }
+}
+
+// Bounds-checked reads from one record's element
+class ElementDecoder {
+public:
+    ElementDecoder(const char* data, size_t size) : data(data), size(size) {}
+
+    template <typename T>
+    T read() {
+        if (size - position < sizeof(T)) {
+            throw std::runtime_error("Corrupt change log: element too short");
+        }
+        T value;
+        std::memcpy(&value, data + position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+
+    std::string readString() {
+        uint64_t length = read<uint64_t>();
+        if (length > size - position) {
+            throw std::runtime_error("Corrupt change log: string too long");
+        }
+        std::string text(data + position, length);
+        position += length;
+        return text;
+    }
+
+    std::unique_ptr<IDocumentElement> decode() {
+        switch (static_cast<ElementKind>(read<uint32_t>())) {
+            case ElementKind::Text: {
+                std::string content = readString();
+                return std::make_unique<TextElement>(content, readString());
+            }
+            case ElementKind::Image: {
+                std::string path = readString();
+                int32_t width = read<int32_t>();
+                int32_t height = read<int32_t>();
+                if (width < 0 || height < 0) {
+                    throw std::runtime_error("Corrupt change log: negative image size");
+                }
+                return std::make_unique<ImageElement>(path, width, height);
+            }
+            case ElementKind::Table: {
+                auto table = std::make_unique<TableElement>();
+                table->setStyle(readString());
+                uint32_t rows = read<uint32_t>();
+                if (rows > (size - position) / sizeof(uint32_t)) {
+                    throw std::runtime_error("Corrupt change log: table too large");
+                }
+                std::vector<std::vector<std::string>> cells(rows);
+                for (auto& row : cells) {
+                    uint32_t cols = read<uint32_t>();
+                    if (cols > (size - position) / sizeof(uint64_t)) {
+                        throw std::runtime_error("Corrupt change log: table too large");
+                    }
+                    row.reserve(cols);
+                    for (uint32_t col = 0; col < cols; ++col) {
+                        row.push_back(readString());
+                    }
+                }
+                table->setData(cells);
+                return table;
+            }
+        }
+        throw std::runtime_error("Corrupt change log: unknown element kind");
+    }
+
+private:
+    const char* data;
+    size_t size;
+    size_t position = 0;
+};
+
+} // namespace
+
+ChangeLog::ChangeLog(const std::string& path, uint64_t documentId)
+    : path(path), fd(-1), bytes(0) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw systemError("Cannot open change log", path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw systemError("Cannot stat change log", path);
+    }
+
+    LogHeader header{};
+    bool matches = static_cast<size_t>(info.st_size) >= sizeof(header)
+        && ::pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))
+        && std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+        && header.documentId == documentId;
+    if (matches) {
+        bytes = static_cast<size_t>(info.st_size);
+        return;
+    }
+
+    // New, or left over from another version of the document: start over
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.documentId = documentId;
+    try {
+        if (::ftruncate(fd, 0) != 0) {
+            throw systemError("Cannot reset change log", path);
+        }
+        writeAll(std::string(reinterpret_cast<const char*>(&header), sizeof(header)));
+        sync();
+        // The log may be new; its directory entry must outlast a crash too
+        syncParentDirectory(path);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+}
+
+ChangeLog::~ChangeLog() {
+    ::close(fd);
+}
+
+std::string ChangeLog::pathFor(const std::string& documentPath, uint64_t documentId) {
+    char id[17];
+    std::snprintf(id, sizeof(id), "%016llx", static_cast<unsigned long long>(documentId));
+    return documentPath + "." + id + ".log";
+}
+
+void ChangeLog::replay(ElementTree& elements) {
+    std::string records = recordsFrom(sizeof(LogHeader));
+    size_t position = 0;
+    while (records.size() - position >= sizeof(RecordHeader)) {
+        RecordHeader header;
+        std::memcpy(&header, records.data() + position, sizeof(header));
+        size_t available = records.size() - position - sizeof(header);
+        if (header.elementBytes > available) {
+            break;
+        }
+        const char* element = records.data() + position + sizeof(header);
+        RecordHeader unsummed = header;
+        unsummed.checksum = 0;
+        uint32_t sum = checksum(reinterpret_cast<const char*>(&unsummed), sizeof(unsummed));
+        if (checksum(element, header.elementBytes, sum) != header.checksum) {
+            break;
+        }
+
+        // A record that passed its checksum but does not fit the document
+        // means the log is not for this document after all
+        auto kind = static_cast<ElementChange::Kind>(header.kind);
+        if (kind == ElementChange::Kind::Insert && header.index <= elements.size()) {
+            elements.insert(header.index, ElementDecoder(element, header.elementBytes).decode());
+        } else if (kind == ElementChange::Kind::Erase && header.index < elements.size()) {
+            elements.erase(header.index);
+        } else if (kind == ElementChange::Kind::Replace && header.index < elements.size()) {
+            elements.replace(header.index, ElementDecoder(element, header.elementBytes).decode());
+        } else {
+            throw std::runtime_error("Change log " + path + " does not match its document");
+        }
+        position += sizeof(header) + header.elementBytes;
+    }
+
+    // Whatever follows the last good record was cut short by a crash
+    size_t valid = sizeof(LogHeader) + position;
+    if (valid < bytes) {
+        if (::ftruncate(fd, static_cast<off_t>(valid)) != 0) {
+            throw systemError("Cannot truncate change log", path);
+        }
+        bytes = valid;
+    }
+}
+
+void ChangeLog::append(const std::vector<ElementChange>& changes) {
+    // One write for the whole save
+    std::string records;
+    for (const auto& change : changes) {
+        size_t start = records.size();
+        RecordHeader header{0, static_cast<uint32_t>(change.kind), change.index, 0};
+        appendValue(records, header);
+        if (change.kind != ElementChange::Kind::Erase) {
+            // A change to an element that is gone was undone by a later one;
+            // any element keeps the positions right
+            if (auto element = change.element.lock()) {
+                encodeElement(*element, records);
+            } else {
+                encodeElement(TextElement(), records);
+            }
+        }
+        header.elementBytes = records.size() - start - sizeof(header);
+        std::memcpy(&records[start], &header, sizeof(header));
+        uint32_t sum = checksum(records.data() + start, records.size() - start);
+        std::memcpy(&records[start], &sum, sizeof(sum));
+    }
+    appendRecords(records);
+}
+
+std::string ChangeLog::recordsFrom(size_t offset) const {
+    std::string records(bytes > offset ? bytes - offset : 0, '\0');
+    size_t done = 0;
+    while (done < records.size()) {
+        ssize_t got = ::pread(fd, &records[done], records.size() - done, static_cast<off_t>(offset + done));
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            throw systemError("Cannot read change log", path);
+        }
+        done += static_cast<size_t>(got);
+    }
+    return records;
+}
+
+void ChangeLog::appendRecords(const std::string& records) {
+    size_t before = bytes;
+    try {
+        writeAll(records);
+        sync();
+    } catch (...) {
+        // Drop a partial record rather than leave new ones behind it
+        if (::ftruncate(fd, static_cast<off_t>(before)) == 0) {
+            bytes = before;
+        }
+        throw;
+    }
+}
+
+void ChangeLog::writeAll(const std::string& data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t written = ::pwrite(fd, data.data() + done, data.size() - done, static_cast<off_t>(bytes));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw systemError("Cannot write change log", path);
+        }
+        done += static_cast<size_t>(written);
+        bytes += static_cast<size_t>(written);
+    }
+}
+
+void ChangeLog::sync() {
+    // Data and size only; the log's other metadata does not matter for replay
+    if (::fdatasync(fd) != 0) {
+        throw systemError("Cannot sync change log", path);
+    }
+}
@@ -1,4 +1,5 @@
 #include "../include/document.h"
+#include <utility>
 
 // Initialize static member
 Document* Document::instance = nullptr;
@@ -13,19 +14,87 @@ Document* Document::getInstance() {
 
 // Document management methods
 void Document::addElement(std::unique_ptr<IDocumentElement> element) {
-    elements.push_back(std::move(element));
+    elements.pushBack(std::move(element));
+    recordChange(ElementChange::Kind::Insert, elements.size() - 1);
+}
+
+void Document::insertElement(size_t index, std::unique_ptr<IDocumentElement> element) {
+    elements.insert(index, std::move(element));
+    recordChange(ElementChange::Kind::Insert, index);
 }
 
 void Document::removeElement(size_t index) {
     if (index < elements.size()) {
-        elements.erase(elements.begin() + index);
+        elements.erase(index);
+        recordChange(ElementChange::Kind::Erase, index);
     }
 }
 
-const std::vector<std::unique_ptr<IDocumentElement>>& Document::getElements() const {
+const ElementTree& Document::getElements() const {
     return elements;
 }
 
+const IDocumentElement& Document::getElement(size_t index) const {
+    return *elements.at(index);
+}
+
+IDocumentElement& Document::editElement(size_t index) {
+    // The caller edits after this returns, so the change records the element
+    // and its contents are read when the change is saved
+    IDocumentElement& element = elements.mutableAt(index);
+    recordChange(ElementChange::Kind::Replace, index);
+    return element;
+}
+
+size_t Document::size() const {
+    return elements.size();
+}
+
 void Document::clear() {
     elements.clear();
-} 
\ No newline at end of file
+    trackingChanges = false;
+    changes.clear();
+}
+
+ElementTree Document::snapshot() const {
+    return elements;
+}
+
+void Document::restore(const ElementTree& version) {
+    elements = version;
+    trackingChanges = false;
+    changes.clear();
+}
+
+void Document::trackChanges() {
+    trackingChanges = true;
+    changes.clear();
+}
+
+bool Document::isTrackingChanges() const {
+    return trackingChanges;
+}
+
+std::vector<ElementChange> Document::takeChanges() {
+    return std::exchange(changes, {});
+}
+
+void Document::recordChange(ElementChange::Kind kind, size_t index) {
+    if (!trackingChanges) {
+        return;
+    }
+    ElementChange change{kind, index, {}};
+    if (kind != ElementChange::Kind::Erase) {
+        change.element = elements.pointerAt(index);
+    }
+
+    // Editing the same element again before a save needs no new record
+    if (kind == ElementChange::Kind::Replace && !changes.empty()) {
+        const ElementChange& last = changes.back();
+        if (last.kind != ElementChange::Kind::Erase && last.index == index
+            && !last.element.owner_before(change.element) && !change.element.owner_before(last.element)) {
+            return;
+        }
+    }
+    changes.push_back(std::move(change));
+}
@@ -1,22 +1,52 @@
 #include "../include/document_renderer.h"
-#include <sstream>
+
+// Each renderer checks the element's kind and casts statically; no RTTI
 
 std::string TextRenderer::render(const IDocumentElement& element) {
-    // Cast to TextElement to access its specific methods
-    const TextElement* textElement = dynamic_cast<const TextElement*>(&element);
-    if (textElement) {
-        return textElement->getContent();
+    if (element.getKind() == IDocumentElement::Kind::Text) {
+        return static_cast<const TextElement&>(element).getContent();
     }
     return "[Invalid Text Element]";
 }
 
 std::string ImageRenderer::render(const IDocumentElement& element) {
-    // Cast to ImageElement to access its specific methods
-    const ImageElement* imageElement = dynamic_cast<const ImageElement*>(&element);
-    if (imageElement) {
-        std::stringstream ss;
-        ss << "[Image: " << imageElement->getWidth() << "x" << imageElement->getHeight() << "]";
-        return ss.str();
+    if (element.getKind() == IDocumentElement::Kind::Image) {
+        const auto& imageElement = static_cast<const ImageElement&>(element);
+        std::string output = "[Image: ";
+        output += std::to_string(imageElement.getWidth());
+        output += 'x';
+        output += std::to_string(imageElement.getHeight());
+        output += ']';
+        return output;
     }
     return "[Invalid Image Element]";
-} 
\ No newline at end of file
+}
+
+std::string TableRenderer::render(const IDocumentElement& element) {
+    if (element.getKind() == IDocumentElement::Kind::Table) {
+        const auto& data = static_cast<const TableElement&>(element).getData();
+
+        // Sized up front, so the output is built without reallocating
+        size_t bytes = 7;
+        for (const auto& row : data) {
+            bytes += 2;
+            for (const auto& cell : row) {
+                bytes += cell.size() + 3;
+            }
+        }
+        std::string output;
+        output.reserve(bytes);
+        output += "[Table]";
+        for (const auto& row : data) {
+            output += '\n';
+            for (const auto& cell : row) {
+                output += "| ";
+                output += cell;
+                output += ' ';
+            }
+            output += '|';
+        }
+        return output;
+    }
+    return "[Invalid Table Element]";
+}
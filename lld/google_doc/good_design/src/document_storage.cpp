@@ -1,121 +1,484 @@
 #include "../include/document_storage.h"
-#include <sstream>
+#include "../include/binary_document.h"
+#include "../include/change_log.h"
+#include "../include/file_sync.h"
+#include "../third_party/json.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <filesystem>
 
-bool DocumentStorage::saveToFile(const std::string& filename) {
+using json = nlohmann::json;
+
+namespace {
+
+// SAX handler turning parser events into elements. Only the element being
+// read is held, so memory stays bounded by the largest element.
+//
+// Expected shape: [ { "type": ..., <fields of that type> }, ... ]
+// Unknown members are skipped; a known member of the wrong type fails the load.
+class ElementReader : public nlohmann::json_sax<json> {
+public:
+    explicit ElementReader(ElementTree& elements) : elements(elements) {}
+
+    bool null() override { return !misplaced(); }
+    bool boolean(bool) override { return !misplaced(); }
+    bool number_integer(number_integer_t value) override { return number(value); }
+    bool number_unsigned(number_unsigned_t value) override {
+        return number(value > LLONG_MAX ? LLONG_MAX : static_cast<long long>(value));
+    }
+    bool number_float(number_float_t value, const string_t&) override {
+        return number(static_cast<long long>(value));
+    }
+    bool binary(binary_t&) override { return false; }
+
+    bool string(string_t& value) override {
+        if (inData) {
+            if (depth != 4) {
+                return false;
+            }
+            fields.data.back().push_back(std::move(value));
+            return true;
+        }
+        if (depth != 2) {
+            return depth > 2;
+        }
+        if (currentKey == "type") {
+            fields.type = std::move(value);
+        } else if (currentKey == "content") {
+            fields.content = std::move(value);
+            fields.hasContent = true;
+        } else if (currentKey == "style") {
+            fields.style = std::move(value);
+            fields.hasStyle = true;
+        } else if (currentKey == "path") {
+            fields.path = std::move(value);
+            fields.hasPath = true;
+        } else if (isKnownKey(currentKey)) {
+            return false;
+        }
+        return true;
+    }
+
+    bool start_object(std::size_t) override {
+        if (depth == 0 || inData || (depth == 2 && isKnownKey(currentKey))) {
+            return false;
+        }
+        if (depth == 1) {
+            fields = Fields();
+        }
+        ++depth;
+        return true;
+    }
+
+    bool key(string_t& name) override {
+        if (depth == 2) {
+            currentKey = std::move(name);
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        --depth;
+        return depth != 1 || finishElement();
+    }
+
+    bool start_array(std::size_t) override {
+        if (depth == 1) {
+            return false;
+        }
+        if (depth == 2 && currentKey == "data") {
+            inData = true;
+            fields.data.clear();
+            fields.hasData = true;
+        } else if (inData) {
+            if (depth != 3) {
+                return false;
+            }
+            fields.data.emplace_back();
+        } else if (depth == 2 && isKnownKey(currentKey)) {
+            return false;
+        }
+        ++depth;
+        return true;
+    }
+
+    bool end_array() override {
+        --depth;
+        if (depth == 2) {
+            inData = false;
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+        return false;
+    }
+
+private:
+    struct Fields {
+        std::string type;
+        std::string content;
+        std::string style;
+        std::string path;
+        long long width = 0;
+        long long height = 0;
+        std::vector<std::vector<std::string>> data;
+        bool hasContent = false;
+        bool hasStyle = false;
+        bool hasPath = false;
+        bool hasWidth = false;
+        bool hasHeight = false;
+        bool hasData = false;
+    };
+
+    static bool isKnownKey(const std::string& name) {
+        return name == "type" || name == "content" || name == "style" || name == "path"
+            || name == "width" || name == "height" || name == "data";
+    }
+
+    // A scalar that cannot stand where it is
+    bool misplaced() const {
+        return depth <= 1 || inData || (depth == 2 && isKnownKey(currentKey));
+    }
+
+    bool number(long long value) {
+        if (depth == 2 && !inData && (currentKey == "width" || currentKey == "height")) {
+            if (value < INT_MIN || value > INT_MAX) {
+                return false;
+            }
+            (currentKey == "width" ? fields.width : fields.height) = value;
+            (currentKey == "width" ? fields.hasWidth : fields.hasHeight) = true;
+            return true;
+        }
+        return !misplaced();
+    }
+
+    bool finishElement() {
+        if (fields.type == "text" && fields.hasContent && fields.hasStyle) {
+            elements.pushBack(std::make_unique<TextElement>(fields.content, fields.style));
+        } else if (fields.type == "image" && fields.hasPath && fields.hasWidth && fields.hasHeight) {
+            auto element = std::make_unique<ImageElement>(fields.path);
+            element->setDimensions(static_cast<int>(fields.width), static_cast<int>(fields.height));
+            elements.pushBack(std::move(element));
+        } else if (fields.type == "table" && fields.hasData && fields.hasStyle) {
+            auto element = std::make_unique<TableElement>();
+            element->setData(fields.data);
+            element->setStyle(fields.style);
+            elements.pushBack(std::move(element));
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    ElementTree& elements;
+    Fields fields;
+    std::string currentKey;
+    size_t depth = 0;  // open arrays and objects
+    bool inData = false;
+};
+
+size_t fileBytes(const std::string& path) {
+    std::error_code error;
+    auto bytes = std::filesystem::file_size(path, error);
+    return error ? 0 : static_cast<size_t>(bytes);
+}
+
+} // namespace
+
+DocumentStorage::DocumentStorage() = default;
+
+DocumentStorage::~DocumentStorage() {
+    waitForCompaction();
+}
+
+bool DocumentStorage::saveToFile(const std::string& filename, JsonWriter::Style style) {
     Document* doc = Document::getInstance();
-    std::ofstream file(filename);
+    // A compaction finishing later would rename its file over this one
+    waitForCompaction();
+    // Written beside the target and renamed over it, as binary saves are, so
+    // a failed or interrupted save leaves the old file whole
+    const std::string temporary = filename + ".tmp";
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
     if (!file.is_open()) {
         return false;
     }
 
-    // Create JSON array to store all elements
-    json documentJson = json::array();
-    
-    // Convert each element to JSON
-    for (const auto& element : doc->getElements()) {
-        documentJson.push_back(elementToJson(*element));
+    try {
+        // Write each element as soon as it is reached
+        JsonWriter writer(file, style);
+        writer.beginArray();
+        for (const auto& element : doc->getElements()) {
+            writeElement(writer, *element);
+        }
+        writer.endArray();
+
+        bool written = writer.flush();
+        file.close();
+        if (!written || file.fail()) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+        syncFile(temporary);
+        if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+        syncParentDirectory(filename);
+        // A JSON file has no log, so the next incremental save writes it whole
+        dropLog(filename);
+        return true;
+    } catch (const std::exception& e) {
+        file.close();
+        std::remove(temporary.c_str());
+        return false;
     }
-    
-    // Write JSON to file with pretty printing
-    file << documentJson.dump(4);
-    file.close();
-    return true;
 }
 
 bool DocumentStorage::loadFromFile(const std::string& filename) {
     Document* doc = Document::getInstance();
-    std::ifstream file(filename);
+    std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) {
         return false;
     }
 
     try {
-        // Read JSON from file
-        json documentJson;
-        file >> documentJson;
-        file.close();
+        // Build into a separate tree so a bad file leaves the document as it was
+        ElementTree loaded;
+        ElementReader reader(loaded);
+        if (!json::sax_parse(file, &reader)) {
+            return false;
+        }
+        doc->restore(loaded);
+        return true;
+    } catch (const std::exception& e) {
+        return false;
+    }
+}
 
-        // Clear existing document
-        doc->clear();
+bool DocumentStorage::saveToBinaryFile(const std::string& filename) {
+    Document* doc = Document::getInstance();
+    waitForCompaction();
+    try {
+        uint64_t id = BinaryDocument::write(filename, doc->getElements());
+        // The new file already holds every change the log recorded, so
+        // incremental saves carry on from it with an empty log
+        if (doc->isTrackingChanges() && isLogged(filename)) {
+            startLog(doc, filename, id);
+        } else {
+            dropLog(filename);
+        }
+        return true;
+    } catch (const std::exception& e) {
+        return false;
+    }
+}
+
+bool DocumentStorage::loadFromBinaryFile(const std::string& filename) {
+    Document* doc = Document::getInstance();
+    waitForCompaction();
+    try {
+        auto file = std::make_shared<const BinaryDocument>(filename);
+        ElementTree loaded(file);
 
-        // Convert JSON back to elements
-        for (const auto& elementJson : documentJson) {
-            doc->addElement(jsonToElement(elementJson));
+        // Changes saved incrementally since the file was written
+        const std::string logPath = ChangeLog::pathFor(filename, file->id());
+        std::unique_lock<std::mutex> lock(logMutex);
+        if (changeLog && changeLog->filePath() == logPath) {
+            changeLog->replay(loaded);
+        } else if (std::filesystem::exists(logPath)) {
+            ChangeLog(logPath, file->id()).replay(loaded);
         }
+        lock.unlock();
+
+        doc->restore(loaded);
         return true;
     } catch (const std::exception& e) {
         return false;
     }
 }
 
-json DocumentStorage::elementToJson(const IDocumentElement& element) {
-    json j;
-    j["type"] = element.getType();
-    
-    // Convert specific element types
-    if (element.getType() == "text") {
-        const TextElement& textElement = static_cast<const TextElement&>(element);
-        j.merge_patch(textElementToJson(textElement));
-    } else if (element.getType() == "image") {
-        const ImageElement& imageElement = static_cast<const ImageElement&>(element);
-        j.merge_patch(imageElementToJson(imageElement));
-    } else if (element.getType() == "table") {
-        const TableElement& tableElement = static_cast<const TableElement&>(element);
-        j.merge_patch(tableElementToJson(tableElement));
+bool DocumentStorage::saveIncremental(const std::string& filename) {
+    Document* doc = Document::getInstance();
+    try {
+        std::unique_lock<std::mutex> lock(logMutex);
+        if (!doc->isTrackingChanges() || !changeLog || filename != logDocumentPath) {
+            lock.unlock();
+            return saveWhole(doc, filename);
+        }
+
+        try {
+            changeLog->append(doc->takeChanges());
+        } catch (...) {
+            // The changes taken are not in the log, so the next save writes
+            // the whole file
+            changeLog.reset();
+            throw;
+        }
+
+        if (!compacting && changeLog->size() > std::max(MIN_COMPACT_LOG_BYTES, documentBytes / 4)) {
+            // A finished compaction thread has already let go of the lock
+            if (compaction.joinable()) {
+                compaction.join();
+            }
+            compacting = true;
+            compaction = std::thread(&DocumentStorage::compact, this, doc->snapshot(), changeLog->size());
+        }
+        return true;
+    } catch (const std::exception& e) {
+        return false;
     }
-    
-    return j;
 }
 
-std::unique_ptr<IDocumentElement> DocumentStorage::jsonToElement(const json& j) {
-    std::string type = j["type"];
-    
-    if (type == "text") {
-        return jsonToTextElement(j);
-    } else if (type == "image") {
-        return jsonToImageElement(j);
-    } else if (type == "table") {
-        return jsonToTableElement(j);
+bool DocumentStorage::loadIncremental(const std::string& filename) {
+    Document* doc = Document::getInstance();
+    waitForCompaction();
+    try {
+        auto file = std::make_shared<const BinaryDocument>(filename);
+        ElementTree loaded(file);
+        auto log = std::make_unique<ChangeLog>(ChangeLog::pathFor(filename, file->id()), file->id());
+        log->replay(loaded);
+
+        doc->restore(loaded);
+        doc->trackChanges();
+        std::lock_guard<std::mutex> lock(logMutex);
+        changeLog = std::move(log);
+        logDocumentPath = filename;
+        documentBytes = fileBytes(filename);
+        return true;
+    } catch (const std::exception& e) {
+        return false;
+    }
+}
+
+bool DocumentStorage::saveWhole(Document* doc, const std::string& filename) {
+    waitForCompaction();
+    uint64_t id = BinaryDocument::write(filename, doc->getElements());
+    startLog(doc, filename, id);
+    return true;
+}
+
+void DocumentStorage::startLog(Document* doc, const std::string& filename, uint64_t id) {
+    doc->trackChanges();
+
+    std::lock_guard<std::mutex> lock(logMutex);
+    // The old log described the file just replaced
+    if (changeLog && filename == logDocumentPath) {
+        std::remove(changeLog->filePath().c_str());
+    }
+    changeLog.reset();
+    changeLog = std::make_unique<ChangeLog>(ChangeLog::pathFor(filename, id), id);
+    logDocumentPath = filename;
+    documentBytes = fileBytes(filename);
+}
+
+bool DocumentStorage::isLogged(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    return changeLog && filename == logDocumentPath;
+}
+
+void DocumentStorage::dropLog(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    if (changeLog && filename == logDocumentPath) {
+        std::remove(changeLog->filePath().c_str());
+        changeLog.reset();
+        logDocumentPath.clear();
     }
-    
-    return nullptr;
 }
 
-json DocumentStorage::textElementToJson(const TextElement& element) {
-    json j;
-    j["content"] = element.getContent();
-    j["style"] = element.getStyle();
-    return j;
+// Background thread: writes snapshot, which is the file plus the log up to
+// logOffset, as a fresh file, then moves changes saved meanwhile to its log
+void DocumentStorage::compact(ElementTree snapshot, size_t logOffset) {
+    const std::string path = logDocumentPath;
+    const std::string staging = path + ".compacting";
+    std::string freshLogPath;
+    try {
+        uint64_t id = BinaryDocument::write(staging, snapshot);
+        freshLogPath = ChangeLog::pathFor(path, id);
+
+        std::lock_guard<std::mutex> lock(logMutex);
+        if (!changeLog) {
+            throw std::runtime_error("Change log was dropped");
+        }
+        auto fresh = std::make_unique<ChangeLog>(freshLogPath, id);
+        fresh->appendRecords(changeLog->recordsFrom(logOffset));
+
+        // The switch: until this rename the old file and log are current
+        if (std::rename(staging.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("Cannot install compacted " + path);
+        }
+        syncParentDirectory(path);
+        std::remove(changeLog->filePath().c_str());
+        changeLog = std::move(fresh);
+        documentBytes = fileBytes(path);
+        compacting = false;
+    } catch (const std::exception& e) {
+        // Keep the old file and log; a later save tries again
+        std::remove(staging.c_str());
+        if (!freshLogPath.empty()) {
+            std::remove(freshLogPath.c_str());
+        }
+        std::lock_guard<std::mutex> lock(logMutex);
+        compacting = false;
+    }
 }
 
-json DocumentStorage::imageElementToJson(const ImageElement& element) {
-    json j;
-    j["path"] = element.getImagePath();
-    j["width"] = element.getWidth();
-    j["height"] = element.getHeight();
-    return j;
+void DocumentStorage::waitForCompaction() {
+    if (compaction.joinable()) {
+        compaction.join();
+    }
 }
 
-json DocumentStorage::tableElementToJson(const TableElement& element) {
-    json j;
-    j["data"] = element.getData();
-    j["style"] = element.getStyle();
-    return j;
+void DocumentStorage::writeElement(JsonWriter& writer, const IDocumentElement& element) {
+    // Members are written in sorted order, as nlohmann::json stores them
+    writer.beginObject();
+    if (element.getType() == "text") {
+        writeTextElement(writer, static_cast<const TextElement&>(element));
+    } else if (element.getType() == "image") {
+        writeImageElement(writer, static_cast<const ImageElement&>(element));
+    } else if (element.getType() == "table") {
+        writeTableElement(writer, static_cast<const TableElement&>(element));
+    } else {
+        writer.key("type");
+        writer.value(element.getType());
+    }
+    writer.endObject();
 }
 
-std::unique_ptr<TextElement> DocumentStorage::jsonToTextElement(const json& j) {
-    return std::make_unique<TextElement>(j["content"], j["style"]);
+void DocumentStorage::writeTextElement(JsonWriter& writer, const TextElement& element) {
+    writer.key("content");
+    writer.value(element.getContent());
+    writer.key("style");
+    writer.value(element.getStyle());
+    writer.key("type");
+    writer.value(element.getType());
 }
 
-std::unique_ptr<ImageElement> DocumentStorage::jsonToImageElement(const json& j) {
-    auto element = std::make_unique<ImageElement>(j["path"]);
-    element->setDimensions(j["width"], j["height"]);
-    return element;
+void DocumentStorage::writeImageElement(JsonWriter& writer, const ImageElement& element) {
+    writer.key("height");
+    writer.value(element.getHeight());
+    writer.key("path");
+    writer.value(element.getImagePath());
+    writer.key("type");
+    writer.value(element.getType());
+    writer.key("width");
+    writer.value(element.getWidth());
 }
 
-std::unique_ptr<TableElement> DocumentStorage::jsonToTableElement(const json& j) {
-    auto element = std::make_unique<TableElement>();
-    element->setData(j["data"]);
-    element->setStyle(j["style"]);
-    return element;
-}
\ No newline at end of file
+void DocumentStorage::writeTableElement(JsonWriter& writer, const TableElement& element) {
+    writer.key("data");
+    writer.beginArray();
+    for (const auto& row : element.getData()) {
+        writer.beginArray();
+        for (const auto& cell : row) {
+            writer.value(cell);
+        }
+        writer.endArray();
+    }
+    writer.endArray();
+    writer.key("style");
+    writer.value(element.getStyle());
+    writer.key("type");
+    writer.value(element.getType());
+}
@@ -0,0 +1,331 @@
+#include "../include/element_tree.h"
+#include <atomic>
+#include <stdexcept>
+
+// Iterator
+ElementTree::const_iterator& ElementTree::const_iterator::operator++() {
+    Frame& leaf = path[depth - 1];
+    if (++leaf.position < leaf.node->elements.size()) {
+        return *this;
+    }
+
+    // Leaf done: climb to the first ancestor with a child left, then go down its left edge
+    --depth;
+    while (depth > 0) {
+        Frame& frame = path[depth - 1];
+        if (++frame.position < frame.node->children.size()) {
+            descendLeftmost();
+            return *this;
+        }
+        --depth;
+    }
+    return *this;
+}
+
+bool ElementTree::const_iterator::operator==(const const_iterator& other) const {
+    if (depth != other.depth) {
+        return false;
+    }
+    return depth == 0
+        || (path[depth - 1].node == other.path[depth - 1].node && path[depth - 1].position == other.path[depth - 1].position);
+}
+
+void ElementTree::const_iterator::descendLeftmost() {
+    while (true) {
+        const Frame& frame = path[depth - 1];
+        const Node& node = load(*frame.node);
+        if (node.leaf) {
+            return;
+        }
+        path[depth++] = Frame{node.children[frame.position].get(), 0};
+    }
+}
+
+ElementTree::const_iterator ElementTree::begin() const {
+    const_iterator it;
+    if (!empty()) {
+        it.path[0] = const_iterator::Frame{root.get(), 0};
+        it.depth = 1;
+        it.descendLeftmost();
+    }
+    return it;
+}
+
+ElementTree::const_iterator ElementTree::iteratorAt(size_t index) const {
+    const_iterator it;
+    if (index >= size()) {
+        return it;
+    }
+    const Node* node = &load(*root);
+    it.path[it.depth++] = const_iterator::Frame{node, 0};
+    while (!node->leaf) {
+        size_t child = childFor(*node, index);
+        it.path[it.depth - 1].position = child;
+        node = &load(*node->children[child]);
+        it.path[it.depth++] = const_iterator::Frame{node, 0};
+    }
+    it.path[it.depth - 1].position = index;
+    return it;
+}
+
+// Lookup
+size_t ElementTree::childFor(const Node& node, size_t& index) {
+    // Linear over at most MAX_CHILDREN counts; leaves index relative to the child
+    for (size_t i = 0; i + 1 < node.children.size(); ++i) {
+        size_t count = node.children[i]->count;
+        if (index < count) {
+            return i;
+        }
+        index -= count;
+    }
+    return node.children.size() - 1;
+}
+
+const ElementTree::ElementPtr& ElementTree::find(size_t index) const {
+    if (index >= size()) {
+        throw std::out_of_range("Element index out of range");
+    }
+    const Node* node = &load(*root);
+    while (!node->leaf) {
+        node = &load(*node->children[childFor(*node, index)]);
+    }
+    return node->elements[index].element;
+}
+
+ElementTree::ElementPtr ElementTree::pointerAt(size_t index) const {
+    return find(index);
+}
+
+ElementTree::Slot& ElementTree::unshare(size_t index) {
+    if (index >= size()) {
+        throw std::out_of_range("Element index out of range");
+    }
+    Node* node = makeUnique(root).get();
+    while (!node->leaf) {
+        node = makeUnique(node->children[childFor(*node, index)]).get();
+    }
+    return node->elements[index];
+}
+
+void ElementTree::replace(size_t index, ElementPtr element) {
+    unshare(index) = Slot{std::move(element), newRevision()};
+}
+
+IDocumentElement& ElementTree::mutableAt(size_t index) {
+    Slot& slot = unshare(index);
+    if (slot.element.use_count() > 1) {
+        slot.element = slot.element->clone();
+    }
+    slot.revision = newRevision();
+    // Every element is created non-const and is now owned by this tree alone
+    return const_cast<IDocumentElement&>(*slot.element);
+}
+
+// Loading
+ElementTree::ElementTree(std::shared_ptr<const ElementSource> source) {
+    size_t count = source ? source->size() : 0;
+    if (count == 0) {
+        return;
+    }
+    root = std::make_shared<Node>();
+    root->count = count;
+    for (size_t span = MAX_CHILDREN; span < count; span *= MAX_CHILDREN) {
+        ++root->height;
+    }
+    root->leaf = root->height == 0;
+    root->source = std::move(source);
+}
+
+ElementTree::Node::Node(const Node& other)
+    : leaf(other.leaf), count(other.count) {
+    load(other);
+    elements = other.elements;
+    children = other.children;
+}
+
+const ElementTree::Node& ElementTree::load(const Node& node) {
+    if (node.source) {
+        // Nodes are never created const, and call_once orders this write
+        // before every reader that gets past it
+        std::call_once(node.loaded, [&node] { loadFromSource(const_cast<Node&>(node)); });
+    }
+    return node;
+}
+
+void ElementTree::loadFromSource(Node& node) {
+    if (node.leaf) {
+        std::vector<Slot> loaded;
+        loaded.reserve(node.count);
+        for (size_t i = 0; i < node.count; ++i) {
+            loaded.push_back(Slot{node.source->load(node.first + i), newRevision()});
+        }
+        node.elements = std::move(loaded);
+        return;
+    }
+
+    // Split the range evenly over as few children as fit one level down;
+    // a child of height h holds up to MAX_CHILDREN^(h + 1) elements
+    size_t span = 1;
+    for (size_t level = 0; level < node.height; ++level) {
+        span *= MAX_CHILDREN;
+    }
+    size_t parts = (node.count + span - 1) / span;
+    size_t first = node.first;
+    for (size_t i = 0; i < parts; ++i) {
+        auto child = std::make_shared<Node>();
+        child->count = node.count / parts + (i < node.count % parts ? 1 : 0);
+        child->height = node.height - 1;
+        child->leaf = child->height == 0;
+        child->source = node.source;
+        child->first = first;
+        first += child->count;
+        node.children.push_back(std::move(child));
+    }
+}
+
+// Unique across every tree; concurrent readers may load leaves
+uint64_t ElementTree::newRevision() {
+    static std::atomic<uint64_t> revisions{0};
+    return revisions.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// Copy-on-write; the node returned is loaded
+ElementTree::NodePtr& ElementTree::makeUnique(NodePtr& node) {
+    if (node.use_count() > 1) {
+        node = std::make_shared<Node>(*node);
+    } else {
+        load(*node);
+    }
+    return node;
+}
+
+// Insert
+void ElementTree::insert(size_t index, ElementPtr element) {
+    if (index > size()) {
+        throw std::out_of_range("Element index out of range");
+    }
+    if (!root) {
+        root = std::make_shared<Node>();
+    }
+    if (NodePtr sibling = insertInto(root, index, std::move(element))) {
+        auto newRoot = std::make_shared<Node>();
+        newRoot->leaf = false;
+        newRoot->count = root->count + sibling->count;
+        newRoot->children = {root, sibling};
+        root = newRoot;
+    }
+}
+
+ElementTree::NodePtr ElementTree::insertInto(NodePtr& nodePtr, size_t index, ElementPtr element) {
+    Node& node = *makeUnique(nodePtr);
+    ++node.count;
+    if (node.leaf) {
+        node.elements.insert(node.elements.begin() + index, Slot{std::move(element), newRevision()});
+        return node.elements.size() > MAX_CHILDREN ? splitOff(node) : nullptr;
+    }
+
+    // index == count of the last child appends to it
+    size_t child = childFor(node, index);
+    if (NodePtr sibling = insertInto(node.children[child], index, std::move(element))) {
+        node.children.insert(node.children.begin() + child + 1, sibling);
+        return node.children.size() > MAX_CHILDREN ? splitOff(node) : nullptr;
+    }
+    return nullptr;
+}
+
+ElementTree::NodePtr ElementTree::splitOff(Node& node) {
+    auto right = std::make_shared<Node>();
+    right->leaf = node.leaf;
+    if (node.leaf) {
+        size_t half = node.elements.size() / 2;
+        right->elements.assign(node.elements.begin() + half, node.elements.end());
+        node.elements.resize(half);
+        right->count = right->elements.size();
+    } else {
+        size_t half = node.children.size() / 2;
+        right->children.assign(node.children.begin() + half, node.children.end());
+        node.children.resize(half);
+        for (const auto& child : right->children) {
+            right->count += child->count;
+        }
+    }
+    node.count -= right->count;
+    return right;
+}
+
+// Erase
+void ElementTree::erase(size_t index) {
+    if (index >= size()) {
+        throw std::out_of_range("Element index out of range");
+    }
+    eraseFrom(root, index);
+    if (root->count == 0) {
+        root.reset();
+    } else if (!root->leaf && root->children.size() == 1) {
+        NodePtr only = root->children.front();
+        root = only;
+    }
+}
+
+void ElementTree::eraseFrom(NodePtr& nodePtr, size_t index) {
+    Node& node = *makeUnique(nodePtr);
+    --node.count;
+    if (node.leaf) {
+        node.elements.erase(node.elements.begin() + index);
+        return;
+    }
+
+    size_t child = childFor(node, index);
+    eraseFrom(node.children[child], index);
+    const Node& after = *node.children[child];
+    if ((after.leaf ? after.elements.size() : after.children.size()) < MIN_CHILDREN) {
+        rebalance(node, child);
+    }
+}
+
+void ElementTree::rebalance(Node& parent, size_t child) {
+    if (parent.children.size() < 2) {
+        return;
+    }
+    size_t leftIndex = child > 0 ? child - 1 : child;
+    Node& left = *makeUnique(parent.children[leftIndex]);
+    Node& right = *makeUnique(parent.children[leftIndex + 1]);
+
+    if (left.leaf) {
+        size_t total = left.elements.size() + right.elements.size();
+        if (total <= MAX_CHILDREN) {
+            left.elements.insert(left.elements.end(), right.elements.begin(), right.elements.end());
+            left.count += right.count;
+            parent.children.erase(parent.children.begin() + leftIndex + 1);
+            return;
+        }
+        // Too many for one node: even them out
+        std::vector<Slot> all = std::move(left.elements);
+        all.insert(all.end(), right.elements.begin(), right.elements.end());
+        left.elements.assign(all.begin(), all.begin() + total / 2);
+        right.elements.assign(all.begin() + total / 2, all.end());
+        left.count = left.elements.size();
+        right.count = right.elements.size();
+        return;
+    }
+
+    size_t total = left.children.size() + right.children.size();
+    if (total <= MAX_CHILDREN) {
+        left.children.insert(left.children.end(), right.children.begin(), right.children.end());
+        left.count += right.count;
+        parent.children.erase(parent.children.begin() + leftIndex + 1);
+        return;
+    }
+    std::vector<NodePtr> all = std::move(left.children);
+    all.insert(all.end(), right.children.begin(), right.children.end());
+    left.children.assign(all.begin(), all.begin() + total / 2);
+    right.children.assign(all.begin() + total / 2, all.end());
+    left.count = 0;
+    for (const auto& node : left.children) {
+        left.count += node->count;
+    }
+    right.count = 0;
+    for (const auto& node : right.children) {
+        right.count += node->count;
+    }
+}
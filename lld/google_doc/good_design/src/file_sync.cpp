@@ -0,0 +1,38 @@
+#include "../include/file_sync.h"
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+std::runtime_error systemError(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+void syncPath(const std::string& path, int flags, const char* what) {
+    int fd = ::open(path.c_str(), flags);
+    if (fd < 0) {
+        throw systemError(what, path);
+    }
+    if (::fsync(fd) != 0) {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        throw systemError(what, path);
+    }
+    ::close(fd);
+}
+
+} // namespace
+
+void syncFile(const std::string& path) {
+    syncPath(path, O_WRONLY, "Cannot sync file");
+}
+
+void syncParentDirectory(const std::string& path) {
+    std::string directory = std::filesystem::path(path).parent_path().string();
+    syncPath(directory.empty() ? "." : directory, O_RDONLY | O_DIRECTORY, "Cannot sync directory");
+}
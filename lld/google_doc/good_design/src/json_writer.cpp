@@ -0,0 +1,173 @@
+#include "../include/json_writer.h"
+#include <stdexcept>
+
+JsonWriter::JsonWriter(std::ostream& out, Style style)
+    : out(out), style(style) {
+    buffer.reserve(FLUSH_THRESHOLD + 4096);
+}
+
+JsonWriter::~JsonWriter() {
+    flush();
+}
+
+void JsonWriter::beginArray() {
+    beforeValue();
+    buffer += '[';
+    containerEmpty.push_back(true);
+}
+
+void JsonWriter::endArray() {
+    closeContainer(']');
+}
+
+void JsonWriter::beginObject() {
+    beforeValue();
+    buffer += '{';
+    containerEmpty.push_back(true);
+}
+
+void JsonWriter::endObject() {
+    closeContainer('}');
+}
+
+void JsonWriter::key(const std::string& name) {
+    beforeValue();
+    writeString(name);
+    buffer += style == Style::Pretty ? ": " : ":";
+    afterKey = true;
+}
+
+void JsonWriter::value(const std::string& text) {
+    beforeValue();
+    writeString(text);
+    maybeFlush();
+}
+
+void JsonWriter::value(long long number) {
+    beforeValue();
+    buffer += std::to_string(number);
+    maybeFlush();
+}
+
+bool JsonWriter::flush() {
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+    return static_cast<bool>(out);
+}
+
+// Separator and indentation owed before the next value or key
+void JsonWriter::beforeValue() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (containerEmpty.empty()) {
+        return;
+    }
+    if (!containerEmpty.back()) {
+        buffer += ',';
+    }
+    containerEmpty.back() = false;
+    if (style == Style::Pretty) {
+        buffer += '\n';
+        buffer.append(containerEmpty.size() * 4, ' ');
+    }
+}
+
+void JsonWriter::closeContainer(char close) {
+    bool empty = containerEmpty.back();
+    containerEmpty.pop_back();
+    if (!empty && style == Style::Pretty) {
+        buffer += '\n';
+        buffer.append(containerEmpty.size() * 4, ' ');
+    }
+    buffer += close;
+    maybeFlush();
+}
+
+namespace {
+
+// Length of the well-formed UTF-8 sequence (RFC 3629) starting at text[i],
+// or 0 if there is none: no overlong forms, surrogates or code points past
+// U+10FFFF, which is what nlohmann's parser accepts
+size_t utf8SequenceLength(const std::string& text, size_t i) {
+    unsigned char lead = static_cast<unsigned char>(text[i]);
+    size_t length = 0;
+    unsigned char low = 0x80;   // range of the second byte
+    unsigned char high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        low = lead == 0xE0 ? 0xA0 : 0x80;
+        high = lead == 0xED ? 0x9F : 0xBF;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        low = lead == 0xF0 ? 0x90 : 0x80;
+        high = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+        return 0;
+    }
+    if (text.size() - i < length) {
+        return 0;
+    }
+    for (size_t k = 1; k < length; ++k) {
+        unsigned char c = static_cast<unsigned char>(text[i + k]);
+        if (c < low || c > high) {
+            return 0;
+        }
+        low = 0x80;
+        high = 0xBF;
+    }
+    return length;
+}
+
+} // namespace
+
+// Escapes as nlohmann::json does. Text must be UTF-8: anything else is
+// rejected here, as nlohmann::json::dump did, rather than written to a file
+// that cannot be loaded again.
+void JsonWriter::writeString(const std::string& text) {
+    static const char HEX[] = "0123456789abcdef";
+    buffer += '"';
+    size_t plain = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x80) {
+            size_t length = utf8SequenceLength(text, i);
+            if (length == 0) {
+                throw std::invalid_argument("Invalid UTF-8 in JSON string at byte " + std::to_string(i));
+            }
+            i += length - 1;
+            continue;
+        }
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        // Copy the run of characters that need no escaping in one go
+        buffer.append(text, plain, i - plain);
+        plain = i + 1;
+        switch (c) {
+            case '"': buffer += "\\\""; break;
+            case '\\': buffer += "\\\\"; break;
+            case '\b': buffer += "\\b"; break;
+            case '\f': buffer += "\\f"; break;
+            case '\n': buffer += "\\n"; break;
+            case '\r': buffer += "\\r"; break;
+            case '\t': buffer += "\\t"; break;
+            default:
+                buffer += "\\u00";
+                buffer += HEX[c >> 4];
+                buffer += HEX[c & 0xF];
+                break;
+        }
+    }
+    buffer.append(text, plain, text.size() - plain);
+    buffer += '"';
+}
+
+void JsonWriter::maybeFlush() {
+    if (buffer.size() >= FLUSH_THRESHOLD) {
+        flush();
+    }
+}
@@ -2,6 +2,7 @@
 #include "../include/document_element.h"
 #include "../include/document_renderer.h"
 #include "../include/document_storage.h"
+#include "../include/render_engine.h"
 #include <iostream>
 
 void printDocument(const Document* doc) {
@@ -47,6 +48,10 @@ int main() {
     // Print initial document
     std::cout << "Initial Document:\n";
     printDocument(doc);
+
+    // Render document
+    RenderEngine renderer;
+    std::cout << "\nRendered Document:\n" << renderer.render(doc->getElements());
     
     // Save document
     DocumentStorage storage;
@@ -0,0 +1,181 @@
+#include "../include/render_engine.h"
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace {
+
+size_t chunkCount(size_t elements, size_t minChunkElements) {
+    size_t threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    return std::clamp<size_t>(elements / minChunkElements, 1, threads);
+}
+
+size_t chunkBegin(size_t elements, size_t chunks, size_t chunk) {
+    return elements * chunk / chunks;
+}
+
+// Runs work(chunk, begin, end) for each chunk of [0, elements), the first on
+// the calling thread, and rethrows the first exception any chunk threw
+template <typename Work>
+void forEachChunk(size_t elements, size_t chunks, const Work& work) {
+    std::vector<std::exception_ptr> errors(chunks);
+    auto run = [&](size_t chunk) {
+        try {
+            work(chunk, chunkBegin(elements, chunks, chunk), chunkBegin(elements, chunks, chunk + 1));
+        } catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks);
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        try {
+            workers.emplace_back(run, chunk);
+        } catch (const std::system_error&) {
+            run(chunk);  // out of threads: do it here
+        }
+    }
+    run(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+} // namespace
+
+std::string RenderedDocument::str() const {
+    std::string text;
+    text.reserve(bytes);
+    for (const std::string* part : parts) {
+        text += *part;
+        text += '\n';
+    }
+    return text;
+}
+
+void RenderedDocument::writeTo(std::ostream& out) const {
+    for (const std::string* part : parts) {
+        out.write(part->data(), static_cast<std::streamsize>(part->size()));
+        out.put('\n');
+    }
+}
+
+std::ostream& operator<<(std::ostream& out, const RenderedDocument& document) {
+    document.writeTo(out);
+    return out;
+}
+
+RenderEngine::RenderEngine() {
+    renderers[static_cast<size_t>(IDocumentElement::Kind::Text)] = std::make_unique<TextRenderer>();
+    renderers[static_cast<size_t>(IDocumentElement::Kind::Image)] = std::make_unique<ImageRenderer>();
+    renderers[static_cast<size_t>(IDocumentElement::Kind::Table)] = std::make_unique<TableRenderer>();
+}
+
+void RenderEngine::setRenderer(IDocumentElement::Kind kind, std::unique_ptr<IRenderer> renderer) {
+    renderers[static_cast<size_t>(kind)] = std::move(renderer);
+    clearCache();
+}
+
+void RenderEngine::clearCache() {
+    output = RenderedDocument();
+    lastRevisions.clear();
+    lastParts.clear();
+    cache.clear();
+}
+
+const RenderedDocument& RenderEngine::render(const ElementTree& elements) {
+    const size_t count = elements.size();
+    const size_t chunks = chunkCount(count, MIN_CHUNK_ELEMENTS);
+    ++generation;
+
+    // Find each element's output, rendering what is not cached. The cache
+    // is only read here; new output is kept per chunk and filed afterwards.
+    struct Fresh {
+        size_t index;
+        uint64_t revision;
+        std::string output;
+    };
+    std::vector<uint64_t> revisions(count);
+    std::vector<Entry*> parts(count);
+    std::vector<std::vector<Fresh>> fresh(chunks);
+    forEachChunk(count, chunks, [&](size_t chunk, size_t begin, size_t end) {
+        auto it = elements.iteratorAt(begin);
+        // Most elements are where they were last time, give or take the
+        // inserts and removals before them
+        std::ptrdiff_t shift = 0;
+        for (size_t i = begin; i < end; ++i, ++it) {
+            const uint64_t revision = it.revision();
+            revisions[i] = revision;
+            bool found = false;
+            for (std::ptrdiff_t step : {0, -1, 1}) {
+                std::ptrdiff_t last = static_cast<std::ptrdiff_t>(i) + shift + step;
+                if (last >= 0 && static_cast<size_t>(last) < lastRevisions.size() && lastRevisions[last] == revision) {
+                    parts[i] = lastParts[last];
+                    shift += step;
+                    found = true;
+                    break;
+                }
+            }
+            if (found) {
+                continue;
+            }
+            auto cached = cache.find(revision);
+            if (cached != cache.end()) {
+                parts[i] = &cached->second;
+            } else {
+                fresh[chunk].push_back(Fresh{i, revision, renderElement(**it)});
+            }
+        }
+    });
+
+    rendered = 0;
+    for (auto& chunk : fresh) {
+        for (auto& part : chunk) {
+            auto [entry, added] = cache.try_emplace(part.revision);
+            if (added) {
+                entry->second.output = std::move(part.output);
+            }
+            parts[part.index] = &entry->second;
+            ++rendered;
+        }
+    }
+
+    // The output points at the cached pieces; nothing is copied
+    output.parts.resize(count);
+    output.bytes = 0;
+    size_t used = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Entry& entry = *parts[i];
+        if (entry.lastUsed != generation) {
+            entry.lastUsed = generation;
+            ++used;
+        }
+        output.parts[i] = &entry.output;
+        output.bytes += entry.output.size() + 1;
+    }
+
+    // Drop output for elements that have left the document or been edited,
+    // once there is a quarter as much of it as of output still in use
+    if (cache.size() - used > used / 4) {
+        for (auto it = cache.begin(); it != cache.end();) {
+            it = it->second.lastUsed == generation ? std::next(it) : cache.erase(it);
+        }
+    }
+    lastRevisions = std::move(revisions);
+    lastParts = std::move(parts);
+    return output;
+}
+
+std::string RenderEngine::renderElement(const IDocumentElement& element) {
+    const auto& renderer = renderers[static_cast<size_t>(element.getKind())];
+    return renderer ? renderer->render(element) : std::string();
+}
@@ -0,0 +1,418 @@
+#include <gtest/gtest.h>
+#include "binary_document.h"
+#include "change_log.h"
+#include "document.h"
+#include "document_storage.h"
+#include "json_writer.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> texts(const Document& doc) {
+    std::vector<std::string> result;
+    for (const auto& element : doc.getElements()) {
+        result.push_back(dynamic_cast<const TextElement&>(*element).getContent());
+    }
+    return result;
+}
+
+// Text, image and table elements, with repeated styles for the string pool
+void addMixedElements(Document& doc, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        switch (i % 3) {
+            case 0:
+                doc.addElement(std::make_unique<TextElement>("text " + std::to_string(i), i % 2 ? "bold" : "plain"));
+                break;
+            case 1:
+                doc.addElement(std::make_unique<ImageElement>("image" + std::to_string(i) + ".png",
+                                                              static_cast<int>(i), static_cast<int>(2 * i)));
+                break;
+            default: {
+                auto table = std::make_unique<TableElement>();
+                table->setStyle("grid");
+                table->setData({{"a", std::to_string(i)}, {"", "c"}});
+                doc.addElement(std::move(table));
+                break;
+            }
+        }
+    }
+}
+
+// Type and every stored field, for comparing documents element by element
+std::string describe(const IDocumentElement& element) {
+    if (const auto* text = dynamic_cast<const TextElement*>(&element)) {
+        return "text:" + text->getContent() + "|" + text->getStyle();
+    }
+    if (const auto* image = dynamic_cast<const ImageElement*>(&element)) {
+        return "image:" + image->getImagePath() + "|" + std::to_string(image->getWidth())
+            + "x" + std::to_string(image->getHeight());
+    }
+    const auto& table = dynamic_cast<const TableElement&>(element);
+    std::string result = "table:" + table.getStyle();
+    for (const auto& row : table.getData()) {
+        result += "|";
+        for (const auto& cell : row) {
+            result += cell + ",";
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> describeAll(const ElementTree& elements) {
+    std::vector<std::string> result;
+    for (const auto& element : elements) {
+        result.push_back(describe(*element));
+    }
+    return result;
+}
+
+void patchFile(const std::string& path, uint64_t offset, const void* bytes, size_t size) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+}
+
+uint64_t readWord(const std::string& path, uint64_t offset) {
+    std::ifstream file(path, std::ios::binary);
+    file.seekg(static_cast<std::streamoff>(offset));
+    uint64_t word = 0;
+    file.read(reinterpret_cast<char*>(&word), sizeof(word));
+    return word;
+}
+
+// Where FileHeader (binary_document.cpp) keeps the index table's offset
+constexpr uint64_t HEADER_INDEX_OFFSET = 32;
+
+} // namespace
+
+class DocumentStorageTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        doc->clear();
+        directory = std::filesystem::temp_directory_path()
+            / ("document_storage_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed())
+               + "_" + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+    }
+
+    void TearDown() override {
+        doc->clear();
+        std::filesystem::remove_all(directory);
+    }
+
+    std::string path(const std::string& name) const { return (directory / name).string(); }
+
+    Document* doc = Document::getInstance();
+    std::filesystem::path directory;
+};
+
+TEST_F(DocumentStorageTest, JsonRoundTripsNonAsciiText) {
+    const std::vector<std::string> contents = {
+        "plain", "caf\xC3\xA9", "\xE2\x9C\x93 done", "\xF0\x9D\x84\x9E clef", "\xE6\x97\xA5\xE6\x9C\xAC",
+        "quote \" backslash \\ tab \t", std::string("nul \0 inside", 12),
+    };
+    for (const auto& content : contents) {
+        doc->addElement(std::make_unique<TextElement>(content));
+    }
+
+    DocumentStorage storage;
+    for (auto style : {JsonWriter::Style::Pretty, JsonWriter::Style::Compact}) {
+        std::string file = path("doc.json");
+        ASSERT_TRUE(storage.saveToFile(file, style));
+        doc->clear();
+        ASSERT_TRUE(storage.loadFromFile(file));
+        EXPECT_EQ(texts(*doc), contents);
+    }
+}
+
+TEST_F(DocumentStorageTest, JsonSaveRejectsInvalidUtf8) {
+    const std::vector<std::string> invalid = {
+        "\xFF",                // never valid
+        "\x80 lone continuation",
+        "\xC0\xAF",            // overlong '/'
+        "\xE0\x80\xAF",        // overlong, three bytes
+        "\xED\xA0\x80",        // UTF-16 surrogate
+        "\xF4\x90\x80\x80",    // past U+10FFFF
+        "cut \xE2\x82",        // sequence cut short by the end
+        "cut \xE2\x82 short",  // and by an ASCII byte
+    };
+    for (const auto& content : invalid) {
+        std::ostringstream out;
+        JsonWriter writer(out);
+        EXPECT_THROW(writer.value(content), std::invalid_argument) << content;
+    }
+
+    DocumentStorage storage;
+    std::string file = path("doc.json");
+    doc->addElement(std::make_unique<TextElement>("fine"));
+    ASSERT_TRUE(storage.saveToFile(file));
+    doc->addElement(std::make_unique<TextElement>("bad \xC3("));
+    EXPECT_FALSE(storage.saveToFile(file));
+
+    // The failed save stopped beside the file, which still holds the last good one
+    EXPECT_FALSE(std::filesystem::exists(file + ".tmp"));
+    doc->clear();
+    ASSERT_TRUE(storage.loadFromFile(file));
+    EXPECT_EQ(texts(*doc), std::vector<std::string>{"fine"});
+}
+
+TEST_F(DocumentStorageTest, BinaryRoundTripsEveryElementKind) {
+    addMixedElements(*doc, 300);
+    std::vector<std::string> expected = describeAll(doc->getElements());
+
+    DocumentStorage storage;
+    std::string file = path("doc.gdoc");
+    ASSERT_TRUE(storage.saveToBinaryFile(file));
+    EXPECT_FALSE(std::filesystem::exists(file + ".tmp"));
+    doc->clear();
+    ASSERT_TRUE(storage.loadFromBinaryFile(file));
+    EXPECT_EQ(describeAll(doc->getElements()), expected);
+
+    // Saving over the file the document is mapped from
+    doc->removeElement(0);
+    expected.erase(expected.begin());
+    ASSERT_TRUE(storage.saveToBinaryFile(file));
+    ASSERT_TRUE(storage.loadFromBinaryFile(file));
+    EXPECT_EQ(describeAll(doc->getElements()), expected);
+}
+
+TEST_F(DocumentStorageTest, BinaryRejectsTruncatedFiles) {
+    addMixedElements(*doc, 30);
+    std::string file = path("doc.gdoc");
+    BinaryDocument::write(file, doc->getElements());
+    auto fullSize = std::filesystem::file_size(file);
+
+    for (auto size : {uintmax_t{0}, uintmax_t{10}, fullSize / 2, fullSize - 1}) {
+        std::string cut = path("cut.gdoc");
+        std::filesystem::copy_file(file, cut, std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::resize_file(cut, size);
+        EXPECT_THROW(BinaryDocument{cut}, std::runtime_error) << size;
+
+        // A failed load keeps the document
+        DocumentStorage storage;
+        EXPECT_FALSE(storage.loadFromBinaryFile(cut));
+        EXPECT_EQ(doc->size(), 30u);
+    }
+}
+
+TEST_F(DocumentStorageTest, BinaryRejectsCorruptFiles) {
+    addMixedElements(*doc, 30);
+    std::string file = path("doc.gdoc");
+    BinaryDocument::write(file, doc->getElements());
+
+    std::string badMagic = path("magic.gdoc");
+    std::filesystem::copy_file(file, badMagic);
+    patchFile(badMagic, 0, "XXXX", 4);
+    EXPECT_THROW(BinaryDocument{badMagic}, std::runtime_error);
+
+    // The header is fine, so opening works; the broken element fails to load
+    // and its neighbours still do
+    uint64_t index = readWord(file, HEADER_INDEX_OFFSET);
+    std::string badKind = path("kind.gdoc");
+    std::filesystem::copy_file(file, badKind);
+    uint32_t kind = 99;
+    patchFile(badKind, index, &kind, sizeof(kind));
+    BinaryDocument kindDocument(badKind);
+    EXPECT_THROW(kindDocument.load(0), std::runtime_error);
+    EXPECT_EQ(describe(*kindDocument.load(1)), describe(doc->getElement(1)));
+
+    std::string badOffset = path("offset.gdoc");
+    std::filesystem::copy_file(file, badOffset);
+    uint64_t offset = UINT64_MAX / 2;
+    patchFile(badOffset, index + 16 + 8, &offset, sizeof(offset));
+    BinaryDocument offsetDocument(badOffset);
+    EXPECT_THROW(offsetDocument.load(1), std::runtime_error);
+    EXPECT_EQ(describe(*offsetDocument.load(2)), describe(doc->getElement(2)));
+}
+
+TEST_F(DocumentStorageTest, FailedBinaryWriteLeavesTheOldFile) {
+    addMixedElements(*doc, 5);
+    std::string file = path("doc.gdoc");
+    BinaryDocument::write(file, doc->getElements());
+    auto before = std::filesystem::file_size(file);
+
+    // An element type the format cannot store stops the write part way
+    class OtherElement : public TextElement {
+    public:
+        std::string getType() const override { return "other"; }
+    };
+    doc->addElement(std::make_unique<OtherElement>());
+    EXPECT_THROW(BinaryDocument::write(file, doc->getElements()), std::runtime_error);
+    EXPECT_EQ(std::filesystem::file_size(file), before);
+    EXPECT_FALSE(std::filesystem::exists(file + ".tmp"));
+    EXPECT_EQ(BinaryDocument(file).size(), 5u);
+}
+
+class IncrementalSaveTest : public DocumentStorageTest {
+protected:
+    // Applies one edit of each kind, then saves incrementally
+    void editAndSave(size_t round) {
+        doc->insertElement(round % doc->size(), std::make_unique<TextElement>("inserted " + std::to_string(round)));
+        // Editing a non-text element changes nothing but is still logged
+        if (auto* text = dynamic_cast<TextElement*>(&doc->editElement((round * 7) % doc->size()))) {
+            text->setContent("edited " + std::to_string(round));
+        }
+        doc->removeElement((round * 13) % doc->size());
+        ASSERT_TRUE(storage.saveIncremental(file));
+        saved.push_back(describeAll(doc->getElements()));
+    }
+
+    void SetUp() override {
+        DocumentStorageTest::SetUp();
+        file = path("doc.gdoc");
+    }
+
+    std::string logPath() const { return ChangeLog::pathFor(file, BinaryDocument(file).id()); }
+
+    DocumentStorage storage;
+    std::string file;
+    std::vector<std::vector<std::string>> saved;  // document after each save
+};
+
+TEST_F(IncrementalSaveTest, ReplaysEverySaveInOrder) {
+    addMixedElements(*doc, 200);
+    ASSERT_TRUE(storage.saveIncremental(file));
+    saved.push_back(describeAll(doc->getElements()));
+    auto wholeBytes = std::filesystem::file_size(file);
+
+    for (size_t round = 0; round < 10; ++round) {
+        editAndSave(round);
+    }
+    // Only the log grew
+    EXPECT_EQ(std::filesystem::file_size(file), wholeBytes);
+    EXPECT_GT(std::filesystem::file_size(logPath()), 0u);
+
+    doc->clear();
+    DocumentStorage reader;
+    ASSERT_TRUE(reader.loadIncremental(file));
+    EXPECT_EQ(describeAll(doc->getElements()), saved.back());
+}
+
+TEST_F(IncrementalSaveTest, BinarySaveOverTheFileRestartsItsLog) {
+    doc->addElement(std::make_unique<TextElement>("a"));
+    doc->addElement(std::make_unique<TextElement>("b"));
+    ASSERT_TRUE(storage.saveIncremental(file));
+    doc->addElement(std::make_unique<TextElement>("c"));
+    ASSERT_TRUE(storage.saveIncremental(file));
+
+    // A whole save over the file gives it a new id, and so a new log
+    doc->addElement(std::make_unique<TextElement>("d"));
+    ASSERT_TRUE(storage.saveToBinaryFile(file));
+    doc->addElement(std::make_unique<TextElement>("e"));
+    ASSERT_TRUE(storage.saveIncremental(file));
+
+    doc->clear();
+    DocumentStorage reader;
+    ASSERT_TRUE(reader.loadIncremental(file));
+    EXPECT_EQ(texts(*doc), (std::vector<std::string>{"a", "b", "c", "d", "e"}));
+    doc->clear();
+    ASSERT_TRUE(reader.loadFromBinaryFile(file));
+    EXPECT_EQ(doc->size(), 5u);
+
+    // Only the current file's log is left
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.path().extension() == ".log") {
+            EXPECT_EQ(entry.path().string(), logPath());
+        }
+    }
+}
+
+TEST_F(IncrementalSaveTest, JsonSaveOverTheFileDropsItsLog) {
+    addMixedElements(*doc, 20);
+    ASSERT_TRUE(storage.saveIncremental(file));
+    editAndSave(0);
+    std::string oldLog = logPath();
+
+    ASSERT_TRUE(storage.saveToFile(file));
+    EXPECT_FALSE(std::filesystem::exists(oldLog));
+
+    // The next incremental save writes the binary file whole again
+    editAndSave(1);
+    doc->clear();
+    DocumentStorage reader;
+    ASSERT_TRUE(reader.loadIncremental(file));
+    EXPECT_EQ(describeAll(doc->getElements()), saved.back());
+}
+
+TEST_F(IncrementalSaveTest, TornTailIsDroppedAndOverwritten) {
+    addMixedElements(*doc, 50);
+    ASSERT_TRUE(storage.saveIncremental(file));
+    saved.push_back(describeAll(doc->getElements()));
+    editAndSave(0);
+    auto firstSaveBytes = std::filesystem::file_size(logPath());
+    editAndSave(1);
+
+    // A crash part way through the last save's first record
+    std::filesystem::resize_file(logPath(), firstSaveBytes + 10);
+    doc->clear();
+    DocumentStorage reader;
+    ASSERT_TRUE(reader.loadIncremental(file));
+    EXPECT_EQ(describeAll(doc->getElements()), saved[1]);
+    EXPECT_EQ(std::filesystem::file_size(logPath()), firstSaveBytes);
+
+    // New records follow the last good one
+    doc->addElement(std::make_unique<TextElement>("after the crash"));
+    ASSERT_TRUE(reader.saveIncremental(file));
+    std::vector<std::string> expected = describeAll(doc->getElements());
+    doc->clear();
+    DocumentStorage again;
+    ASSERT_TRUE(again.loadIncremental(file));
+    EXPECT_EQ(describeAll(doc->getElements()), expected);
+}
+
+TEST_F(IncrementalSaveTest, CorruptRecordEndsTheLog) {
+    addMixedElements(*doc, 50);
+    ASSERT_TRUE(storage.saveIncremental(file));
+    saved.push_back(describeAll(doc->getElements()));
+    editAndSave(0);
+    auto firstSaveBytes = std::filesystem::file_size(logPath());
+    editAndSave(1);
+    editAndSave(2);
+
+    // One flipped byte inside the second save's first record
+    char garbage = '\x5A';
+    patchFile(logPath(), firstSaveBytes + 30, &garbage, 1);
+    doc->clear();
+    DocumentStorage reader;
+    ASSERT_TRUE(reader.loadIncremental(file));
+    EXPECT_EQ(describeAll(doc->getElements()), saved[1]);
+}
+
+TEST_F(IncrementalSaveTest, CompactionKeepsTheDocument) {
+    addMixedElements(*doc, 50);
+    ASSERT_TRUE(storage.saveIncremental(file));
+    const std::string firstLog = logPath();
+
+    // Large edits, so the log passes the 1 MB compaction threshold
+    const std::string big(64 * 1024, 'x');
+    for (size_t round = 0; round < 24; ++round) {
+        // Every third element is text
+        static_cast<TextElement&>(doc->editElement(round % 10 * 3)).setContent(big + std::to_string(round));
+        doc->addElement(std::make_unique<TextElement>("tail " + std::to_string(round)));
+        ASSERT_TRUE(storage.saveIncremental(file));
+    }
+    std::vector<std::string> expected = describeAll(doc->getElements());
+
+    // Loading waits for the compaction thread
+    doc->clear();
+    ASSERT_TRUE(storage.loadIncremental(file));
+    EXPECT_EQ(describeAll(doc->getElements()), expected);
+
+    // The file was rewritten with the old log folded in
+    EXPECT_NE(logPath(), firstLog);
+    EXPECT_FALSE(std::filesystem::exists(firstLog));
+    EXPECT_LT(std::filesystem::file_size(logPath()), size_t{1} << 20);
+
+    doc->clear();
+    DocumentStorage reader;
+    ASSERT_TRUE(reader.loadIncremental(file));
+    EXPECT_EQ(describeAll(doc->getElements()), expected);
+}
@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include "document.h"
+#include "element_tree.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::unique_ptr<IDocumentElement> text(const std::string& content) {
+    return std::make_unique<TextElement>(content);
+}
+
+std::string contentOf(const IDocumentElement& element) {
+    return dynamic_cast<const TextElement&>(element).getContent();
+}
+
+std::vector<std::string> contents(const ElementTree& tree) {
+    std::vector<std::string> result;
+    for (const auto& element : tree) {
+        result.push_back(contentOf(*element));
+    }
+    return result;
+}
+
+// Text elements "0", "1", ... that counts how many it has built
+class CountingSource : public ElementSource {
+public:
+    explicit CountingSource(size_t count) : count(count) {}
+
+    size_t size() const override { return count; }
+
+    std::unique_ptr<IDocumentElement> load(size_t index) const override {
+        ++loads;
+        return text(std::to_string(index));
+    }
+
+    size_t count;
+    mutable std::atomic<size_t> loads{0};
+};
+
+} // namespace
+
+TEST(ElementTreeTest, InsertAndEraseKeepOrder) {
+    ElementTree tree;
+    tree.pushBack(text("b"));
+    tree.insert(0, text("a"));
+    tree.pushBack(text("d"));
+    tree.insert(2, text("c"));
+
+    EXPECT_EQ(contents(tree), (std::vector<std::string>{"a", "b", "c", "d"}));
+
+    tree.erase(1);
+    tree.erase(2);
+    EXPECT_EQ(contents(tree), (std::vector<std::string>{"a", "c"}));
+    EXPECT_EQ(tree.size(), 2u);
+    EXPECT_THROW(tree.erase(2), std::out_of_range);
+    EXPECT_THROW(tree.at(2), std::out_of_range);
+}
+
+TEST(ElementTreeTest, SplitsAndMergesAcrossManyLevels) {
+    // Inserting at scattered positions splits leaves and then inner
+    // nodes; the reference vector says where every element should end up
+    const size_t count = ElementTree::MAX_CHILDREN * ElementTree::MAX_CHILDREN * 2;
+    ElementTree tree;
+    std::vector<std::string> expected;
+    for (size_t i = 0; i < count; ++i) {
+        size_t index = (i * 7919) % (expected.size() + 1);
+        tree.insert(index, text(std::to_string(i)));
+        expected.insert(expected.begin() + index, std::to_string(i));
+    }
+    ASSERT_EQ(tree.size(), count);
+    EXPECT_EQ(contents(tree), expected);
+    for (size_t i = 0; i < count; i += 97) {
+        EXPECT_EQ(contentOf(*tree[i]), expected[i]);
+    }
+
+    // Erasing most of it merges and borrows between underfull nodes
+    for (size_t i = 0; expected.size() > 10; ++i) {
+        size_t index = (i * 7919) % expected.size();
+        tree.erase(index);
+        expected.erase(expected.begin() + index);
+    }
+    EXPECT_EQ(contents(tree), expected);
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(contentOf(*tree.iteratorAt(i)->get()), expected[i]);
+    }
+
+    while (!tree.empty()) {
+        tree.erase(0);
+    }
+    EXPECT_EQ(tree.begin(), tree.end());
+}
+
+TEST(ElementTreeTest, CopiesAreIsolatedAndShareUneditedElements) {
+    ElementTree original;
+    for (int i = 0; i < 200; ++i) {
+        original.pushBack(text(std::to_string(i)));
+    }
+
+    ElementTree copy = original;
+    dynamic_cast<TextElement&>(copy.mutableAt(5)).setContent("edited");
+    copy.erase(0);
+    copy.insert(100, text("inserted"));
+
+    EXPECT_EQ(original.size(), 200u);
+    EXPECT_EQ(contentOf(*original[5]), "5");
+    EXPECT_EQ(contentOf(*original[0]), "0");
+    EXPECT_EQ(contentOf(*copy[4]), "edited");
+    EXPECT_EQ(contentOf(*copy[100]), "inserted");
+
+    // Only the edited element was copied
+    EXPECT_NE(original[5], copy[4]);
+    EXPECT_EQ(original[50], copy[49]);
+    EXPECT_EQ(original[150], copy[150]);
+}
+
+TEST(ElementTreeTest, RevisionsChangeWithEveryEdit) {
+    ElementTree tree;
+    tree.pushBack(text("a"));
+    tree.pushBack(text("b"));
+    uint64_t first = tree.begin().revision();
+    uint64_t second = tree.iteratorAt(1).revision();
+    EXPECT_NE(first, second);
+
+    // Copies share revisions until one side edits
+    ElementTree copy = tree;
+    EXPECT_EQ(copy.begin().revision(), first);
+    copy.mutableAt(0);
+    EXPECT_NE(copy.begin().revision(), first);
+    EXPECT_EQ(tree.begin().revision(), first);
+
+    // An element edited in place gets a new revision too
+    tree.mutableAt(1);
+    EXPECT_NE(tree.iteratorAt(1).revision(), second);
+    tree.replace(1, tree.pointerAt(0));
+    EXPECT_NE(tree.iteratorAt(1).revision(), first);
+}
+
+TEST(ElementTreeTest, LoadsOnlyTheLeavesThatAreReached) {
+    const size_t count = ElementTree::MAX_CHILDREN * ElementTree::MAX_CHILDREN * 4;
+    auto source = std::make_shared<CountingSource>(count);
+    ElementTree tree(source);
+
+    EXPECT_EQ(tree.size(), count);
+    EXPECT_EQ(source->loads, 0u);
+
+    EXPECT_EQ(contentOf(*tree[count / 2]), std::to_string(count / 2));
+    EXPECT_LE(source->loads, ElementTree::MAX_CHILDREN);
+
+    // Same leaf again: nothing more to load
+    size_t loaded = source->loads;
+    EXPECT_EQ(contentOf(*tree[count / 2 + 1]), std::to_string(count / 2 + 1));
+    EXPECT_EQ(source->loads, loaded);
+
+    // Editing a lazily loaded tree loads only the edited path
+    tree.erase(0);
+    EXPECT_LE(source->loads, 2 * ElementTree::MAX_CHILDREN);
+    EXPECT_EQ(contentOf(*tree[0]), "1");
+    EXPECT_EQ(tree.size(), count - 1);
+}
+
+class DocumentTest : public ::testing::Test {
+protected:
+    void SetUp() override { doc->clear(); }
+    void TearDown() override { doc->clear(); }
+
+    Document* doc = Document::getInstance();
+};
+
+TEST_F(DocumentTest, SnapshotIsUnaffectedByLaterEdits) {
+    doc->addElement(text("first"));
+    doc->addElement(text("second"));
+    ElementTree before = doc->snapshot();
+
+    dynamic_cast<TextElement&>(doc->editElement(0)).setContent("changed");
+    doc->insertElement(1, text("inserted"));
+    doc->removeElement(2);
+
+    EXPECT_EQ(contents(before), (std::vector<std::string>{"first", "second"}));
+    EXPECT_EQ(contents(doc->getElements()), (std::vector<std::string>{"changed", "inserted"}));
+
+    doc->restore(before);
+    EXPECT_EQ(contents(doc->getElements()), (std::vector<std::string>{"first", "second"}));
+}
+
+TEST_F(DocumentTest, GetElementsReadsLikeTheFormerVector) {
+    doc->addElement(text("a"));
+    doc->addElement(std::make_unique<ImageElement>("image.png", 10, 20));
+
+    const auto& elements = doc->getElements();
+    ASSERT_EQ(elements.size(), 2u);
+    EXPECT_FALSE(elements.empty());
+    EXPECT_EQ(elements[0]->getType(), "text");
+    EXPECT_EQ(elements.at(1)->getType(), "image");
+    EXPECT_EQ(elements.front().get(), &doc->getElement(0));
+    EXPECT_EQ(elements.back().get(), &doc->getElement(1));
+    EXPECT_THROW(elements.at(2), std::out_of_range);
+
+    size_t visited = 0;
+    for (const auto& element : elements) {
+        EXPECT_TRUE(element);
+        ++visited;
+    }
+    EXPECT_EQ(visited, 2u);
+}
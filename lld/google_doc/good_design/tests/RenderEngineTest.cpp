@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "document.h"
+#include "render_engine.h"
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// What a render from scratch produces
+std::string fullRender(const ElementTree& elements) {
+    RenderEngine engine;
+    return engine.render(elements).str();
+}
+
+} // namespace
+
+class RenderEngineTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        doc->clear();
+        // Several chunks' worth, so the parallel path is used where there are threads
+        for (size_t i = 0; i < 3 * 4096 + 7; ++i) {
+            if (i % 10 == 4) {
+                doc->addElement(std::make_unique<ImageElement>("image" + std::to_string(i) + ".png", 4, 3));
+            } else {
+                doc->addElement(std::make_unique<TextElement>("paragraph " + std::to_string(i)));
+            }
+        }
+    }
+
+    void TearDown() override { doc->clear(); }
+
+    Document* doc = Document::getInstance();
+    RenderEngine engine;
+};
+
+TEST_F(RenderEngineTest, OneEditRerendersOnlyThatElement) {
+    const RenderedDocument& cold = engine.render(doc->getElements());
+    EXPECT_EQ(engine.renderedLastTime(), doc->size());
+    EXPECT_EQ(cold.elements(), doc->size());
+    EXPECT_EQ(cold.str(), fullRender(doc->getElements()));
+
+    // The cache holds no reference to the element, so it is edited in place
+    const IDocumentElement* before = &doc->getElement(6000);
+    static_cast<TextElement&>(doc->editElement(6000)).setContent("edited");
+    EXPECT_EQ(&doc->getElement(6000), before);
+
+    const RenderedDocument& warm = engine.render(doc->getElements());
+    EXPECT_EQ(engine.renderedLastTime(), 1u);
+    EXPECT_EQ(warm.element(6000), "edited");
+    EXPECT_EQ(warm.size(), warm.str().size());
+    EXPECT_EQ(warm.str(), fullRender(doc->getElements()));
+
+    engine.render(doc->getElements());
+    EXPECT_EQ(engine.renderedLastTime(), 0u);
+}
+
+TEST_F(RenderEngineTest, InsertsAndRemovalsRenderOnlyNewElements) {
+    engine.render(doc->getElements());
+
+    doc->insertElement(100, std::make_unique<TextElement>("inserted"));
+    doc->removeElement(9000);
+    EXPECT_EQ(engine.render(doc->getElements()).str(), fullRender(doc->getElements()));
+    EXPECT_EQ(engine.renderedLastTime(), 1u);
+
+    doc->removeElement(0);
+    EXPECT_EQ(engine.render(doc->getElements()).str(), fullRender(doc->getElements()));
+    EXPECT_EQ(engine.renderedLastTime(), 0u);
+}
+
+TEST_F(RenderEngineTest, SnapshotsKeepTheirOwnOutput) {
+    ElementTree before = doc->snapshot();
+    std::string beforeText = engine.render(before).str();
+
+    // Shared with the snapshot, so the edit copies the element
+    static_cast<TextElement&>(doc->editElement(5)).setContent("edited");
+    EXPECT_EQ(engine.render(doc->getElements()).str(), fullRender(doc->getElements()));
+    EXPECT_EQ(engine.renderedLastTime(), 1u);
+
+    doc->restore(before);
+    EXPECT_EQ(engine.render(doc->getElements()).str(), beforeText);
+    EXPECT_EQ(engine.renderedLastTime(), 0u);
+}
+
+TEST_F(RenderEngineTest, StreamsTheSameText) {
+    const RenderedDocument& rendered = engine.render(doc->getElements());
+    std::ostringstream out;
+    out << rendered;
+    EXPECT_EQ(out.str(), rendered.str());
+}